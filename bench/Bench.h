@@ -0,0 +1,81 @@
+#pragma once
+
+#include "RealtimeTrap.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+/**
+ * Minimal benchmark helpers for phu-arp-bench.
+ *
+ * Each benchmark group is a function `void runXxxBenchmarks(const BenchOptions&)` declared here
+ * and called from BenchMain.cpp. Results are printed as one line per case.
+ * Failed expectations (see benchFail) make phu-arp-bench exit with status 1.
+ */
+struct BenchOptions {
+    std::string filter;          // Only run cases whose name contains this text
+    int repetitions = 5;         // Best-of-N timing
+    std::string workDir;         // Scratch directory for generated files
+
+    bool matches(const char* name) const {
+        return filter.empty() || std::string(name).find(filter) != std::string::npos;
+    }
+};
+
+/**
+ * Run fn repetitions times and return the fastest run in seconds
+ */
+template<typename Fn>
+double measureBestSeconds(int repetitions, Fn&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < repetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+inline void printThroughput(const char* name, double seconds, double bytes, double events) {
+    const double safeSeconds = seconds > 0.0 ? seconds : 1e-12;
+    std::printf("%-32s %9.3f ms  %9.1f MB/s  %9.2f Mevents/s\n",
+                name, seconds * 1000.0, bytes / safeSeconds / 1e6, events / safeSeconds / 1e6);
+}
+
+/**
+ * Number of failed expectations so far
+ */
+inline int benchFailures = 0;
+
+inline void benchFail(const char* name, const char* what) {
+    std::printf("%-32s FAILED: %s\n", name, what);
+    ++benchFailures;
+}
+
+/**
+ * Fail the case if the realtime sections it ran allocated or locked (PHU_ARP_RT_TRAP builds).
+ * Call RealtimeTrap::resetCounters() before the measured work.
+ */
+inline void expectRealtimeSafe(const char* name) {
+    if (!RealtimeTrap::isEnabled()) {
+        return;
+    }
+    char text[128];
+    std::snprintf(text, sizeof(text), "%llu allocations, %llu deallocations, %llu locks in realtime sections",
+                  static_cast<unsigned long long>(RealtimeTrap::getAllocationCount()),
+                  static_cast<unsigned long long>(RealtimeTrap::getDeallocationCount()),
+                  static_cast<unsigned long long>(RealtimeTrap::getLockCount()));
+    if (RealtimeTrap::getViolationCount() != 0) {
+        benchFail(name, text);
+    } else {
+        std::printf("%-32s rt-trap: %s\n", name, text);
+    }
+}
+
+void runSmfBenchmarks(const BenchOptions& options);
+void runEngineBenchmarks(const BenchOptions& options);
+void runEventBenchmarks(const BenchOptions& options);
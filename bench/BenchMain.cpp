@@ -0,0 +1,43 @@
+/**
+ * phu-arp-bench - throughput/latency benchmarks for the headless engine
+ *
+ * Usage:
+ *   phu-arp-bench [--filter TEXT] [--repetitions N] [--work-dir DIR]
+ */
+
+#include "Bench.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    options.workDir = (std::filesystem::temp_directory_path() / "phu-arp-bench").string();
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--work-dir" && i + 1 < argc) {
+            options.workDir = argv[++i];
+        } else {
+            std::fprintf(stderr, "Usage: phu-arp-bench [--filter TEXT] [--repetitions N] [--work-dir DIR]\n");
+            return 2;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.workDir, ec);
+
+    if (RealtimeTrap::isEnabled()) {
+        // Count only; failures are reported per case
+        RealtimeTrap::setAction(RealtimeTrap::Action::Count);
+    }
+
+    runSmfBenchmarks(options);
+    runEngineBenchmarks(options);
+    runEventBenchmarks(options);
+    return benchFailures == 0 ? 0 : 1;
+}
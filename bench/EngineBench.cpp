@@ -0,0 +1,1417 @@
+/**
+ * Engine hot path: SyncGlobals + ChordPatternCoordinator driven block by block, as a host would.
+ * In PHU_ARP_RT_TRAP builds the cases also assert that no realtime section allocated or locked.
+ * The coordinator cases run on the shared fixture in EngineHarness.h.
+ * engine/rhythm-generator runs the coordinator on the built-in rhythm only (compiled pattern,
+ * five lanes); engine/pattern-compile times the pattern compiler.
+ * engine/scheduler keeps ~1000 output events scheduled up to minutes ahead through the
+ * coordinator and checks that each comes out in its block at the exact sample, in time order.
+ * engine/gate drives ratchet gates from drum-pad style (10-sample) triggers and checks every
+ * generated note's onset and length.
+ * engine/strum strums the chord from a short trigger with lookahead (latency) and checks each note's
+ * onset, the deferred note-offs and the delayed pass-through events.
+ * engine/quantize groove-quantizes jittered triggers onto a swung 1/16 grid and checks each note's
+ * onset, velocity and length.
+ * engine/chord-settle plays hand-played (staggered) chord changes under a steady rhythm through the
+ * chord settle window and checks that every trigger plays a complete chord.
+ * engine/chord-grace sends rhythm hits up to 8 ms before their chord through a 10 ms grace window
+ * and checks that each plays the new chord at its own (latency-compensated) time.
+ * engine/chord-pedal plays chords with the sustain and sostenuto pedals, latch on and off by turns,
+ * and checks the chord each trigger plays.
+ * engine/chord-follow holds five rhythm keys through voice-led chord changes with chord follow on
+ * and checks that exactly the changed pitches are ended and restarted (shared ones keep sounding).
+ * engine/output-cleanup mixes rhythm retriggers and routed aftertouch with redundant scheduled note
+ * events under Clean and Legato output cleanup and checks each block's output event for event.
+ * engine/control-routing routes controller, pitch bend and aftertouch sweeps of both inputs with
+ * thinning and checks that exactly the last value of each control reaches the output.
+ * engine/aftertouch-delay routes rhythm aftertouch through the grace window and to strummed notes
+ * and checks that each value reaches its note no earlier than the note-on.
+ * engine/voice-steal plays overlapping rhythm notes into a 4-voice polyphony cap under each steal
+ * policy in turn and checks every stolen note-off (pitch and sample) against a reference model.
+ * engine/preset-switch plays a 256-preset bank with a program change every 8 blocks while another
+ * thread keeps reloading the bank file.
+ * engine/beat-grid checks the per-block grid against a simulated host (tempo changes, loop,
+ * sub-sample PPQ jitter) and times it.
+ */
+
+#include "Bench.h"
+#include "EngineHarness.h"
+#include "PatternCompileWorker.h"
+#include "PresetSwitcher.h"
+#include "RhythmGenerator.h"
+#include "../lib/SyncGlobals.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int blockSize = EngineHarness::blockSize;
+constexpr int numBlocks = EngineHarness::numBlocks;
+
+struct BlockStream {
+    std::vector<MidiEvent> events;         // All blocks back to back
+    std::vector<size_t> blockStart;        // Index of each block's first event (+ end marker)
+};
+
+// Chord change every 16 blocks, two rhythm triggers per block. Events are delivered grouped by
+// channel (rhythm first), not by time, so the coordinator has to reorder them.
+BlockStream generateBlocks() {
+    BlockStream stream;
+    stream.events.reserve(static_cast<size_t>(numBlocks) * 8);
+    stream.blockStart.reserve(static_cast<size_t>(numBlocks) + 1);
+
+    BenchRandom random(4711);
+    int root = 48;
+    for (int b = 0; b < numBlocks; ++b) {
+        stream.blockStart.push_back(stream.events.size());
+
+        const int keyA = 24 + random(16);
+        const int keyB = 24 + random(16);
+        stream.events.push_back(MidiEvent::noteOn(16, keyA, 100, 16));
+        stream.events.push_back(MidiEvent::noteOff(16, keyA, 0, 120));
+        stream.events.push_back(MidiEvent::noteOn(16, keyB, 90, 128));
+        stream.events.push_back(MidiEvent::noteOff(16, keyB, 0, 250));
+
+        if (b % 16 == 0) {
+            for (int interval : {0, 4, 7}) {
+                stream.events.push_back(MidiEvent::noteOff(1, root + interval, 0, 0));
+            }
+            root = 48 + random(12);
+            for (int interval : {0, 4, 7}) {
+                stream.events.push_back(MidiEvent::noteOn(1, root + interval, 90, 0));
+            }
+        }
+    }
+    stream.blockStart.push_back(stream.events.size());
+    return stream;
+}
+
+void benchProcessBlock(const BenchOptions& options, const BlockStream& stream) {
+    const char* name = "engine/process-block";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+
+    size_t outputEvents = 0;
+    const double seconds = engine.run(options.repetitions, [&]() {
+        for (int b = 0; b < numBlocks; ++b) {
+            const size_t first = stream.blockStart[static_cast<size_t>(b)];
+            const size_t last = stream.blockStart[static_cast<size_t>(b) + 1];
+            outputEvents += engine.playBlock(stream.events.data() + first, last - first).size();
+        }
+        engine.stop();
+    });
+
+    printThroughput(name, seconds, static_cast<double>(stream.events.size() * sizeof(MidiEvent)),
+                    static_cast<double>(stream.events.size()));
+    engine.report(seconds, nullptr, "%zu output events", engine.perRun(outputEvents));
+}
+
+// Rhythm pattern exercising every compiler feature (ties, ratchets, Euclidean, triplets, polymeter)
+const char* const benchPattern =
+    "0: x . x x*2 | x . X . | x _ . o | x*3 . x . /16\n"
+    "1: E(5,8) E(3,8,2) /16\n"
+    "2: [x . o]!5 /16          # 15-step polymeter\n"
+    "7: X _ . x . . /8t\n"
+    "12: X . . . x*4 . . . /8\n";
+
+// Compile time of the bench pattern (worker thread work, not realtime)
+void benchPatternCompile(const BenchOptions& options) {
+    const char* name = "engine/pattern-compile";
+    if (!options.matches(name)) {
+        return;
+    }
+    CompiledPattern pattern;
+    std::string error;
+    bool ok = true;
+    const double seconds = measureBestSeconds(options.repetitions, [&]() {
+        ok = PatternCompiler::compile(benchPattern, pattern, error) && ok;
+    });
+    const StepTable& table = pattern.table;
+    if (!ok) {
+        benchFail(name, error.c_str());
+        return;
+    }
+    std::printf("%-32s %9.1f us/compile, %d lanes x %d lines at %d lines/quarter\n", name,
+                seconds * 1e6, table.numLanes, table.numLines, table.linesPerQuarter);
+}
+
+// Chord held, rhythm from the compiled bench pattern, no external rhythm input
+void benchRhythmGenerator(const BenchOptions& options) {
+    const char* name = "engine/rhythm-generator";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name, 174.0);
+    engine.coordinator.setBeatGrid(&engine.syncGlobals.getBeatGrid());
+
+    // Compiled off the audio thread, as PatternCompileWorker would
+    PatternCompileWorker worker;
+    const unsigned generation = worker.submit(benchPattern);
+    while (worker.getStatus().generation != generation) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!worker.getStatus().ok) {
+        benchFail(name, worker.getStatus().error.c_str());
+        return;
+    }
+    while (!worker.update()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    engine.syncGlobals.setGridSubdivisionsPerQuarter(worker.getActive()->linesPerQuarter);
+    engine.coordinator.getRhythmGenerator().setStepTable(worker.getActive());
+
+    const MidiEvent chord[] = { MidiEvent::noteOn(1, 48, 90, 0), MidiEvent::noteOn(1, 52, 90, 0),
+                                MidiEvent::noteOn(1, 55, 90, 0) };
+
+    size_t outputEvents = 0;
+    const double seconds = engine.run(options.repetitions, [&]() {
+        for (int b = 0; b < numBlocks; ++b) {
+            outputEvents += engine.playBlock(chord, b == 0 ? 3 : 0).size();
+        }
+        engine.stop();
+    });
+
+    outputEvents = engine.perRun(outputEvents);
+    engine.report(seconds, outputEvents == 0 ? "generator produced no notes" : nullptr, "%zu output events",
+                  outputEvents);
+}
+
+// Output events scheduled 0..1023 samples (most), up to 65536 and up to 2^26 samples ahead, so all
+// wheel levels and cascades are used. Each event carries an id; its drain time is checked exactly.
+void benchScheduler(const BenchOptions& options) {
+    const char* name = "engine/scheduler";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+
+    constexpr int numIds = 1 << 14;        // Note number + velocity
+    std::vector<long long> expectedTime(numIds, -1);
+    std::vector<int> freeIds;
+    freeIds.reserve(numIds);
+    for (int id = numIds - 1; id >= 0; --id) {
+        freeIds.push_back(id);
+    }
+
+    // Delays up to 2^26 samples: keep 28 bits
+    BenchRandom random(1234, 4);
+
+    const size_t capacity = coordinator.getScheduler().capacity();
+    size_t scheduled = 0;
+    size_t drained = 0;
+    size_t errors = 0;
+
+    // Scheduled events stay pending from one run to the next: no stop
+    const double seconds = engine.run(options.repetitions, [&]() {
+        for (int b = 0; b < numBlocks; ++b) {
+            const long long blockStart = coordinator.getSampleTime();
+            for (int i = 0; i < 8 && coordinator.getScheduler().size() + 16 < capacity; ++i) {
+                const int kind = random(1024);
+                const long long delay = kind == 0 ? random(1 << 26) : kind < 200 ? random(65536) : random(1024);
+                const int id = freeIds.back();
+                freeIds.pop_back();
+                expectedTime[static_cast<size_t>(id)] = blockStart + delay;
+                coordinator.scheduleOutputEvent(MidiEvent::noteOn(3, id & 127, static_cast<uint8_t>(id >> 7), 0),
+                                                blockStart + delay);
+                ++scheduled;
+            }
+
+            int lastPosition = 0;
+            for (const auto& evt : engine.playBlock(nullptr, 0)) {
+                const int id = evt.getNoteNumber() | (evt.getVelocity() << 7);
+                errors += evt.samplePosition < lastPosition || evt.samplePosition >= blockSize
+                          || blockStart + evt.samplePosition != expectedTime[static_cast<size_t>(id)];
+                lastPosition = evt.samplePosition;
+                expectedTime[static_cast<size_t>(id)] = -1;
+                freeIds.push_back(id);
+                ++drained;
+            }
+        }
+    });
+
+    const EventScheduler& scheduler = coordinator.getScheduler();
+    const bool ok = errors == 0 && drained + scheduler.size() == scheduled && scheduler.getRejectedCount() == 0;
+    engine.report(seconds, ok ? nullptr : "scheduled events lost, early, late or out of order",
+                  "%zu events, peak %zu/%zu scheduled, %zu errors", engine.perRun(drained), scheduler.getPeakSize(),
+                  scheduler.capacity(), errors);
+}
+
+// Three rhythm keys triggered in turn every 16 blocks with 10-sample notes, ratchet gate of 3 over
+// an eighth note at 120 BPM: every trigger must yield three notes of exactly 2000 samples, 4000 apart
+void benchGate(const BenchOptions& options) {
+    const char* name = "engine/gate";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+
+    NoteGate gate;
+    gate.mode = GateMode::Ratchet;
+    gate.lengthQuarters = 0.5;
+    gate.ratchets = 3;
+    coordinator.setNoteGate(gate);
+    constexpr long long noteLength = 2000;
+    constexpr long long noteSpacing = 4000;
+
+    const MidiEvent chord[] = { MidiEvent::noteOn(1, 48, 90, 0), MidiEvent::noteOn(1, 52, 90, 0),
+                                MidiEvent::noteOn(1, 55, 90, 0) };
+    MidiEvent input[5];
+
+    std::array<long long, 128> onTime {};
+    std::array<long long, 128> lastOnTime {};
+    size_t noteOns = 0;
+    size_t triggers = 0;
+    size_t starts = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        onTime.fill(-1);
+        lastOnTime.fill(-1);
+        for (int b = 0; b < numBlocks; ++b) {
+            size_t numInput = 0;
+            if (b == 0) {
+                std::copy(std::begin(chord), std::end(chord), input);
+                numInput = 3;
+            }
+            if (b % 16 == 0) {
+                const int key = 24 + (b / 16) % 3;
+                input[numInput++] = MidiEvent::noteOn(16, key, 100, 20);
+                input[numInput++] = MidiEvent::noteOff(16, key, 0, 30);
+                ++triggers;
+            }
+            const long long blockStart = coordinator.getSampleTime();
+            for (const auto& evt : engine.playBlock(input, numInput)) {
+                const long long time = blockStart + evt.samplePosition;
+                const size_t note = static_cast<size_t>(evt.getNoteNumber());
+                if (evt.isNoteOn()) {
+                    // A note-on either repeats the pitch's previous one noteSpacing later or starts a trigger
+                    errors += onTime[note] >= 0;
+                    starts += lastOnTime[note] < 0 || time - lastOnTime[note] != noteSpacing;
+                    onTime[note] = time;
+                    lastOnTime[note] = time;
+                    ++noteOns;
+                } else {
+                    errors += onTime[note] < 0 || time - onTime[note] != noteLength;
+                    onTime[note] = -1;
+                }
+            }
+        }
+        engine.stop();
+    });
+
+    noteOns = engine.perRun(noteOns);
+    triggers = engine.perRun(triggers);
+    starts = engine.perRun(starts);
+    // The stop cuts the last trigger (16 blocks before the end) after its second note
+    const bool ok = errors == 0 && starts == triggers && noteOns == 3 * triggers - 1;
+    engine.report(seconds, ok ? nullptr : "gate notes missing or with wrong onset/length",
+                  "%zu triggers -> %zu notes, %zu errors", triggers, noteOns, errors);
+}
+
+// Strum key triggered every 32 blocks with 10-sample notes: alternating 3-note strums over a 1/16
+// (6000 samples at 120 BPM), anticipated by the whole 480-sample latency, so notes start at the
+// trigger and 3000 samples apart and all end one sample after the last. A CC per block passes
+// through the delay line and must come out exactly 480 samples later.
+void benchStrum(const BenchOptions& options) {
+    const char* name = "engine/strum";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+
+    constexpr int latency = 480;
+    constexpr long long noteSpacing = 3000;
+    NoteStrum strum;
+    strum.key = 12;
+    strum.direction = StrumDirection::Alternate;
+    strum.spreadQuarters = 0.25;
+    strum.anticipation = 1.0;
+    coordinator.setStrum(strum);
+    coordinator.setLatencySamples(latency);
+
+    const int chordNotes[] = { 48, 52, 55 };
+    MidiEvent input[5];
+
+    long long trigger = -1;
+    bool lastDown = true;
+    size_t triggers = 0;
+    size_t noteOns = 0;
+    size_t noteOffs = 0;
+    size_t delayedEvents = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        for (int b = 0; b < numBlocks; ++b) {
+            const long long blockStart = coordinator.getSampleTime();
+            size_t numInput = 0;
+            if (b == 0) {
+                for (int note : chordNotes) {
+                    input[numInput++] = MidiEvent::noteOn(1, note, 90, 0);
+                }
+            }
+            if (b % 32 == 0) {
+                input[numInput++] = MidiEvent::noteOn(16, 36, 100, 100);
+                input[numInput++] = MidiEvent::noteOff(16, 36, 0, 110);
+                trigger = blockStart + 100;
+                ++triggers;
+            }
+            coordinator.delayEvent(MidiEvent::controller(5, 1, b & 127, 7));
+            for (const auto& evt : engine.playBlock(input, numInput)) {
+                const long long time = blockStart + evt.samplePosition;
+                if (evt.getChannel() == 5) {
+                    errors += (time - latency - 7) % blockSize != 0;
+                    ++delayedEvents;
+                    continue;
+                }
+                const long long offset = time - trigger;
+                if (evt.isNoteOn()) {
+                    const long long index = offset / noteSpacing;
+                    if (index == 0) {
+                        // Alternate: every strum turns around
+                        const bool down = evt.getNoteNumber() != chordNotes[0];
+                        errors += down == lastDown;
+                        lastDown = down;
+                    }
+                    const int expected = chordNotes[lastDown ? 2 - index : index];
+                    errors += offset % noteSpacing != 0 || index > 2 || evt.getNoteNumber() != expected;
+                    ++noteOns;
+                } else {
+                    errors += offset != 2 * noteSpacing + 1;
+                    ++noteOffs;
+                }
+            }
+        }
+        engine.stop();
+    });
+
+    triggers = engine.perRun(triggers);
+    noteOns = engine.perRun(noteOns);
+    noteOffs = engine.perRun(noteOffs);
+    delayedEvents = engine.perRun(delayedEvents);
+    // The last CC is still in the delay line at the stop
+    const bool ok = errors == 0 && noteOns == 3 * triggers && noteOffs == noteOns && delayedEvents == numBlocks - 1;
+    engine.report(seconds, ok ? nullptr : "strum notes or delayed events missing or mistimed",
+                  "%zu strums -> %zu notes, %zu delayed events, %zu errors", triggers, noteOns, delayedEvents, errors);
+}
+
+// A trigger on every 1/16 line (6000 samples at 120 BPM), up to 200 samples early or late, quantized
+// at full strength onto a 60 % swing grid with the odd lines at 80 % velocity. The 256-sample
+// latency covers the late ones, so every note starts exactly on its line and keeps its length.
+void benchQuantize(const BenchOptions& options) {
+    const char* name = "engine/quantize";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+    coordinator.setBeatGrid(&engine.syncGlobals.getBeatGrid());
+
+    constexpr int latency = 256;
+    constexpr long long lineSpacing = 6000;
+    constexpr long long swingOffset = 1200;
+    constexpr long long noteLength = 1000;
+    GrooveQuantize quantize;
+    quantize.enabled = true;
+    quantize.gridQuarters = 0.25;
+    quantize.swing = 0.6;
+    std::string error;
+    if (!GrooveTemplate::parse("0 0/80", quantize.groove, error)) {
+        benchFail(name, error.c_str());
+    }
+    coordinator.setGrooveQuantize(quantize);
+    coordinator.setLatencySamples(latency);
+
+    const int chordNotes[] = { 48, 52, 55 };
+    MidiEvent input[4];
+
+    BenchRandom random(1);
+    auto jitter = [&random]() { return static_cast<long long>(random(401)) - 200; };
+
+    size_t triggers = 0;
+    size_t noteOns = 0;
+    size_t noteOffs = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        const long long playStart = coordinator.getSampleTime();
+        long long line = 1;
+        long long nextOn = lineSpacing + swingOffset + jitter();
+        long long nextOff = -1;
+        long long lastOn = -1;
+        for (int b = 0; b < numBlocks; ++b) {
+            const long long blockStart = coordinator.getSampleTime() - playStart;
+            size_t numInput = 0;
+            if (b == 0) {
+                for (int note : chordNotes) {
+                    input[numInput++] = MidiEvent::noteOn(1, note, 90, 0);
+                }
+            }
+            if (nextOff >= blockStart && nextOff < blockStart + blockSize) {
+                input[numInput++] = MidiEvent::noteOff(16, 36, 0, static_cast<int>(nextOff - blockStart));
+                nextOff = -1;
+            }
+            // No triggers in the last blocks, so none is still held at the stop
+            if (nextOn >= blockStart && nextOn < blockStart + blockSize && b < numBlocks - 64) {
+                input[numInput++] = MidiEvent::noteOn(16, 36, 100, static_cast<int>(nextOn - blockStart));
+                nextOff = nextOn + noteLength;
+                ++line;
+                nextOn = line * lineSpacing + ((line & 1) != 0 ? swingOffset : 0) + jitter();
+                ++triggers;
+            }
+            for (const auto& evt : engine.playBlock(input, numInput)) {
+                const long long time = blockStart + evt.samplePosition - latency;
+                if (evt.isNoteOn()) {
+                    const long long index = (time + lineSpacing / 2) / lineSpacing;
+                    const long long expected = index * lineSpacing + ((index & 1) != 0 ? swingOffset : 0);
+                    errors += std::abs(time - expected) > 1;
+                    errors += evt.getVelocity() != ((index & 1) != 0 ? 80 : 100);
+                    lastOn = time;
+                    ++noteOns;
+                } else {
+                    errors += time - lastOn != noteLength;
+                    ++noteOffs;
+                }
+            }
+        }
+        engine.stop();
+    });
+
+    triggers = engine.perRun(triggers);
+    noteOns = engine.perRun(noteOns);
+    noteOffs = engine.perRun(noteOffs);
+    const bool ok = errors == 0 && noteOns == triggers && noteOffs == noteOns;
+    engine.report(seconds, ok ? nullptr : "quantized notes missing or with wrong onset/velocity/length",
+                  "%zu triggers -> %zu notes, %zu errors", triggers, noteOns, errors);
+}
+
+// A chord change every 64 blocks, played by hand: the three note-offs within 15 ms, the three
+// note-ons 15-30 ms after the change. Triggers of chord index 0-2 every 8 blocks. With a 35 ms
+// settle window each trigger plays all notes of either the previous or the new chord (the one
+// settled at the trigger) and the chord changes once per change.
+void benchChordSettle(const BenchOptions& options) {
+    const char* name = "engine/chord-settle";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+
+    constexpr int settleSamples = 1680;
+    constexpr long long changeSpacing = 64LL * blockSize;
+    constexpr long long triggerSpacing = 8LL * blockSize;
+    coordinator.setChordSettleSamples(settleSamples);
+
+    const int chords[4][3] = { { 48, 52, 55 }, { 50, 53, 57 }, { 43, 47, 50 }, { 45, 48, 52 } };
+    MidiEvent input[16];
+    BenchRandom random(7);
+
+    size_t triggers = 0;
+    size_t noteOns = 0;
+    size_t chordEvents = 0;
+    long long commits = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        const long long playStart = coordinator.getSampleTime();
+        const long long firstCommit = coordinator.getChordCommitCount();
+        // Offsets of the current change's chord events (relative to the change) and when it settles
+        std::array<long long, 6> changeOffsets {};
+        long long settleTime = 0;
+        int change = -1;
+        for (int b = 0; b < numBlocks; ++b) {
+            const long long blockStart = coordinator.getSampleTime() - playStart;
+            size_t numInput = 0;
+            if (blockStart % changeSpacing == 0) {
+                ++change;
+                long long last = 0;
+                for (size_t i = 0; i < changeOffsets.size(); ++i) {
+                    changeOffsets[i] = i < 3 ? random(720) : 720 + random(720);
+                    last = std::max(last, changeOffsets[i]);
+                }
+                settleTime = blockStart + last + settleSamples;
+            }
+            const long long changeStart = static_cast<long long>(change) * changeSpacing;
+            for (size_t i = 0; i < changeOffsets.size(); ++i) {
+                const long long offset = changeStart + changeOffsets[i] - blockStart;
+                if (offset < 0 || offset >= blockSize || (i < 3 && change == 0)) {
+                    continue;
+                }
+                const int position = static_cast<int>(offset);
+                input[numInput++] = i < 3 ? MidiEvent::noteOff(1, chords[(change + 3) % 4][i], 0, position)
+                                          : MidiEvent::noteOn(1, chords[change % 4][i - 3], 90, position);
+                ++chordEvents;
+            }
+            const bool trigger = blockStart % triggerSpacing == 0 && b >= 64;
+            if (trigger) {
+                for (int key = 0; key < 3; ++key) {
+                    input[numInput++] = MidiEvent::noteOn(16, 24 + key, 100, 0);
+                    input[numInput++] = MidiEvent::noteOff(16, 24 + key, 0, 100);
+                }
+                ++triggers;
+            }
+            const auto& output = engine.playBlock(input, numInput);
+
+            const int expectedChord = (blockStart >= settleTime ? change : change + 3) % 4;
+            for (const auto& evt : output) {
+                if (evt.isNoteOn()) {
+                    const bool known = std::find(std::begin(chords[expectedChord]), std::end(chords[expectedChord]),
+                                                 evt.getNoteNumber()) != std::end(chords[expectedChord]);
+                    errors += !trigger || !known;
+                    ++noteOns;
+                }
+            }
+        }
+        engine.stop();
+        commits += coordinator.getChordCommitCount() - firstCommit;
+    });
+
+    triggers = engine.perRun(triggers);
+    noteOns = engine.perRun(noteOns);
+    chordEvents = engine.perRun(chordEvents);
+    commits = engine.perRun(commits);
+    const bool ok = errors == 0 && noteOns == 3 * triggers && commits == numBlocks / 64;
+    engine.report(seconds, ok ? nullptr : "partial or wrong chords played, or chord changes not settled once",
+                  "%zu chord events -> %lld chord changes, %zu triggers -> %zu notes, %zu errors", chordEvents,
+                  commits, triggers, noteOns, errors);
+}
+
+// Block chord changes every 32 blocks (at sample 100 of the block), each preceded by a hit of
+// chord index 0-2 up to 384 samples (8 ms) early, another hit 16 blocks later. The 480-sample grace
+// window (reported as latency) lets every hit play the chord it belongs to, 480 samples after it.
+void benchChordGrace(const BenchOptions& options) {
+    const char* name = "engine/chord-grace";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+
+    constexpr int graceSamples = 480;
+    constexpr long long changeSpacing = 32LL * blockSize;
+    coordinator.setLatencySamples(graceSamples);
+    coordinator.setChordGraceSamples(graceSamples);
+
+    // No note in two chords, so a note tells which chord a hit resolved against
+    const int chords[4][3] = { { 48, 52, 55 }, { 50, 53, 57 }, { 43, 47, 54 }, { 45, 49, 56 } };
+    MidiEvent input[16];
+    BenchRandom random(3);
+
+    size_t hits = 0;
+    size_t noteOns = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        const long long playStart = coordinator.getSampleTime();
+        // Pending hits: output time and the chord they must play
+        std::array<long long, 4> hitTime {};
+        std::array<int, 4> hitChord {};
+        size_t numHits = 0;
+        size_t numNotes = 0;
+        int lastKey = -1;
+        long long nextHit = changeSpacing + 100 - random(385);
+        long long nextChange = 100;
+        int change = 0;
+        for (int b = 0; b < numBlocks; ++b) {
+            const long long blockStart = coordinator.getSampleTime() - playStart;
+            const long long blockEnd = blockStart + blockSize;
+            size_t numInput = 0;
+            if (nextHit < blockEnd && b < numBlocks - 8) {
+                // The hit before a change plays the next chord, the one mid-way the current one
+                const bool beforeChange = (numHits & 1) == 0;
+                const int key = random(3);
+                const int position = static_cast<int>(nextHit - blockStart);
+                if (lastKey >= 0) {
+                    input[numInput++] = MidiEvent::noteOff(16, 24 + lastKey, 0, position);
+                }
+                input[numInput++] = MidiEvent::noteOn(16, 24 + key, 100, position);
+                lastKey = key;
+                hitTime[numHits % hitTime.size()] = nextHit + graceSamples;
+                hitChord[numHits % hitChord.size()] = (beforeChange ? change : change - 1) % 4;
+                ++numHits;
+                ++hits;
+                nextHit = beforeChange ? nextChange + changeSpacing / 2 : nextChange + changeSpacing - random(385);
+            }
+            if (nextChange < blockEnd) {
+                const int position = static_cast<int>(nextChange - blockStart);
+                for (int i = 0; i < 3; ++i) {
+                    if (change > 0) {
+                        input[numInput++] = MidiEvent::noteOff(1, chords[(change - 1) % 4][i], 0, position);
+                    }
+                    input[numInput++] = MidiEvent::noteOn(1, chords[change % 4][i], 90, position);
+                }
+                ++change;
+                nextChange += changeSpacing;
+            }
+            for (const auto& evt : engine.playBlock(input, numInput)) {
+                if (evt.isNoteOn()) {
+                    const size_t index = numNotes % hitTime.size();
+                    const int* chord = chords[hitChord[index]];
+                    const bool known = std::find(chord, chord + 3, evt.getNoteNumber()) != chord + 3;
+                    errors += blockStart + evt.samplePosition != hitTime[index] || !known;
+                    ++numNotes;
+                }
+            }
+        }
+        noteOns += numNotes;
+        engine.stop();
+    });
+
+    hits = engine.perRun(hits);
+    noteOns = engine.perRun(noteOns);
+    const bool ok = errors == 0 && noteOns == hits && coordinator.getDroppedTriggerCount() == 0;
+    engine.report(seconds, ok ? nullptr : "hits missing, mistimed or resolved against the wrong chord",
+                  "%zu hits -> %zu notes, latency %d samples, peak %zu/%zu pending, %zu errors", hits, noteOns,
+                  coordinator.getLatencySamples(), coordinator.getPendingRhythm().getPeakSize(),
+                  coordinator.getPendingRhythm().capacity(), errors);
+}
+
+// Five held keys (chord indices 0-3, index 0 an octave up) over four-note chords changing every
+// 16 blocks at sample 60; the keys are released and pressed again every 128 blocks. After each
+// block the sounding pitches (from the output) must be exactly what the held keys give in the chord.
+void benchChordFollow(const BenchOptions& options) {
+    const char* name = "engine/chord-follow";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+    coordinator.setChordFollow(true);
+
+    // Cmaj7, Am7, Fmaj7, G7: two or three pitches shared with the previous chord
+    const int chords[4][4] = { { 48, 52, 55, 59 }, { 45, 48, 52, 55 }, { 41, 45, 48, 52 }, { 43, 47, 50, 53 } };
+    const int keys[5] = { 24, 25, 26, 27, 36 };
+    auto chordMask = [&](int chord) {
+        NoteMask mask;
+        for (int note : chords[chord % 4]) {
+            mask.set(note);
+        }
+        mask.set(chords[chord % 4][0] + 12);
+        return mask;
+    };
+
+    MidiEvent input[32];
+    size_t changes = 0;
+    size_t expectedPitches = 0;
+    long long followedPitches = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        const long long firstFollowed = coordinator.getFollowedPitchCount();
+        NoteMask sounding;
+        int chord = 0;
+        for (int b = 0; b < numBlocks; ++b) {
+            size_t numInput = 0;
+            const bool changeChord = b % 16 == 0;
+            if (changeChord) {
+                for (int i = 0; i < 4; ++i) {
+                    if (b > 0) {
+                        input[numInput++] = MidiEvent::noteOff(1, chords[(chord - 1) % 4][i], 0, 60);
+                    }
+                    input[numInput++] = MidiEvent::noteOn(1, chords[chord % 4][i], 90, 60);
+                }
+            }
+            if (b % 128 == 1) {
+                for (int key : keys) {
+                    if (b > 1) {
+                        input[numInput++] = MidiEvent::noteOff(16, key, 0, 0);
+                    }
+                    input[numInput++] = MidiEvent::noteOn(16, key, 100, 10);
+                }
+            }
+            for (const auto& evt : engine.playBlock(input, numInput)) {
+                const int note = evt.getNoteNumber();
+                if (evt.isNoteOn()) {
+                    errors += sounding.test(note);
+                    sounding.set(note);
+                } else if (evt.isNoteOff()) {
+                    errors += !sounding.take(note);
+                }
+            }
+            if (changeChord) {
+                if (b > 1) {
+                    expectedPitches += static_cast<size_t>((chordMask(chord - 1) ^ chordMask(chord)).count());
+                    ++changes;
+                }
+                ++chord;
+            }
+            if (b >= 1) {
+                errors += sounding != chordMask(chord - 1);
+            }
+        }
+        followedPitches += coordinator.getFollowedPitchCount() - firstFollowed;
+        engine.stop();
+    });
+
+    changes = engine.perRun(changes);
+    expectedPitches = engine.perRun(expectedPitches);
+    followedPitches = engine.perRun(followedPitches);
+    const bool ok = errors == 0 && static_cast<size_t>(followedPitches) == expectedPitches;
+    engine.report(seconds, ok ? nullptr : "held notes retriggered, missing or not following the chord",
+                  "%zu chord changes -> %lld pitch changes (%zu expected), %zu errors", changes, followedPitches,
+                  expectedPitches, errors);
+}
+
+// A 64-block cycle of sustain (CC64) and sostenuto (CC66) pedal moves and chord changes, latch on
+// in every other cycle. Triggers of four keys (chord indices 0-3) at fixed blocks must play the
+// chord the pedals and latch leave at that point.
+void benchChordPedal(const BenchOptions& options) {
+    const char* name = "engine/chord-pedal";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+
+    const int chordA[3] = { 48, 52, 55 };
+    const int chordB[3] = { 50, 53, 57 };
+    NoteMask maskA;
+    NoteMask maskB;
+    for (int i = 0; i < 3; ++i) {
+        maskA.set(chordA[i]);
+        maskB.set(chordB[i]);
+    }
+    NoteMask maskB60 = maskB;
+    maskB60.set(60);
+
+    MidiEvent input[16];
+    size_t triggers = 0;
+    size_t noteOns = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        for (int b = 0; b < numBlocks; ++b) {
+            const bool latch = (b / 64) % 2 == 0;
+            coordinator.setChordLatch(latch);
+            size_t numInput = 0;
+            NoteMask expected;
+            bool trigger = false;
+            switch (b % 64) {
+                case 0:
+                    input[numInput++] = MidiEvent::controller(1, 64, 127, 20);
+                    for (int note : chordA) {
+                        input[numInput++] = MidiEvent::noteOn(1, note, 90, 20);
+                    }
+                    break;
+                case 4:
+                    for (int note : chordA) {
+                        input[numInput++] = MidiEvent::noteOff(1, note, 0, 30);
+                    }
+                    break;
+                case 8:  trigger = true; expected = maskA; break;
+                case 16: input[numInput++] = MidiEvent::controller(1, 64, 0, 40); break;
+                case 20: trigger = true; expected = latch ? maskA : NoteMask(); break;
+                case 28:
+                    for (int note : chordB) {
+                        input[numInput++] = MidiEvent::noteOn(1, note, 90, 50);
+                    }
+                    break;
+                case 32: trigger = true; expected = maskB; break;
+                case 36:
+                    input[numInput++] = MidiEvent::controller(1, 66, 127, 5);
+                    input[numInput++] = MidiEvent::noteOn(1, 60, 90, 6);
+                    break;
+                case 40:
+                    for (int note : chordB) {
+                        input[numInput++] = MidiEvent::noteOff(1, note, 0, 7);
+                    }
+                    input[numInput++] = MidiEvent::noteOff(1, 60, 0, 7);
+                    break;
+                case 44: trigger = true; expected = latch ? maskB60 : maskB; break;
+                case 48: input[numInput++] = MidiEvent::controller(1, 66, 0, 8); break;
+                case 52: trigger = true; expected = latch ? maskB60 : NoteMask(); break;
+                default: break;
+            }
+            if (trigger) {
+                for (int key = 24; key < 28; ++key) {
+                    input[numInput++] = MidiEvent::noteOn(16, key, 100, 0);
+                    input[numInput++] = MidiEvent::noteOff(16, key, 0, 100);
+                }
+                ++triggers;
+            }
+            NoteMask played;
+            for (const auto& evt : engine.playBlock(input, numInput)) {
+                if (evt.isNoteOn()) {
+                    errors += played.test(evt.getNoteNumber());
+                    played.set(evt.getNoteNumber());
+                    ++noteOns;
+                }
+            }
+            errors += played != expected;
+        }
+        engine.stop();
+    });
+
+    engine.report(seconds, errors != 0 ? "triggers played a chord the pedals or latch should not have left" : nullptr,
+                  "%zu triggers -> %zu notes, %zu errors", engine.perRun(triggers), engine.perRun(noteOns), errors);
+}
+
+// An 8-block cycle on the output channel, Clean and Legato cleanup by turns: a rhythm retrigger
+// (same-sample note-off + note-on of a sounding pitch) plus scheduled redundant events (a note-off
+// of a silent pitch, a note-on cancelled at its own sample, an off-before-on of a silent pitch, a
+// second note-off). The rhythm key's poly aftertouch is routed, at the sample of its note-on and of
+// the retrigger. Every block's output must be exactly what is left: note-offs, note-ons, aftertouch.
+void benchOutputCleanup(const BenchOptions& options) {
+    const char* name = "engine/output-cleanup";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+    ControlRouting routing;
+    routing.rhythmInput = ControlRouting::polyAftertouch;
+    coordinator.setControlRouting(routing);
+
+    struct Expected {
+        int status;
+        int note;
+        int position;
+    };
+    MidiEvent input[8];
+    size_t generated = 0;
+    size_t removed = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        const size_t firstRemoved = coordinator.getOutputPeephole().getRemovedCount();
+        for (int b = 0; b < numBlocks; ++b) {
+            const bool legato = (b / 8) % 2 != 0;
+            coordinator.setOutputCleanup(legato ? OutputCleanup::Legato : OutputCleanup::Clean);
+            const long long blockStart = coordinator.getSampleTime();
+            size_t numInput = 0;
+            Expected expected[3];
+            size_t numExpected = 0;
+            if (b == 0) {
+                input[numInput++] = MidiEvent::noteOn(1, 48, 90, 0);
+                input[numInput++] = MidiEvent::noteOn(1, 52, 90, 0);
+                input[numInput++] = MidiEvent::noteOn(1, 55, 90, 0);
+            }
+            switch (b % 8) {
+                case 0:
+                    input[numInput++] = MidiEvent::aftertouch(16, 24, 40, 10);
+                    input[numInput++] = MidiEvent::noteOn(16, 24, 100, 10);
+                    expected[numExpected++] = { 0x91, 48, 10 };
+                    expected[numExpected++] = { 0xa1, 48, 10 };
+                    break;
+                case 1:
+                    input[numInput++] = MidiEvent::noteOn(16, 24, 100, 100);
+                    input[numInput++] = MidiEvent::aftertouch(16, 24, 50, 100);
+                    input[numInput++] = MidiEvent::noteOff(16, 24, 0, 100);
+                    if (!legato) {
+                        expected[numExpected++] = { 0x81, 48, 100 };
+                        expected[numExpected++] = { 0x91, 48, 100 };
+                    }
+                    expected[numExpected++] = { 0xa1, 48, 100 };
+                    break;
+                case 2:
+                    input[numInput++] = MidiEvent::noteOff(16, 24, 0, 50);
+                    expected[numExpected++] = { 0x81, 48, 50 };
+                    break;
+                case 3:
+                    coordinator.scheduleOutputEvent(MidiEvent::noteOff(2, 72, 0, 0), blockStart + 20);
+                    break;
+                case 4:
+                    coordinator.scheduleOutputEvent(MidiEvent::noteOn(2, 72, 100, 0), blockStart + 30);
+                    coordinator.scheduleOutputEvent(MidiEvent::noteOff(2, 72, 0, 0), blockStart + 30);
+                    break;
+                case 5:
+                    coordinator.scheduleOutputEvent(MidiEvent::noteOff(2, 74, 0, 0), blockStart + 40);
+                    coordinator.scheduleOutputEvent(MidiEvent::noteOn(2, 74, 100, 0), blockStart + 40);
+                    expected[numExpected++] = { 0x91, 74, 40 };
+                    break;
+                case 6:
+                    coordinator.scheduleOutputEvent(MidiEvent::noteOff(2, 74, 0, 0), blockStart + 40);
+                    coordinator.scheduleOutputEvent(MidiEvent::noteOff(2, 74, 0, 0), blockStart + 60);
+                    expected[numExpected++] = { 0x81, 74, 40 };
+                    break;
+                default: break;
+            }
+            const auto& output = engine.playBlock(input, numInput);
+            errors += output.size() != numExpected;
+            for (size_t i = 0; i < output.size() && i < numExpected; ++i) {
+                errors += output[i].status != expected[i].status || output[i].data1 != expected[i].note
+                          || output[i].samplePosition != expected[i].position;
+            }
+            generated += output.size();
+        }
+        removed += coordinator.getOutputPeephole().getRemovedCount() - firstRemoved;
+        engine.stop();
+    });
+
+    generated = engine.perRun(generated);
+    removed = engine.perRun(removed);
+    // Per 16 blocks: 5 events removed by Clean, 7 by Legato
+    const size_t expectedRemoved = static_cast<size_t>(numBlocks / 16) * 12;
+    const bool ok = errors == 0 && removed == expectedRemoved;
+    engine.report(seconds, ok ? nullptr : "redundant note events left in the output, needed ones removed or out of order",
+                  "%zu events out, %zu removed (%zu expected), %zu errors", generated, removed, expectedRemoved,
+                  errors);
+}
+
+// Every block: a mod wheel sweep (8 values) and a sustain pedal on the chord channel, bank select,
+// pitch bend, channel pressure and aftertouch sweeps on the rhythm channel while two rhythm keys
+// hold their notes. With thinning only the last value of each control may come out (both bank
+// selects, no pedal), aftertouch on the note of its key.
+void benchControlRouting(const BenchOptions& options) {
+    const char* name = "engine/control-routing";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+    ControlRouting routing;
+    routing.chordInput = ControlRouting::controllers;
+    routing.rhythmInput = ControlRouting::all;
+    coordinator.setControlRouting(routing);
+
+    MidiEvent input[32];
+    size_t routed = 0;
+    size_t thinned = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        const size_t firstRouted = coordinator.getRoutedControlCount();
+        const size_t firstThinned = coordinator.getThinnedControlCount();
+        for (int b = 0; b < numBlocks; ++b) {
+            size_t numInput = 0;
+            if (b == 0) {
+                input[numInput++] = MidiEvent::noteOn(1, 48, 90, 0);
+                input[numInput++] = MidiEvent::noteOn(1, 52, 90, 0);
+                input[numInput++] = MidiEvent::noteOn(16, 24, 100, 0);
+                input[numInput++] = MidiEvent::noteOn(16, 25, 100, 0);
+            }
+            // Rhythm channel first, as hosts group by channel
+            for (int i = 0; i < 4; ++i) {
+                input[numInput++] = MidiEvent(0xef, 0, static_cast<uint8_t>((b + i) & 127), 100 + i);
+                input[numInput++] = MidiEvent(0xdf, static_cast<uint8_t>((b + i) & 127), 0, 120 + i);
+                input[numInput++] = MidiEvent::aftertouch(16, 24, (b + i) & 127, 140 + i);
+            }
+            input[numInput++] = MidiEvent::controller(16, 0, b & 127, 3);
+            input[numInput++] = MidiEvent::controller(16, 0, (b + 1) & 127, 4);
+            input[numInput++] = MidiEvent::controller(1, 64, 0, 5);
+            for (int i = 0; i < 8; ++i) {
+                input[numInput++] = MidiEvent::controller(1, 1, (b + i) & 127, 10 + i * 10);
+            }
+            const auto& output = engine.playBlock(input, numInput);
+
+            // Expected controls in time order: status, data1, data2, position
+            const int expected[6][4] = {
+                { 0xb1, 0, b & 127, 3 },
+                { 0xb1, 0, (b + 1) & 127, 4 },
+                { 0xb1, 1, (b + 7) & 127, 80 },
+                { 0xe1, 0, (b + 3) & 127, 103 },
+                { 0xd1, (b + 3) & 127, 0, 123 },
+                { 0xa1, 48, (b + 3) & 127, 143 },
+            };
+            size_t numControls = 0;
+            for (const auto& evt : output) {
+                if (evt.isNoteOn() || evt.isNoteOff()) {
+                    continue;
+                }
+                const int* want = expected[numControls < 6 ? numControls : 5];
+                errors += numControls >= 6 || evt.status != want[0] || evt.data1 != want[1] || evt.data2 != want[2]
+                          || evt.samplePosition != want[3];
+                ++numControls;
+            }
+            errors += numControls != 6;
+        }
+        routed += coordinator.getRoutedControlCount() - firstRouted;
+        thinned += coordinator.getThinnedControlCount() - firstThinned;
+        engine.stop();
+    });
+
+    routed = engine.perRun(routed);
+    thinned = engine.perRun(thinned);
+    const bool ok = errors == 0 && routed == static_cast<size_t>(numBlocks) * 6
+                    && thinned == static_cast<size_t>(numBlocks) * 16;
+    engine.report(seconds, ok ? nullptr : "controls missing, not thinned, misrouted or out of order",
+                  "%zu controls routed, %zu thinned, %zu errors", routed, thinned, errors);
+}
+
+// A 32-block cycle through a 480-sample grace window (960 samples latency), poly aftertouch of the
+// rhythm keys routed without thinning: a key (chord index 0) with aftertouch at its note-on and
+// 80 samples later, then the strum key (1/32 up) with aftertouch at its trigger. Every aftertouch
+// must reach a sounding note, after its note-on, at max(input time + latency, note-on time).
+void benchAftertouchDelay(const BenchOptions& options) {
+    const char* name = "engine/aftertouch-delay";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+    constexpr int graceSamples = 480;
+    constexpr int latency = 960;
+    coordinator.setLatencySamples(latency);
+    coordinator.setChordGraceSamples(graceSamples);
+    NoteStrum strum;
+    strum.key = 12;
+    strum.spreadQuarters = 0.125;
+    coordinator.setStrum(strum);
+    ControlRouting routing;
+    routing.rhythmInput = ControlRouting::polyAftertouch;
+    routing.thin = false;
+    coordinator.setControlRouting(routing);
+
+    MidiEvent input[8];
+    size_t strums = 0;
+    size_t aftertouches = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        // Per pitch: output time of the sounding note-on (-1 = not sounding); per aftertouch
+        // value: when it was input
+        std::array<long long, 128> onTime {};
+        std::array<long long, 128> inputTime {};
+        onTime.fill(-1);
+        for (int b = 0; b < numBlocks; ++b) {
+            const long long blockStart = coordinator.getSampleTime();
+            size_t numInput = 0;
+            if (b == 0) {
+                input[numInput++] = MidiEvent::noteOn(1, 48, 90, 0);
+                input[numInput++] = MidiEvent::noteOn(1, 52, 90, 0);
+                input[numInput++] = MidiEvent::noteOn(1, 55, 90, 0);
+            }
+            switch (b % 32) {
+                case 0:
+                    // Aftertouch first, as hosts group by status
+                    input[numInput++] = MidiEvent::aftertouch(16, 24, 40, 20);
+                    input[numInput++] = MidiEvent::noteOn(16, 24, 100, 20);
+                    input[numInput++] = MidiEvent::aftertouch(16, 24, 41, 100);
+                    inputTime[40] = blockStart + 20;
+                    inputTime[41] = blockStart + 100;
+                    break;
+                case 8: input[numInput++] = MidiEvent::noteOff(16, 24, 0, 0); break;
+                case 16:
+                    input[numInput++] = MidiEvent::noteOn(16, 36, 100, 30);
+                    input[numInput++] = MidiEvent::aftertouch(16, 36, 42, 30);
+                    inputTime[42] = blockStart + 30;
+                    ++strums;
+                    break;
+                case 30: input[numInput++] = MidiEvent::noteOff(16, 36, 0, 0); break;
+                default: break;
+            }
+            for (const auto& evt : engine.playBlock(input, numInput)) {
+                const long long time = blockStart + evt.samplePosition;
+                const size_t note = static_cast<size_t>(evt.getNoteNumber());
+                if (evt.isNoteOn()) {
+                    errors += onTime[note] >= 0;
+                    onTime[note] = time;
+                } else if (evt.isNoteOff()) {
+                    errors += onTime[note] < 0;
+                    onTime[note] = -1;
+                } else if (evt.isAftertouch()) {
+                    const long long expected = std::max(inputTime[static_cast<size_t>(evt.data2)] + latency, onTime[note]);
+                    errors += onTime[note] < 0 || time != expected;
+                    ++aftertouches;
+                }
+            }
+        }
+        engine.stop();
+    });
+
+    strums = engine.perRun(strums);
+    aftertouches = engine.perRun(aftertouches);
+    // Per cycle: two values to the key's note, one to each of the three strum notes
+    const bool ok = errors == 0 && aftertouches == 5 * strums && coordinator.getDroppedTriggerCount() == 0;
+    engine.report(seconds, ok ? nullptr : "aftertouch lost, before its note-on or mistimed",
+                  "%zu strums, %zu aftertouch out, %zu errors", strums, aftertouches, errors);
+}
+
+// Eight rhythm keys in turn, each held 6 blocks, into a 4-voice cap: every note-on steals a note,
+// the policy changes every 1024 blocks (with notes playing)
+void benchVoiceSteal(const BenchOptions& options) {
+    const char* name = "engine/voice-steal";
+    if (!options.matches(name)) {
+        return;
+    }
+    EngineHarness engine(name);
+    ChordPatternCoordinator& coordinator = engine.coordinator;
+    const int maxVoices = 4;
+    coordinator.setMaxVoices(maxVoices);
+
+    const int chord[8] = { 48, 50, 53, 55, 57, 60, 62, 65 };
+    const VoiceSteal policies[4] = { VoiceSteal::Oldest, VoiceSteal::LowestVelocity,
+                                     VoiceSteal::HighestPitch, VoiceSteal::LowestPitch };
+
+    // Reference model: the playing notes, oldest first
+    struct ModelNote {
+        int key;
+        int pitch;
+        int velocity;
+    };
+    ModelNote model[8];
+    int numModel = 0;
+
+    MidiEvent input[16];
+    size_t stolen = 0;
+    size_t expectedStolen = 0;
+    size_t errors = 0;
+
+    const double seconds = engine.run(options.repetitions, [&]() {
+        numModel = 0;
+        const size_t firstStolen = coordinator.getStolenVoiceCount();
+        for (int b = 0; b < numBlocks; ++b) {
+            const VoiceSteal policy = policies[(b / 1024) % 4];
+            coordinator.setVoiceSteal(policy);
+
+            size_t numInput = 0;
+            if (b == 0) {
+                for (int pitch : chord) {
+                    input[numInput++] = MidiEvent::noteOn(1, pitch, 90, 0);
+                }
+            }
+            const int offKey = (b + 2) % 8;
+            const int onKey = b % 8;
+            const int velocity = 1 + (b * 37) % 127;
+            if (b >= 6) {
+                input[numInput++] = MidiEvent::noteOff(16, 24 + offKey, 0, 5);
+            }
+            input[numInput++] = MidiEvent::noteOn(16, 24 + onKey, static_cast<uint8_t>(velocity), 10);
+            const auto& output = engine.playBlock(input, numInput);
+
+            // Expected: the released key's note-off (unless it was stolen), the stolen note's
+            // note-off, the new note-on
+            int expected[3][3];
+            int numExpected = 0;
+            for (int i = 0; b >= 6 && i < numModel; ++i) {
+                if (model[i].key == offKey) {
+                    expected[numExpected][0] = 0x81;
+                    expected[numExpected][1] = model[i].pitch;
+                    expected[numExpected++][2] = 5;
+                    std::copy(model + i + 1, model + numModel, model + i);
+                    --numModel;
+                    break;
+                }
+            }
+            if (numModel >= maxVoices) {
+                int victim = 0;
+                for (int i = 1; i < numModel; ++i) {
+                    const bool better = policy == VoiceSteal::LowestVelocity ? model[i].velocity < model[victim].velocity
+                                      : policy == VoiceSteal::HighestPitch ? model[i].pitch > model[victim].pitch
+                                      : policy == VoiceSteal::LowestPitch ? model[i].pitch < model[victim].pitch
+                                      : false;
+                    victim = better ? i : victim;
+                }
+                expected[numExpected][0] = 0x81;
+                expected[numExpected][1] = model[victim].pitch;
+                expected[numExpected++][2] = 10;
+                std::copy(model + victim + 1, model + numModel, model + victim);
+                --numModel;
+                ++expectedStolen;
+            }
+            model[numModel++] = { onKey, chord[onKey], velocity };
+            expected[numExpected][0] = 0x91;
+            expected[numExpected][1] = chord[onKey];
+            expected[numExpected++][2] = 10;
+
+            errors += output.size() != static_cast<size_t>(numExpected);
+            for (size_t i = 0; i < output.size() && i < static_cast<size_t>(numExpected); ++i) {
+                errors += output[i].status != expected[i][0] || output[i].data1 != expected[i][1]
+                          || output[i].samplePosition != expected[i][2];
+            }
+        }
+        stolen += coordinator.getStolenVoiceCount() - firstStolen;
+        engine.stop();
+    });
+
+    stolen = engine.perRun(stolen);
+    expectedStolen = engine.perRun(expectedStolen);
+    const bool ok = errors == 0 && stolen == expectedStolen && stolen != 0;
+    engine.report(seconds, ok ? nullptr : "wrong note stolen, note-off misplaced or steal count off",
+                  "%zu voices stolen, %zu errors", stolen, errors);
+}
+
+// Program change every 8 blocks through a 256-preset bank (varied patterns, key maps, output
+// channels, every 16th preset on another rhythm channel), bank reloaded concurrently
+void benchPresetSwitch(const BenchOptions& options) {
+    const char* name = "engine/preset-switch";
+    if (!options.matches(name)) {
+        return;
+    }
+    constexpr int numPresets = 256;
+    const char* const steps[] = { "x . x x*2", "E(3,8)", "X _ . o . x", "[x .]!3 x*4", "E(5,16,3)" };
+    const char* const divisions[] = { "/16", "/8", "/8t", "/32" };
+
+    std::vector<PresetDefinition> definitions(numPresets);
+    for (int i = 0; i < numPresets; ++i) {
+        PresetDefinition& preset = definitions[static_cast<size_t>(i)];
+        preset.name = "Bench " + std::to_string(i);
+        preset.routing.outputChannel = 2 + i % 4;
+        preset.routing.rhythmInputChannel = i % 16 == 15 ? 15 : 16;
+        preset.hasKeyMap = i % 3 == 0;
+        preset.keyMap.set(0, i % 3, i % 2);
+        const std::string text = "0: " + std::string(steps[i % 5]) + " " + divisions[i % 4] + "\n"
+                                 + std::to_string(i % 12) + ": " + steps[(i + 2) % 5] + " /16\n";
+        std::string error;
+        if (!PatternCompiler::compile(text, preset.pattern, error)) {
+            benchFail(name, error.c_str());
+            return;
+        }
+    }
+    const std::string path = options.workDir + "/bench.phubank";
+    std::string error;
+    PresetSwitcher presets;
+    if (!PresetBank::write(path, definitions, error) || !presets.loadBank(path, error)) {
+        benchFail(name, error.c_str());
+        return;
+    }
+
+    EngineHarness engine(name, 128.0);
+    engine.coordinator.setBeatGrid(&engine.syncGlobals.getBeatGrid());
+
+    const MidiEvent chord[] = { MidiEvent::noteOn(1, 48, 90, 0), MidiEvent::noteOn(1, 52, 90, 0),
+                                MidiEvent::noteOn(1, 55, 90, 0) };
+
+    // Message thread: reload the bank while the audio thread switches programs
+    std::atomic<bool> done { false };
+    int reloads = 0;
+    std::thread loader([&]() {
+        std::string loadError;
+        while (!done.load(std::memory_order_acquire)) {
+            reloads += presets.loadBank(path, loadError) ? 1 : 0;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        presets.collectGarbage();
+    });
+
+    size_t outputEvents = 0;
+    size_t switches = 0;
+    const double seconds = engine.run(options.repetitions, [&]() {
+        for (int b = 0; b < numBlocks; ++b) {
+            if (b % 8 == 0) {
+                presets.programChange((b / 8 * 37) % numPresets);
+            }
+            if (const BankPreset* preset = presets.update()) {
+                PresetSwitcher::apply(*preset, engine.coordinator, engine.syncGlobals);
+                ++switches;
+            }
+            outputEvents += engine.playBlock(chord, b == 0 ? 3 : 0).size();
+        }
+        engine.stop();
+    });
+
+    done.store(true, std::memory_order_release);
+    loader.join();
+
+    outputEvents = engine.perRun(outputEvents);
+    engine.report(seconds, outputEvents == 0 ? "presets produced no notes" : nullptr,
+                  "%zu switches, %d bank reloads, %zu output events", engine.perRun(switches), reloads, outputEvents);
+}
+
+// Host with a 16-quarter loop, a tempo change every 50 blocks and +-0.3 samples of PPQ jitter.
+// Grid lines must come in index order, each once, restarting only after a loop wrap.
+void benchBeatGrid(const BenchOptions& options) {
+    const char* name = "engine/beat-grid";
+    if (!options.matches(name)) {
+        return;
+    }
+    constexpr double sampleRate = 48000.0;
+    constexpr int subdivisions = 4;
+    constexpr double loopStart = 8.0;
+    constexpr double loopEnd = 24.0;
+
+    SyncGlobals syncGlobals;
+    syncGlobals.updateSampleRate(sampleRate);
+    syncGlobals.setGridSubdivisionsPerQuarter(subdivisions);
+
+    TransportInfo transport;
+    transport.isValid = true;
+    transport.hasBpm = true;
+    transport.isPlaying = true;
+    transport.hasPpqPosition = true;
+    transport.hasTimeSignature = true;
+    transport.hasLoopPoints = true;
+    transport.isLooping = true;
+    transport.loopStartPpq = loopStart;
+    transport.loopEndPpq = loopEnd;
+
+    BenchRandom random(99);
+    long long lines = 0;
+    long long errors = 0;
+    long long wraps = 0;
+
+    RealtimeTrap::markCurrentThreadAsAudioThread();
+    RealtimeTrap::resetCounters();
+    const double seconds = measureBestSeconds(options.repetitions, [&]() {
+        double ppq = 0.0;
+        long long expectedIndex = 0;
+        lines = errors = wraps = 0;
+        for (int b = 0; b < numBlocks; ++b) {
+            transport.bpm = 80.0 + (b / 50) % 9 * 10.0;
+            const double ppqPerSample = transport.bpm / (60.0 * sampleRate);
+            const double jitter = (static_cast<double>(random.next()) / 16777216.0 - 0.5) * 0.6 * ppqPerSample;
+            transport.ppqPosition = ppq + jitter;
+            transport.ppqPositionOfLastBarStart = std::floor(ppq / 4.0) * 4.0;
+
+            {
+                PHU_ARP_RT_SECTION();
+                syncGlobals.updateDAWGlobals(blockSize, transport);
+            }
+            int lastOffset = -1;
+            for (const GridBoundary& line : syncGlobals.getBeatGrid()) {
+                if (line.afterJump && b > 0) {
+                    ++wraps;
+                    expectedIndex = static_cast<long long>(loopStart * subdivisions);
+                }
+                errors += (line.index != expectedIndex || line.sampleOffset <= lastOffset) ? 1 : 0;
+                expectedIndex = line.index + 1;
+                lastOffset = line.sampleOffset;
+                ++lines;
+            }
+            syncGlobals.finishRun(blockSize);
+
+            ppq += blockSize * ppqPerSample;
+            if (ppq >= loopEnd) {
+                ppq = loopStart + (ppq - loopEnd);
+            }
+        }
+        transport.isPlaying = false;
+        syncGlobals.updateDAWGlobals(blockSize, transport);
+        transport.isPlaying = true;
+    });
+    RealtimeTrap::clearCurrentThreadAsAudioThread();
+
+    std::printf("%-32s %9.1f ns/block, %lld lines, %lld loop wraps, %lld errors\n", name,
+                seconds * 1e9 / numBlocks, lines, wraps, errors);
+    if (errors != 0 || wraps == 0 || syncGlobals.getBeatGrid().getDroppedCount() != 0) {
+        benchFail(name, "grid lines missing, duplicated or out of order");
+    }
+    expectRealtimeSafe(name);
+}
+
+} // namespace
+
+void runEngineBenchmarks(const BenchOptions& options) {
+    benchBeatGrid(options);
+    benchPatternCompile(options);
+    benchRhythmGenerator(options);
+    benchScheduler(options);
+    benchGate(options);
+    benchStrum(options);
+    benchQuantize(options);
+    benchChordSettle(options);
+    benchChordGrace(options);
+    benchChordPedal(options);
+    benchChordFollow(options);
+    benchOutputCleanup(options);
+    benchControlRouting(options);
+    benchAftertouchDelay(options);
+    benchVoiceSteal(options);
+    benchPresetSwitch(options);
+    if (!options.matches("engine/process-block")) {
+        return;
+    }
+    const BlockStream stream = generateBlocks();
+    benchProcessBlock(options, stream);
+}
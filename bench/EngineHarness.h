@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Bench.h"
+#include "ChordNotesTracker.h"
+#include "ChordPatternCoordinator.h"
+#include "PatternTracker.h"
+#include "../lib/SyncGlobals.h"
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#if defined(__GNUC__)
+#define PHU_ARP_BENCH_PRINTF(formatIndex, firstArg) __attribute__((format(printf, formatIndex, firstArg)))
+#else
+#define PHU_ARP_BENCH_PRINTF(formatIndex, firstArg)
+#endif
+
+/**
+ * Seeded linear congruential generator, so every run of a case plays the same scenario.
+ * The low bits of an LCG are poorly distributed; next() drops shift of them (8 by default).
+ */
+class BenchRandom {
+public:
+    explicit BenchRandom(uint32_t seedToUse, int shiftToUse = 8) noexcept : seed(seedToUse), shift(shiftToUse) {}
+
+    /**
+     * Next value in 0..range-1
+     */
+    int operator()(int range) noexcept { return static_cast<int>(next() % static_cast<uint32_t>(range)); }
+
+    /**
+     * Next raw value (32 - shift bits)
+     */
+    uint32_t next() noexcept {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> shift;
+    }
+
+private:
+    uint32_t seed;
+    int shift;
+};
+
+/**
+ * EngineHarness
+ *
+ * Fixture of the engine/ benchmark cases: a ChordPatternCoordinator bound to its own
+ * CoordinatorSyncGlobals at 48 kHz and a host transport (120 BPM unless given), driven
+ * numBlocks blocks of blockSize samples per run as a host would. run() times the runs on a
+ * thread marked as the audio thread (PHU_ARP_RT_TRAP builds), report() prints the case's line,
+ * fails it if asked to and checks the realtime trap counters.
+ *
+ * Usage:
+ *   EngineHarness engine(name);
+ *   engine.coordinator.setMaxVoices(4);
+ *   const double seconds = engine.run(options.repetitions, [&]() {
+ *       for (int b = 0; b < EngineHarness::numBlocks; ++b) {
+ *           for (const auto& evt : engine.playBlock(input, numInput)) { ... }
+ *       }
+ *       engine.stop();
+ *   });
+ *   engine.report(seconds, errors != 0 ? "notes missing" : nullptr, "%zu notes", engine.perRun(notes));
+ */
+class EngineHarness {
+public:
+    static constexpr int blockSize = 256;
+    static constexpr int numBlocks = 200000;
+
+    CoordinatorSyncGlobals syncGlobals;
+    ChordNotesTracker chordTracker;
+    PatternTracker patternTracker { chordTracker };
+    ChordPatternCoordinator coordinator { chordTracker, patternTracker };
+    TransportInfo transport;
+
+    explicit EngineHarness(const char* caseName, double bpm = 120.0) : name(caseName) {
+        syncGlobals.getStaticListeners().bind(coordinator);
+        syncGlobals.updateSampleRate(48000.0);
+        transport.isValid = true;
+        transport.hasBpm = true;
+        transport.bpm = bpm;
+    }
+
+    ~EngineHarness() { syncGlobals.getStaticListeners().unbind<ChordPatternCoordinator>(); }
+
+    EngineHarness(const EngineHarness&) = delete;
+    EngineHarness& operator=(const EngineHarness&) = delete;
+
+    /**
+     * Time the scenario (best of repetitions); the transport is playing at the start of each run.
+     * The scenario ends with stop() unless the next run should go on where it left off.
+     */
+    template<typename Fn>
+    double run(int repetitionsToRun, Fn&& scenario) {
+        repetitions = repetitionsToRun;
+        RealtimeTrap::markCurrentThreadAsAudioThread();
+        RealtimeTrap::resetCounters();
+        const double seconds = measureBestSeconds(repetitions, [&]() {
+            transport.isPlaying = true;
+            scenario();
+        });
+        RealtimeTrap::clearCurrentThreadAsAudioThread();
+        return seconds;
+    }
+
+    /**
+     * Process one block of input events
+     * @return The block's output events
+     */
+    const std::vector<MidiEvent>& playBlock(const MidiEvent* input, size_t numInput) {
+        syncGlobals.updateDAWGlobals(blockSize, transport);
+        coordinator.processBlock(input, numInput, blockSize);
+        syncGlobals.finishRun(blockSize);
+        return coordinator.getOutputEvents();
+    }
+
+    /**
+     * Stop the transport: flush hanging notes, leave clean state for the next run
+     */
+    void stop() {
+        transport.isPlaying = false;
+        syncGlobals.updateDAWGlobals(blockSize, transport);
+        coordinator.takeStopFlush();
+    }
+
+    /**
+     * A count summed over all runs, per run
+     */
+    template<typename T>
+    T perRun(T total) const noexcept { return total / static_cast<T>(repetitions); }
+
+    /**
+     * Print the case's line: time per block, then the printf-style details. Fail the case with
+     * failure unless it is null, then check the realtime trap counters.
+     */
+    void report(double seconds, const char* failure, const char* format, ...) const PHU_ARP_BENCH_PRINTF(4, 5) {
+        std::printf("%-32s %9.1f ns/block (%d samples), ", name, seconds * 1e9 / numBlocks, blockSize);
+        va_list args;
+        va_start(args, format);
+        std::vprintf(format, args);
+        va_end(args);
+        std::printf("\n");
+        if (failure != nullptr) {
+            benchFail(name, failure);
+        }
+        expectRealtimeSafe(name);
+    }
+
+private:
+    const char* name;
+    int repetitions = 1;
+};
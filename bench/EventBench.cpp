@@ -0,0 +1,277 @@
+/**
+ * GLOBALS event dispatch: dynamic listener vector (virtual call per listener) versus the
+ * compile-time listener set (direct, inlinable call), each with one and with four listeners.
+ * events/rcu-churn dispatches while another thread keeps adding/removing listeners.
+ * events/bridge measures the audio-side cost of posting to GlobalsEventBridge while a consumer
+ * thread delivers the coalesced events.
+ * events/beat-buffers changes the tempo while blocks run and checks that the new buffers arrive
+ * without allocating on the audio thread.
+ */
+
+#include "Bench.h"
+#include "../lib/BeatBuffers.h"
+#include "../lib/GlobalsEventBridge.h"
+#include "../lib/SyncGlobals.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+constexpr int numEvents = 20000000;
+
+class CountingListener : public GlobalsEventListener {
+public:
+    uint64_t sum = 0;
+
+    void onIsPlayingChanged(const IsPlayingEvent& event) override {
+        sum += event.newValue ? 3 : 1;
+    }
+};
+
+template<typename Source>
+double fireEvents(const BenchOptions& options, Source& source) {
+    IsPlayingEvent event;
+    return measureBestSeconds(options.repetitions, [&]() {
+        for (int i = 0; i < numEvents; ++i) {
+            event.newValue = (i & 1) != 0;
+            source.fireIsPlayingChanged(event);
+        }
+    });
+}
+
+void printDispatch(const char* name, double seconds, uint64_t checksum) {
+    std::printf("%-32s %9.3f ms  %9.2f ns/event  (checksum %llu)\n", name, seconds * 1000.0,
+                seconds * 1e9 / numEvents, static_cast<unsigned long long>(checksum));
+}
+
+void benchDynamic(const BenchOptions& options, const char* name, int numListeners) {
+    if (!options.matches(name)) {
+        return;
+    }
+    CountingListener listeners[4];
+    GlobalsEventSource source;
+    for (int i = 0; i < numListeners; ++i) {
+        source.addEventListener(&listeners[i]);
+    }
+    RealtimeTrap::markCurrentThreadAsAudioThread();
+    RealtimeTrap::resetCounters();
+    const double seconds = [&]() {
+        PHU_ARP_RT_SECTION();
+        return fireEvents(options, source);
+    }();
+    RealtimeTrap::clearCurrentThreadAsAudioThread();
+    printDispatch(name, seconds, listeners[0].sum);
+    expectRealtimeSafe(name);
+}
+
+template<typename Dispatch, typename... Listeners>
+void benchStatic(const BenchOptions& options, const char* name, Listeners&... listeners) {
+    if (!options.matches(name)) {
+        return;
+    }
+    Dispatch source;
+    (source.bind(listeners), ...);
+    RealtimeTrap::markCurrentThreadAsAudioThread();
+    RealtimeTrap::resetCounters();
+    const double seconds = [&]() {
+        PHU_ARP_RT_SECTION();
+        return fireEvents(options, source);
+    }();
+    RealtimeTrap::clearCurrentThreadAsAudioThread();
+    printDispatch(name, seconds, (listeners.sum + ...));
+    expectRealtimeSafe(name);
+}
+
+// Audio-style dispatch loop while a "message thread" re-registers listeners as fast as it can
+void benchRcuChurn(const BenchOptions& options) {
+    const char* name = "events/rcu-churn";
+    if (!options.matches(name)) {
+        return;
+    }
+    CountingListener fixed;
+    CountingListener churning[4];
+    GlobalsEventSource source;
+    source.addEventListener(&fixed);
+
+    std::atomic<bool> done { false };
+    std::atomic<uint64_t> registrations { 0 };
+    std::thread messageThread([&]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            for (auto& listener : churning) {
+                source.addEventListener(&listener);
+            }
+            for (auto& listener : churning) {
+                source.removeEventListener(&listener);
+            }
+            registrations.fetch_add(8, std::memory_order_relaxed);
+        }
+    });
+
+    RealtimeTrap::markCurrentThreadAsAudioThread();
+    RealtimeTrap::resetCounters();
+    const double seconds = [&]() {
+        PHU_ARP_RT_SECTION();
+        return fireEvents(options, source);
+    }();
+    RealtimeTrap::clearCurrentThreadAsAudioThread();
+
+    done.store(true);
+    messageThread.join();
+
+    printDispatch(name, seconds, fixed.sum);
+    std::printf("%-32s %llu concurrent registrations\n", name,
+                static_cast<unsigned long long>(registrations.load()));
+    if (fixed.sum != static_cast<uint64_t>(options.repetitions) * (numEvents / 2) * 4) {
+        benchFail(name, "fixed listener missed events");
+    }
+    expectRealtimeSafe(name);
+}
+
+// Audio thread posts to the bridge, a "message thread" delivers as fast as it can
+void benchBridge(const BenchOptions& options) {
+    const char* name = "events/bridge";
+    if (!options.matches(name)) {
+        return;
+    }
+    GlobalsEventSource source;
+    GlobalsEventBridge bridge;
+    CountingListener consumer;
+    source.addEventListener(&bridge);
+    bridge.addEventListener(&consumer);
+
+    std::atomic<bool> done { false };
+    std::thread messageThread([&]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            bridge.deliver();
+            std::this_thread::yield();
+        }
+    });
+
+    RealtimeTrap::markCurrentThreadAsAudioThread();
+    RealtimeTrap::resetCounters();
+    const double seconds = [&]() {
+        PHU_ARP_RT_SECTION();
+        return fireEvents(options, source);
+    }();
+    RealtimeTrap::clearCurrentThreadAsAudioThread();
+
+    done.store(true);
+    messageThread.join();
+    bridge.deliver();
+
+    printDispatch(name, seconds, consumer.sum);
+    std::printf("%-32s %llu posted, %llu delivered after coalescing\n", name,
+                static_cast<unsigned long long>(bridge.getPostedCount()),
+                static_cast<unsigned long long>(bridge.getDeliveredCount()));
+    // The last event fired was "playing"; it must be the state the consumer ends up with
+    if (!bridge.getIsPlaying() || bridge.getDeliveredCount() == 0) {
+        benchFail(name, "final playing state was not delivered");
+    }
+    bridge.removeEventListener(&consumer);
+    source.removeEventListener(&bridge);
+    expectRealtimeSafe(name);
+}
+
+struct BufferSizeListener : BufferEventListener {
+    int changes = 0;
+    int lastGlobalSize = 0;
+    void onBuffersChanged(const BuffersChangedEvent& event) override {
+        ++changes;
+        lastGlobalSize = event.globalSize;
+    }
+};
+
+// Host-paced blocks (sleep between blocks) with a tempo change every 100 blocks; reports how many
+// blocks the background allocation took to arrive
+void benchBeatBuffers(const BenchOptions& options) {
+    const char* name = "events/beat-buffers";
+    if (!options.matches(name)) {
+        return;
+    }
+    constexpr int blocks = 2000;
+    constexpr int blocksPerTempo = 100;
+    constexpr int blockSize = 256;
+
+    SyncGlobals globals;
+    BeatBuffers buffers(4, 2);
+    BufferSizeListener listener;
+    globals.addEventListener(&buffers);
+    buffers.addEventListener(&listener);
+    globals.updateSampleRate(48000.0);
+
+    TransportInfo transport;
+    transport.isValid = true;
+    transport.hasBpm = true;
+
+    int tempoChanges = 0;
+    int pendingSince = -1;
+    int maxLatency = 0;
+    int lastChanges = 0;
+
+    RealtimeTrap::markCurrentThreadAsAudioThread();
+    RealtimeTrap::resetCounters();
+    for (int b = 0; b < blocks; ++b) {
+        if (b % blocksPerTempo == 0) {
+            transport.bpm = 90.0 + (b / blocksPerTempo) % 7 * 10.0;
+            ++tempoChanges;
+            pendingSince = b;
+        }
+        {
+            PHU_ARP_RT_SECTION();
+            const Event::Context ctx = globals.updateDAWGlobals(blockSize, transport);
+            buffers.update(ctx);
+            globals.finishRun(blockSize);
+        }
+        if (listener.changes != lastChanges) {
+            lastChanges = listener.changes;
+            if (pendingSince >= 0) {
+                maxLatency = std::max(maxLatency, b - pendingSince);
+                pendingSince = -1;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    RealtimeTrap::clearCurrentThreadAsAudioThread();
+
+    buffers.removeEventListener(&listener);
+    globals.removeEventListener(&buffers);
+
+    std::printf("%-32s %d tempo changes, %d buffer swaps, %zu built, max handoff %d blocks\n", name,
+                tempoChanges, listener.changes, buffers.getBuildCount(), maxLatency);
+    const BeatBufferSet* active = buffers.getActive();
+    const int expectedSize = active != nullptr ? static_cast<int>(std::ceil(active->samplesPerBeat * 4)) : -1;
+    if (active == nullptr || listener.lastGlobalSize != expectedSize || pendingSince >= 0) {
+        benchFail(name, "last tempo change did not reach the audio thread");
+    }
+    expectRealtimeSafe(name);
+}
+
+// Distinct types so each gets its own static slot
+struct ListenerA : CountingListener {};
+struct ListenerB : CountingListener {};
+struct ListenerC : CountingListener {};
+struct ListenerD : CountingListener {};
+
+} // namespace
+
+void runEventBenchmarks(const BenchOptions& options) {
+    benchDynamic(options, "events/dynamic-1", 1);
+    benchDynamic(options, "events/dynamic-4", 4);
+    benchRcuChurn(options);
+    benchBridge(options);
+    benchBeatBuffers(options);
+
+    ListenerA a;
+    benchStatic<GlobalsStaticDispatch<ListenerA>>(options, "events/static-1", a);
+
+    ListenerA a4;
+    ListenerB b4;
+    ListenerC c4;
+    ListenerD d4;
+    benchStatic<GlobalsStaticDispatch<ListenerA, ListenerB, ListenerC, ListenerD>>(
+        options, "events/static-4", a4, b4, c4, d4);
+}
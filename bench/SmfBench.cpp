@@ -0,0 +1,122 @@
+/**
+ * Standard MIDI File I/O throughput on a multi-megabyte file:
+ * - heap read (whole file into a buffer) + materialized parse, as a baseline
+ * - memory-mapped, zero-copy streaming read
+ * - buffered streaming write
+ * - file-to-file offline render
+ */
+
+#include "Bench.h"
+#include "MidiFileReader.h"
+#include "MidiFileWriter.h"
+#include "OfflineRenderer.h"
+#include "StandardMidiFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+// Chords (ch 1) every bar plus a dense 32nd-note rhythm (ch 16): roughly 0.3 MB per 1000 bars
+void generateCorpusFile(const std::string& path, int bars, MidiFileData& data) {
+    data = MidiFileData();
+    data.ticksPerQuarter = 480;
+    data.tempoMap.push_back({0, 500000});
+
+    uint32_t seed = 12345;
+    auto random = [&seed](int range) {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<int>((seed >> 8) % static_cast<uint32_t>(range));
+    };
+
+    const uint32_t bar = 4 * 480;
+    const uint32_t step = 480 / 8;
+    for (int b = 0; b < bars; ++b) {
+        const uint32_t t0 = static_cast<uint32_t>(b) * bar;
+        const int root = 48 + random(12);
+        for (int interval : {0, 4, 7, 11}) {
+            data.events.push_back({t0, MidiEvent::noteOn(1, root + interval, 90)});
+        }
+        for (uint32_t s = 0; s < bar / step; ++s) {
+            const int key = 24 + random(16);
+            data.events.push_back({t0 + s * step, MidiEvent::noteOn(16, key, 100)});
+            data.events.push_back({t0 + s * step + step / 2, MidiEvent::noteOff(16, key)});
+        }
+        for (int interval : {0, 4, 7, 11}) {
+            data.events.push_back({t0 + bar - 1, MidiEvent::noteOff(1, root + interval)});
+        }
+    }
+    std::stable_sort(data.events.begin(), data.events.end(),
+        [](const MidiFileEvent& a, const MidiFileEvent& b) { return a.tick < b.tick; });
+    data.lengthInTicks = static_cast<uint32_t>(bars) * bar;
+
+    std::string error;
+    StandardMidiFile::write(path, data, error);
+}
+
+size_t fileSize(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+} // namespace
+
+void runSmfBenchmarks(const BenchOptions& options) {
+    const std::string inputPath = options.workDir + "/bench-input.mid";
+    const std::string outputPath = options.workDir + "/bench-output.mid";
+
+    MidiFileData corpus;
+    generateCorpusFile(inputPath, 16000, corpus);
+    const double bytes = static_cast<double>(fileSize(inputPath));
+    const double events = static_cast<double>(corpus.events.size());
+    std::printf("SMF corpus: %.1f MB, %zu events\n", bytes / 1e6, corpus.events.size());
+
+    std::string error;
+
+    if (options.matches("smf/read-heap-parse")) {
+        const double seconds = measureBestSeconds(options.repetitions, [&] {
+            std::ifstream in(inputPath, std::ios::binary);
+            std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            MidiFileData parsed;
+            StandardMidiFile::parse(buffer.data(), buffer.size(), parsed, error);
+        });
+        printThroughput("smf/read-heap-parse", seconds, bytes, events);
+    }
+
+    if (options.matches("smf/read-mmap-stream")) {
+        size_t count = 0;
+        const double seconds = measureBestSeconds(options.repetitions, [&] {
+            MidiFileReader reader;
+            reader.open(inputPath, error);
+            MidiFileEvent evt;
+            count = 0;
+            while (reader.next(evt)) {
+                ++count;
+            }
+        });
+        printThroughput("smf/read-mmap-stream", seconds, bytes, static_cast<double>(count));
+    }
+
+    if (options.matches("smf/write-buffered")) {
+        const double seconds = measureBestSeconds(options.repetitions, [&] {
+            MidiFileWriter writer;
+            writer.open(outputPath, corpus.ticksPerQuarter, corpus.tempoMap, error);
+            for (const auto& evt : corpus.events) {
+                writer.write(evt);
+            }
+            writer.close(corpus.lengthInTicks, error);
+        });
+        printThroughput("smf/write-buffered", seconds, bytes, events);
+    }
+
+    if (options.matches("smf/render-file")) {
+        OfflineRenderer renderer{OfflineRenderSettings()};
+        OfflineRenderStats stats;
+        const double seconds = measureBestSeconds(options.repetitions, [&] {
+            renderer.renderFile(inputPath, outputPath, stats, error);
+        });
+        printThroughput("smf/render-file", seconds, bytes, static_cast<double>(stats.inputEvents + stats.outputEvents));
+    }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <juce_audio_basics/juce_audio_basics.h>
+#include "MidiEvent.h"
+#include "NoteMask.h"
 #include <vector>
 #include <algorithm>
 
@@ -31,9 +32,17 @@
  */
 class ChordNotesTracker {
 private:
-    std::vector<juce::MidiMessage> chordNotes;  // Sorted list of chord notes
+    std::vector<MidiEvent> chordNotes;  // Sorted list of chord notes
+    size_t peakChordSize = 0;           // High-water of chordNotes.size() (memory accounting)
     
 public:
+    /**
+     * Preallocate room for maxNotes chord notes (call outside the audio thread)
+     */
+    void reserve(size_t maxNotes) {
+        chordNotes.reserve(maxNotes);
+    }
+
     /**
      * Get the number of notes in the chord
      */
@@ -41,6 +50,13 @@ public:
         return chordNotes.size();
     }
     
+    /**
+     * Largest chord size seen since construction
+     */
+    size_t getPeakChordSize() const {
+        return peakChordSize;
+    }
+    
     /**
      * Check if chord is empty
      */
@@ -53,9 +69,9 @@ public:
      * Returns nullptr if index is out of bounds
      * 
      * @param chordIndex Index in chord (0-based)
-     * @return Pointer to MidiMessage or nullptr if not found
+     * @return Pointer to MidiEvent or nullptr if not found
      */
-    const juce::MidiMessage* getChordNoteByIndex(int chordIndex) const {
+    const MidiEvent* getChordNoteByIndex(int chordIndex) const {
         if (chordIndex < 0 || chordIndex >= static_cast<int>(chordNotes.size())) {
             return nullptr;
         }
@@ -72,12 +88,14 @@ public:
      * @param channel MIDI channel (1-16)
      */
     void insertChordNote(int noteNumber, int velocity, int channel = 1) {
-        auto newNote = juce::MidiMessage::noteOn(channel, noteNumber, static_cast<juce::uint8>(velocity));
-        chordNotes.push_back(newNote);
-        std::sort(chordNotes.begin(), chordNotes.end(),
-            [](const juce::MidiMessage& a, const juce::MidiMessage& b) {
-                return a.getNoteNumber() < b.getNoteNumber();
+        auto newNote = MidiEvent::noteOn(channel, noteNumber, static_cast<uint8_t>(velocity));
+        // Sorted insert: in place, no allocation while within the reserved capacity
+        auto position = std::upper_bound(chordNotes.begin(), chordNotes.end(), noteNumber,
+            [](int note, const MidiEvent& msg) {
+                return note < msg.getNoteNumber();
             });
+        chordNotes.insert(position, newNote);
+        peakChordSize = std::max(peakChordSize, chordNotes.size());
     }
     
     /**
@@ -88,7 +106,7 @@ public:
      */
     bool removeChordNote(int noteNumber) {
         auto it = std::find_if(chordNotes.begin(), chordNotes.end(),
-            [noteNumber](const juce::MidiMessage& msg) { 
+            [noteNumber](const MidiEvent& msg) { 
                 return msg.getNoteNumber() == noteNumber; 
             });
         
@@ -99,6 +117,32 @@ public:
         return false;
     }
     
+    /**
+     * Remove all chord notes whose note number is in the mask, in one pass
+     * (e.g. every note a pedal release lets go)
+     *
+     * @return Number of notes removed
+     */
+    int removeChordNotes(const NoteMask& notes) {
+        const auto oldSize = chordNotes.size();
+        chordNotes.erase(
+            std::remove_if(chordNotes.begin(), chordNotes.end(),
+                [&notes](const MidiEvent& msg) { return notes.test(msg.getNoteNumber()); }),
+            chordNotes.end());
+        return static_cast<int>(oldSize - chordNotes.size());
+    }
+
+    /**
+     * Note numbers in the chord
+     */
+    NoteMask getChordMask() const {
+        NoteMask notes;
+        for (const auto& chordNote : chordNotes) {
+            notes.set(chordNote.getNoteNumber());
+        }
+        return notes;
+    }
+    
     /**
      * Clear all chord notes
      */
@@ -109,7 +153,7 @@ public:
     /**
      * Get all chord notes
      */
-    const std::vector<juce::MidiMessage>& getChordNotes() const {
+    const std::vector<MidiEvent>& getChordNotes() const {
         return chordNotes;
     }
 };
@@ -0,0 +1,794 @@
+#include "ChordPatternCoordinator.h"
+#include "RealtimeTrap.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+/**
+ * Stable sort that never allocates: bottom-up merge sort ping-ponging between the events and a
+ * caller-owned scratch buffer (std::stable_sort allocates its merge buffer on every call).
+ * Already sorted input - the common case, hosts deliver events in time order - costs one pass.
+ */
+template<typename Less>
+void stableSortWithScratch(std::vector<MidiEvent>& events, std::vector<MidiEvent>& scratch, Less less)
+{
+    if (std::is_sorted(events.begin(), events.end(), less)) {
+        return;
+    }
+
+    const size_t n = events.size();
+    scratch.resize(n);
+    MidiEvent* source = events.data();
+    MidiEvent* target = scratch.data();
+
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t low = 0; low < n; low += 2 * width) {
+            const size_t middle = std::min(low + width, n);
+            const size_t high = std::min(low + 2 * width, n);
+            // std::merge takes from the first range on ties: stable
+            std::merge(source + low, source + middle, source + middle, source + high, target + low, less);
+        }
+        std::swap(source, target);
+    }
+
+    if (source != events.data()) {
+        std::copy(source, source + n, events.data());
+    }
+}
+
+} // namespace
+
+void ChordPatternCoordinator::prepare(size_t maxEventsPerBlock)
+{
+    // Input events plus what the rhythm generator can add per block and the grace window releases
+    const size_t maxOrderedEvents = maxEventsPerBlock + RhythmGenerator::maxEventsPerBlock + pendingRhythm.capacity();
+    tempEventBuffer.reserve(maxOrderedEvents);
+    sortScratch.reserve(maxOrderedEvents);
+    // Every ordered event yields at most one note-on, note-offs are bounded by the playing notes;
+    // scheduled and delayed events add at most the capacities of their wheels
+    const size_t maxOutputEvents = maxOrderedEvents + maxPlayingNotes + scheduler.capacity() + delayLine.capacity();
+    outputEvents.reserve(maxOutputEvents);
+    outputPeephole.reserve(maxOutputEvents);
+    chordTracker.reserve(128);
+    patternTracker.reserve(maxPlayingNotes);
+    publishMemoryUsage();
+}
+
+void ChordPatternCoordinator::publishMemoryUsage() noexcept
+{
+    const auto& chordNotes = chordTracker.getChordNotes();
+    const auto& playingNotes = patternTracker.getPlayingNotes();
+
+    chordNotesMemory.update(heapBytesOf(chordNotes), usedBytesOf(chordNotes));
+    chordNotesMemory.notePeakUsed(chordTracker.getPeakChordSize() * sizeof(MidiEvent));
+    playingNotesMemory.update(heapBytesOf(playingNotes), usedBytesOf(playingNotes));
+    playingNotesMemory.notePeakUsed(patternTracker.getPeakPlayingNotesCount() * sizeof(PatternTracker::PlayingNote));
+    eventScratchMemory.update(heapBytesOf(tempEventBuffer), usedBytesOf(tempEventBuffer));
+    sortScratchMemory.update(heapBytesOf(sortScratch), usedBytesOf(sortScratch));
+    outputEventsMemory.update(heapBytesOf(outputEvents), usedBytesOf(outputEvents));
+    schedulerMemory.update(scheduler.capacity() * EventScheduler::bytesPerEvent,
+                           scheduler.size() * EventScheduler::bytesPerEvent);
+    schedulerMemory.notePeakUsed(scheduler.getPeakSize() * EventScheduler::bytesPerEvent);
+    delayLineMemory.update(delayLine.capacity() * EventScheduler::bytesPerEvent,
+                           delayLine.size() * EventScheduler::bytesPerEvent);
+    delayLineMemory.notePeakUsed(delayLine.getPeakSize() * EventScheduler::bytesPerEvent);
+    pendingRhythmMemory.update(pendingRhythm.capacity() * EventScheduler::bytesPerEvent,
+                               pendingRhythm.size() * EventScheduler::bytesPerEvent);
+    pendingRhythmMemory.notePeakUsed(pendingRhythm.getPeakSize() * EventScheduler::bytesPerEvent);
+}
+
+void ChordPatternCoordinator::appendMemoryUsage(MemoryReport& report, bool componentsEmbedded) const noexcept
+{
+    // The scratch buffers' vector headers are part of the coordinator object (objectBytes 0)
+    report.add(chordNotesMemory.read("ChordNotesTracker", sizeof(ChordNotesTracker), componentsEmbedded));
+    report.add(playingNotesMemory.read("PatternTracker", sizeof(PatternTracker), componentsEmbedded));
+
+    MemoryUsage coordinatorUsage;
+    coordinatorUsage.component = "ChordPatternCoordinator";
+    coordinatorUsage.objectBytes = sizeof(ChordPatternCoordinator);
+    coordinatorUsage.embedded = componentsEmbedded;
+    report.add(coordinatorUsage);
+
+    report.add(eventScratchMemory.read("coordinator/event-scratch", 0, true));
+    report.add(sortScratchMemory.read("coordinator/sort-scratch", 0, true));
+    report.add(outputEventsMemory.read("coordinator/output-events", 0, true));
+    report.add(schedulerMemory.read("coordinator/scheduler", 0, true));
+    report.add(delayLineMemory.read("coordinator/delay-line", 0, true));
+    report.add(pendingRhythmMemory.read("coordinator/pending-rhythm", 0, true));
+}
+
+bool ChordPatternCoordinator::updateChordInput(const MidiEvent& msg) noexcept
+{
+    const NoteMask before = chordInputNotes();
+    const int note = msg.getNoteNumber();
+    if (msg.isNoteOn()) {
+        if (chordLatch && !chordKeysDown.any()) {
+            // First key of a new chord: the latched one ends
+            latchedChordNotes.clear();
+        }
+        chordKeysDown.set(note);
+        chordVelocity[static_cast<size_t>(note)] = static_cast<uint8_t>(msg.getVelocity());
+    } else if (msg.isNoteOff()) {
+        chordKeysDown.reset(note);
+        if (sustainPedalDown) {
+            sustainedChordNotes.set(note);
+        }
+        if (chordLatch) {
+            latchedChordNotes.set(note);
+        }
+    } else if (msg.isController()) {
+        const bool pedalDown = msg.getControllerValue() >= 64;
+        if (msg.getControllerNumber() == 64) {
+            sustainPedalDown = pedalDown;
+            if (!pedalDown) {
+                sustainedChordNotes.clear();
+            }
+        } else if (msg.getControllerNumber() == 66) {
+            // Sostenuto keeps the notes down when it is pressed, not those played afterwards
+            if (pedalDown && !sostenutoPedalDown) {
+                sostenutoChordNotes = chordKeysDown;
+            } else if (!pedalDown) {
+                sostenutoChordNotes.clear();
+            }
+            sostenutoPedalDown = pedalDown;
+        }
+    }
+    return chordInputNotes() != before;
+}
+
+void ChordPatternCoordinator::applyChordInput() noexcept
+{
+    // Notes no longer held, sustained or latched leave the chord in one pass, new ones join,
+    // the others stay as they are
+    const NoteMask inChord = chordTracker.getChordMask();
+    const NoteMask input = chordInputNotes();
+    const NoteMask leaving = inChord & ~input;
+    if (leaving.any()) {
+        chordTracker.removeChordNotes(leaving);
+    }
+    (input & ~inChord).forEach([&](int note) {
+        chordTracker.insertChordNote(note, chordVelocity[static_cast<size_t>(note)], chordInputChannel);
+    });
+}
+
+void ChordPatternCoordinator::clearChordInput() noexcept
+{
+    // The pedals keep their state (the next controller value updates it)
+    chordKeysDown.clear();
+    sustainedChordNotes.clear();
+    sostenutoChordNotes.clear();
+    latchedChordNotes.clear();
+    chordCommitTime = -1;
+}
+
+void ChordPatternCoordinator::commitHeldChord() noexcept
+{
+    chordCommitTime = -1;
+    ++chordCommitCount;
+    applyChordInput();
+}
+
+void ChordPatternCoordinator::processBlock(const MidiEvent* events, size_t numEvents, int numSamples)
+{
+    PHU_ARP_RT_SECTION();
+    stopFlushPending = false;
+
+    // Step 1: Copy all events to temporary buffer for ordered processing
+    // We need to do this because the DAW might provide events sorted by channel,
+    // but we need to process them in a specific order
+    // Room for what the generator and the grace window add too (as in prepare): a block larger than
+    // prepared grows the buffers once here, never in one of the pushes below
+    tempEventBuffer.clear();
+    const size_t maxOrderedEvents = numEvents + RhythmGenerator::maxEventsPerBlock + pendingRhythm.capacity();
+    if (tempEventBuffer.capacity() < maxOrderedEvents) {
+        tempEventBuffer.reserve(maxOrderedEvents);
+        sortScratch.reserve(maxOrderedEvents);
+    }
+    tempEventBuffer.insert(tempEventBuffer.end(), events, events + numEvents);
+
+    // Built-in rhythm: its rhythm-key events join the input and go through the same ordering
+    if (beatGrid != nullptr && rhythmGenerator.isActive()) {
+        rhythmGenerator.generate(*beatGrid, rhythmRootNote, rhythmInputChannel,
+            [this](const MidiEvent& evt) { tempEventBuffer.push_back(evt); });
+    }
+
+    // Late-chord grace window: rhythm notes and their poly aftertouch wait activeGrace samples,
+    // those due in this block join the other events at their new position (aftertouch after the
+    // note-on it may target). Note-ons and aftertouch are dropped when only the room reserved for
+    // note-offs is left (a note-off without room is processed right away).
+    const long long blockStart = scheduler.getNow();
+    if (pendingRhythm.size() == 0) {
+        activeGrace = std::min(chordGraceSamples, latencySamples);
+    }
+    if (activeGrace > 0) {
+        size_t kept = 0;
+        for (const auto& evt : tempEventBuffer) {
+            if (evt.getChannel() == rhythmInputChannel && (evt.isNoteOn() || evt.isNoteOff() || evt.isAftertouch())) {
+                const bool hasRoom = evt.isNoteOff() || pendingRhythm.capacity() - pendingRhythm.size() > pendingNoteOffReserve;
+                if (hasRoom && pendingRhythm.schedule(evt, blockStart + evt.samplePosition + activeGrace)) {
+                    continue;
+                }
+                if (evt.isNoteOn()) {
+                    ++droppedTriggerCount;
+                    continue;
+                }
+                if (evt.isAftertouch()) {
+                    continue;
+                }
+            }
+            tempEventBuffer[kept++] = evt;
+        }
+        tempEventBuffer.resize(kept);
+    }
+    pendingRhythm.advance(blockStart + numSamples, [&](const MidiEvent& evt, long long time, uint32_t) {
+        MidiEvent due = evt;
+        due.samplePosition = static_cast<int>(time - blockStart);
+        tempEventBuffer.push_back(due);
+    });
+
+    // Prepare output events buffer
+    outputEvents.clear();
+    // (every scheduled or delayed event, including those scheduled and due within this block, yields at most one)
+    const size_t maxOutputEvents = tempEventBuffer.size() + patternTracker.getPlayingNotesCount()
+                                   + scheduler.capacity() + delayLine.capacity();
+    if (outputEvents.capacity() < maxOutputEvents) {
+        outputEvents.reserve(maxOutputEvents);
+        outputPeephole.reserve(maxOutputEvents);
+    }
+
+    // Step 2: Make event processing time-causal.
+    // This directly addresses edge cases 1, 2, 3 by ensuring we never reorder events
+    // across time within the audio block.
+    // Sort by sample position, and for events at the same sample position apply a stable priority:
+    // 1) Rhythm note-offs
+    // 2) Chord updates, and controllers, pitch bend and channel pressure of both inputs (so a
+    //    routed control applies before the notes it shapes)
+    // 3) Rhythm note-ons
+    // (then everything else, e.g. rhythm aftertouch, which needs the notes its key plays)
+    auto isNoteOffLike = [](const MidiEvent& msg) {
+        // Treat NoteOn velocity=0 as NoteOff (common MIDI encoding).
+        return msg.isNoteOff() || (msg.isNoteOn() && msg.getVelocity() == 0);
+    };
+    auto phasePriority = [&](const MidiEvent& msg) -> int {
+        const int ch = msg.getChannel();
+        const bool isChannelControl = msg.isController() || msg.isPitchWheel() || msg.isChannelPressure();
+        if (ch == rhythmInputChannel) {
+            if (isNoteOffLike(msg)) {
+                return 0;
+            }
+            if (msg.isNoteOn()) {
+                return 2;
+            }
+            if (isChannelControl) {
+                return 1;
+            }
+        }
+        if (ch == chordInputChannel) {
+            if (msg.isNoteOn() || isNoteOffLike(msg) || isChannelControl) {
+                return 1;
+            }
+        }
+        return 3;
+    };
+
+    // Stable lexicographic ordering: (samplePosition, phasePriority).
+    // Prevents edge cases 1, 2, 3 (and removes the need for edge-case-10 timestamp hacks).
+    stableSortWithScratch(tempEventBuffer, sortScratch,
+        [&](const MidiEvent& a, const MidiEvent& b) {
+            if (a.samplePosition != b.samplePosition) {
+                return a.samplePosition < b.samplePosition;
+            }
+            return phasePriority(a) < phasePriority(b);
+        });
+
+    // Control routing: the output control each input message sets (-1 = not routed) and, with
+    // thinning, the last message of each control in this block
+    auto routedControlOf = [&](const MidiEvent& msg) {
+        if (msg.getChannel() == rhythmInputChannel) {
+            return controlRouting.controlOf(msg, true);
+        }
+        return msg.getChannel() == chordInputChannel ? controlRouting.controlOf(msg, false) : -1;
+    };
+    const bool routesControls = controlRouting.isActive();
+    if (routesControls && controlRouting.thin) {
+        lastControl.fill(-1);
+        for (size_t i = 0; i < tempEventBuffer.size(); ++i) {
+            const int control = routedControlOf(tempEventBuffer[i]);
+            if (control >= 0) {
+                lastControl[static_cast<size_t>(control)] = static_cast<int>(i);
+            }
+        }
+    }
+
+    const double samplesPerQuarter = sampleRate * 60.0 / bpm;
+
+    // Output an event generated at its samplePosition: right away, or through the delay line at
+    // outputTime (latency, strums). A full delay line lets the event out undelayed.
+    auto emitAt = [&](const MidiEvent& evt, long long outputTime, uint32_t tag) {
+        if (outputTime != blockStart + evt.samplePosition && delayLine.schedule(evt, outputTime, tag)) {
+            return;
+        }
+        outputEvents.push_back(evt);
+    };
+    auto emit = [&](const MidiEvent& evt) {
+        if (latencySamples == 0) {
+            outputEvents.push_back(evt);
+            return;
+        }
+        emitAt(evt, blockStart + evt.samplePosition + latencySamples, 0);
+    };
+
+    // Routing change (see releaseAllNotes): nothing held under the old routing survives the block start
+    if (releaseAllPending) {
+        releaseAllPending = false;
+        for (auto& generation : gateGeneration) {
+            ++generation;
+        }
+        gatedKeys.fill(false);
+        strumEnd.fill(0);
+        triggerShift.fill(0);
+        for (const auto& playing : patternTracker.getPlayingNotes()) {
+            emit(MidiEvent::noteOff(playing.getChannel(), playing.getNoteNumber(),
+                                    static_cast<uint8_t>(playing.getVelocity()), 0));
+        }
+        patternTracker.stopAllPlayingNotes();
+        pendingRhythm.clear();
+        if (clearChordPending) {
+            clearChordPending = false;
+            chordTracker.clearChord();
+            clearChordInput();
+        }
+    }
+
+    // Output delay of a rhythm key's events: latency plus the quantize shift of its trigger
+    auto keyDelay = [&](int rhythmNoteNumber) {
+        return latencySamples + triggerShift[static_cast<size_t>(rhythmNoteNumber)];
+    };
+
+    // outputDelay: samples from the engine position to the output (keyDelay; a retrigger stops
+    // the previous notes no later than its own first note-on)
+    auto stopRhythmOwnedNotes = [&](int samplePosition, int rhythmNoteNumber, long long outputDelay) {
+        // Ownership-based stopping: the note-off is derived from what was actually turned on.
+        // Prevents edge cases 4, 5, 6 (and makes retriggers for edge case 8 deterministic).
+        patternTracker.stopPlayingNotesForRhythmOwner(rhythmNoteNumber,
+            [&](const PatternTracker::PlayingNote& stopped) {
+                // On the channel the note was started on (the output channel may have changed since)
+                emitAt(MidiEvent::noteOff(stopped.getChannel(), stopped.getNoteNumber(),
+                                          static_cast<uint8_t>(stopped.getVelocity()), samplePosition),
+                       blockStart + samplePosition + outputDelay, 0);
+            });
+    };
+
+    // Polyphony cap: before a note-on leaving at onTime, steal playing notes until it fits (as long
+    // as the room reserved for the output lasts). The note-off leaves at onTime, but not before the
+    // stolen note's own note-on (its key's output delay, one sample after the last note of a strum).
+    auto makeRoomForVoice = [&](int samplePosition, long long onTime) {
+        while (maxVoices > 0 && patternTracker.getPlayingNotesCount() >= static_cast<size_t>(maxVoices)
+               && outputEvents.size() < outputEvents.capacity()) {
+            const bool stolen = patternTracker.stealVoice([&](const PatternTracker::PlayingNote& playing) {
+                long long offTime = onTime;
+                if (playing.ownerRhythmNote >= 0) {
+                    const long long strumDone = strumEnd[static_cast<size_t>(playing.ownerRhythmNote)] + 1;
+                    offTime = std::max({ offTime, blockStart + samplePosition + keyDelay(playing.ownerRhythmNote),
+                                         strumDone > 1 ? strumDone : 0LL });
+                }
+                emitAt(MidiEvent::noteOff(playing.getChannel(), playing.getNoteNumber(),
+                                          static_cast<uint8_t>(playing.getVelocity()), samplePosition),
+                       offTime, 0);
+            });
+            if (!stolen) {
+                break;
+            }
+            ++stolenVoiceCount;
+        }
+    };
+
+    auto makeGateTag = [&](int rhythmNoteNumber) {
+        return gateTag | (static_cast<uint32_t>(rhythmNoteNumber) << 16)
+               | gateGeneration[static_cast<size_t>(rhythmNoteNumber)];
+    };
+
+    // Fixed/Ratchet gate: schedule the trigger's note-offs and repeats (the first note-on is
+    // emitted by the caller). False if the scheduler cannot take them all.
+    auto scheduleGate = [&](int samplePosition, int rhythmNoteNumber, int actualNote, uint8_t velocity) {
+        long long onsets[NoteGate::maxRatchets];
+        long long lengths[NoteGate::maxRatchets];
+        const int numNotes = noteGate.plan(samplesPerQuarter, onsets, lengths);
+        if (scheduler.capacity() - scheduler.size() < static_cast<size_t>(2 * numNotes - 1)) {
+            return false;
+        }
+        const uint32_t tag = makeGateTag(rhythmNoteNumber);
+        const long long trigger = blockStart + samplePosition;
+        for (int i = 0; i < numNotes; ++i) {
+            if (i > 0) {
+                scheduler.schedule(MidiEvent::noteOn(outputChannel, actualNote, velocity), trigger + onsets[i], tag);
+            }
+            scheduler.schedule(MidiEvent::noteOff(outputChannel, actualNote), trigger + onsets[i] + lengths[i], tag);
+        }
+        return true;
+    };
+
+    // Strum key: all chord notes, spread through the delay line (anticipation up to the latency).
+    // A fixed gate ends them together with one scheduled note-off of the key, at the earliest one
+    // sample after the last note-on (engine time strumEnd - keyDelay + 1).
+    auto startStrum = [&](int samplePosition, int rhythmNoteNumber, uint8_t rhythmVelocity, int numNotes) {
+        bool down = strum.direction == StrumDirection::Down;
+        if (strum.direction == StrumDirection::Alternate) {
+            down = strumDownNext;
+            strumDownNext = !strumDownNext;
+        }
+        const uint32_t tag = makeGateTag(rhythmNoteNumber);
+        const long long trigger = blockStart + samplePosition + keyDelay(rhythmNoteNumber);
+        long long lastOnset = trigger;
+        for (int i = 0; i < numNotes; ++i) {
+            const int chordIndex = down ? numNotes - 1 - i : i;
+            const int note = chordTracker.getChordNoteByIndex(chordIndex)->getNoteNumber();
+            lastOnset = trigger + strum.noteOffset(i, numNotes, samplesPerQuarter, latencySamples - activeGrace);
+            makeRoomForVoice(samplePosition, lastOnset);
+            patternTracker.startPlayingRhythmOwnedNote(rhythmNoteNumber, note, rhythmVelocity, outputChannel, chordIndex, 0,
+                                                       lastOnset);
+            emitAt(MidiEvent::noteOn(outputChannel, note, rhythmVelocity, samplePosition), lastOnset, tag);
+        }
+        strumEnd[static_cast<size_t>(rhythmNoteNumber)] = lastOnset;
+
+        if (noteGate.mode != GateMode::Follow) {
+            long long onsets[NoteGate::maxRatchets];
+            long long lengths[NoteGate::maxRatchets];
+            const int last = noteGate.plan(samplesPerQuarter, onsets, lengths) - 1;
+            const long long gateEnd = blockStart + samplePosition + onsets[last] + lengths[last];
+            const long long strumDone = lastOnset - keyDelay(rhythmNoteNumber) + 1;
+            gatedKeys[static_cast<size_t>(rhythmNoteNumber)] = scheduler.schedule(
+                MidiEvent::noteOff(outputChannel, 0), gateEnd > strumDone ? gateEnd : strumDone, tag);
+        }
+    };
+
+    auto startRhythmOwnedNote = [&](int samplePosition, int rhythmNoteNumber, uint8_t triggerVelocity) {
+        // A retrigger voids what the key's previous gate, strum or held note-on still had scheduled
+        const size_t key = static_cast<size_t>(rhythmNoteNumber);
+        ++gateGeneration[key];
+        gatedKeys[key] = false;
+        strumEnd[key] = 0;
+
+        const bool isStrum = strum.isEnabled() && rhythmNoteNumber - rhythmRootNote == strum.key;
+        const int numStrumNotes = isStrum ? static_cast<int>(std::min(chordTracker.getChordSize(),
+                                                                      static_cast<size_t>(NoteStrum::maxNotes))) : 0;
+        const long long strumLead = numStrumNotes > 0
+            ? -strum.noteOffset(0, numStrumNotes, samplesPerQuarter, latencySamples - activeGrace) : 0;
+
+        // A trigger held by the grace window goes out at its original time. Groove quantize then
+        // shifts the whole trigger toward its grid line: early triggers are held, late ones pulled
+        // in by at most the latency the grace window and a strum lead left over.
+        long long shift = -activeGrace;
+        uint8_t rhythmVelocity = triggerVelocity;
+        if (quantize.enabled && beatGrid != nullptr && beatGrid->isValid()) {
+            const double ppq = beatGrid->ppqAtSample(samplePosition - activeGrace);
+            double velocityScale = 1.0;
+            const double target = quantize.quantize(ppq, velocityScale);
+            shift = std::max(std::llround((target - ppq) / beatGrid->getPpqPerSample()) - activeGrace, strumLead - latencySamples);
+            rhythmVelocity = static_cast<uint8_t>(std::min(127L, std::max(1L, std::lround(triggerVelocity * velocityScale))));
+        }
+
+        // Ensure retriggers are clean for the same rhythm key.
+        // Addresses edge case 8.
+        stopRhythmOwnedNotes(samplePosition, rhythmNoteNumber,
+                             std::min(keyDelay(rhythmNoteNumber), latencySamples + shift - strumLead));
+        triggerShift[key] = shift;
+
+        if (isStrum) {
+            if (numStrumNotes > 0) {
+                startStrum(samplePosition, rhythmNoteNumber, rhythmVelocity, numStrumNotes);
+            }
+            return;
+        }
+
+        // Correct index mapping even for rhythm notes below the root.
+        // Addresses edge case 9.
+        int chordIndex = 0;
+        int octaveOffset = 0;
+        if (rhythmKeyMap == nullptr || !rhythmKeyMap->lookup(rhythmNoteNumber - rhythmRootNote, chordIndex, octaveOffset)) {
+            chordIndex = PatternTracker::computeChordIndex(rhythmNoteNumber, rhythmRootNote);
+            octaveOffset = PatternTracker::computeOctaveOffset(rhythmNoteNumber, rhythmRootNote);
+        }
+
+        const MidiEvent* chordNote = chordTracker.getChordNoteByIndex(chordIndex);
+        if (chordNote == nullptr) {
+            return;
+        }
+
+        const int actualNote = chordNote->getNoteNumber() + octaveOffset;
+        if (actualNote < 0 || actualNote > 127) {
+            return;
+        }
+
+        // Store the concrete output note for this rhythm trigger so future note-offs do not depend
+        // on the *current* chord content/indexing.
+        // Prevents edge cases 4, 5, 6.
+        const long long onTime = blockStart + samplePosition + keyDelay(rhythmNoteNumber);
+        makeRoomForVoice(samplePosition, onTime);
+        patternTracker.startPlayingRhythmOwnedNote(
+            rhythmNoteNumber,
+            actualNote,
+            rhythmVelocity,
+            outputChannel,
+            chordIndex,
+            octaveOffset,
+            onTime
+        );
+
+        // Emit note-on at the actual sample position (no -1 shifting), plus latency and quantize shift.
+        // Addresses edge case 10.
+        emitAt(MidiEvent::noteOn(outputChannel, actualNote, rhythmVelocity, samplePosition), onTime,
+               makeGateTag(rhythmNoteNumber));
+
+        if (noteGate.mode != GateMode::Follow) {
+            gatedKeys[static_cast<size_t>(rhythmNoteNumber)] =
+                scheduleGate(samplePosition, rhythmNoteNumber, actualNote, rhythmVelocity);
+        }
+    };
+
+    // Delayed events leaving: strum note-ons of a voided strum are dropped
+    auto handleDelayed = [&](const MidiEvent& evt, long long time, uint32_t tag) {
+        if ((tag & gateTag) != 0 && (tag & 0xffff) != gateGeneration[static_cast<size_t>((tag >> 16) & 0x7f)]) {
+            return;
+        }
+        MidiEvent due = evt;
+        due.samplePosition = static_cast<int>(time - blockStart);
+        outputEvents.push_back(due);
+    };
+
+    // Scheduled events coming due: plain ones are output as they are, gate events act on the
+    // playing notes of their rhythm key unless a retrigger voided them
+    auto handleScheduled = [&](const MidiEvent& evt, long long time, uint32_t tag) {
+        delayLine.advance(time, handleDelayed);
+        const int samplePosition = static_cast<int>(time - blockStart);
+        if ((tag & gateTag) == 0) {
+            MidiEvent due = evt;
+            due.samplePosition = samplePosition;
+            emit(due);
+            return;
+        }
+        const int rhythmNoteNumber = static_cast<int>((tag >> 16) & 0x7f);
+        if ((tag & 0xffff) != gateGeneration[static_cast<size_t>(rhythmNoteNumber)]) {
+            return;
+        }
+        if (evt.isNoteOn()) {
+            makeRoomForVoice(samplePosition, time + keyDelay(rhythmNoteNumber));
+            patternTracker.startPlayingRhythmOwnedNote(rhythmNoteNumber, evt.getNoteNumber(),
+                                                       static_cast<uint8_t>(evt.getVelocity()), evt.getChannel(),
+                                                       -1, 0, time + keyDelay(rhythmNoteNumber));
+            emitAt(MidiEvent::noteOn(evt.getChannel(), evt.getNoteNumber(),
+                                     static_cast<uint8_t>(evt.getVelocity()), samplePosition),
+                   time + keyDelay(rhythmNoteNumber), tag);
+        } else {
+            stopRhythmOwnedNotes(samplePosition, rhythmNoteNumber, keyDelay(rhythmNoteNumber));
+        }
+    };
+
+    // Scheduled events before samplePosition (exclusive). The delay line is drained only up to the
+    // current position (and up to each scheduled event before handling it): whatever is generated
+    // from there on leaves at that position or later.
+    auto runScheduledUntil = [&](int samplePosition, int currentPosition) {
+        if (scheduler.size() != 0) {
+            scheduler.advance(blockStart + samplePosition, handleScheduled);
+        }
+        if (delayLine.size() != 0) {
+            delayLine.advance(blockStart + currentPosition, handleDelayed);
+        }
+    };
+
+    // Chord follow: held notes of the output channel move to the chord as it is at samplePosition.
+    // Their note-offs and note-ons leave with the key's output delay (like the key's own note-offs,
+    // so never before its note-on).
+    auto followChord = [&](int samplePosition) {
+        followedPitchCount += patternTracker.followChord(
+            [&](const PatternTracker::PlayingNote& playing) {
+                const size_t key = static_cast<size_t>(playing.ownerRhythmNote);
+                return playing.ownerRhythmNote >= 0 && playing.getChannel() == outputChannel
+                       && !gatedKeys[key] && strumEnd[key] == 0;
+            },
+            [&](const PatternTracker::PlayingNote& playing) {
+                emitAt(MidiEvent::noteOff(playing.getChannel(), playing.getNoteNumber(),
+                                          static_cast<uint8_t>(playing.getVelocity()), samplePosition),
+                       blockStart + samplePosition + keyDelay(playing.ownerRhythmNote), 0);
+            },
+            [&](const PatternTracker::PlayingNote& playing) {
+                emitAt(MidiEvent::noteOn(playing.getChannel(), playing.getNoteNumber(),
+                                         static_cast<uint8_t>(playing.getVelocity()), samplePosition),
+                       blockStart + samplePosition + keyDelay(playing.ownerRhythmNote),
+                       makeGateTag(playing.ownerRhythmNote));
+            });
+    };
+
+    // A chord change usually is several events at one position: chord follow runs once the
+    // position moves on (-1 = no change pending)
+    int followPosition = -1;
+    auto followPendingBefore = [&](int samplePosition) {
+        if (followPosition >= 0 && followPosition < samplePosition) {
+            followChord(followPosition);
+            followPosition = -1;
+        }
+    };
+
+    // A chord change that has settled by samplePosition becomes the chord at its settle time
+    auto commitSettledChord = [&](int samplePosition) {
+        if (chordCommitTime < 0 || (chordSettleSamples > 0 && chordCommitTime > blockStart + samplePosition)) {
+            return;
+        }
+        const int commitPosition = chordSettleSamples > 0
+            ? static_cast<int>(std::max(chordCommitTime - blockStart, 0LL)) : samplePosition;
+        followPendingBefore(commitPosition);
+        runScheduledUntil(std::min(commitPosition + 1, numSamples), commitPosition);
+        commitHeldChord();
+        if (chordFollow) {
+            followPosition = commitPosition;
+        }
+    };
+
+    // The chord input notes changed at samplePosition
+    auto chordInputChanged = [&](int samplePosition) {
+        if (chordSettleSamples > 0) {
+            // Settle window: (re)start it, the chord follows once the input is quiet
+            chordCommitTime = blockStart + samplePosition + chordSettleSamples;
+            return;
+        }
+        applyChordInput();
+        if (chordFollow) {
+            followPosition = samplePosition;
+        }
+    };
+
+    // A routed control message: to the output channel, or (aftertouch of a rhythm key) to each note
+    // the key plays, as long as the room reserved for the output lasts. The aftertouch leaves with
+    // the key's output delay, but never before the note's own note-on (strum notes still to come).
+    auto routeControl = [&](const MidiEvent& msg) {
+        if (!msg.isAftertouch()) {
+            emit(msg.withChannel(outputChannel));
+            ++routedControlCount;
+            return;
+        }
+        const int key = msg.getNoteNumber();
+        for (const auto& playing : patternTracker.getPlayingNotes()) {
+            if (playing.ownerRhythmNote == key && outputEvents.size() < outputEvents.capacity()) {
+                emitAt(MidiEvent::aftertouch(playing.getChannel(), playing.getNoteNumber(), msg.getAfterTouchValue(),
+                                             msg.samplePosition),
+                       std::max(blockStart + msg.samplePosition + keyDelay(key), playing.onTime), 0);
+                ++routedControlCount;
+            }
+        }
+    };
+
+    // Latch turned off: the latched notes leave the chord
+    if (!chordLatch && latchedChordNotes.any()) {
+        latchedChordNotes.clear();
+        chordInputChanged(0);
+    }
+
+    // Step 3: Process the (now ordered) event stream, interleaved with the scheduled events
+    // (those at the same position first, e.g. a gate's note-off before a retrigger).
+    for (const auto& msg : tempEventBuffer) {
+        // A chord change that has settled by now becomes the chord (before this event)
+        commitSettledChord(msg.samplePosition);
+        followPendingBefore(msg.samplePosition);
+        runScheduledUntil(std::min(msg.samplePosition + 1, numSamples), msg.samplePosition);
+
+        const int control = routesControls ? routedControlOf(msg) : -1;
+        if (control >= 0) {
+            const int index = static_cast<int>(&msg - tempEventBuffer.data());
+            if (controlRouting.thin && ControlRouting::isThinnable(control) && lastControl[static_cast<size_t>(control)] != index) {
+                ++thinnedControlCount;
+            } else {
+                routeControl(msg);
+            }
+            continue;
+        }
+
+        if (msg.getChannel() == rhythmInputChannel) {
+            if (isNoteOffLike(msg)) {
+                // Fixed/Ratchet gates end on their own; a strum still playing out ends after its
+                // last note-on (as a gate event, so a retrigger voids it)
+                const size_t key = static_cast<size_t>(msg.getNoteNumber());
+                const long long strumDone = strumEnd[key] - keyDelay(msg.getNoteNumber()) + 1;
+                if (gatedKeys[key]) {
+                    continue;
+                }
+                if (strumDone > blockStart + msg.samplePosition
+                    && scheduler.schedule(MidiEvent::noteOff(outputChannel, 0), strumDone, makeGateTag(msg.getNoteNumber()))) {
+                    gatedKeys[key] = true;
+                } else {
+                    stopRhythmOwnedNotes(msg.samplePosition, msg.getNoteNumber(), keyDelay(msg.getNoteNumber()));
+                }
+            } else if (msg.isNoteOn()) {
+                startRhythmOwnedNote(msg.samplePosition,
+                                     msg.getNoteNumber(),
+                                     static_cast<uint8_t>(msg.getVelocity()));
+            }
+            continue;
+        }
+
+        if (msg.getChannel() == chordInputChannel) {
+            // Keys, pedals and latch update the chord input notes; the chord follows if they changed
+            if (updateChordInput(msg)) {
+                chordInputChanged(msg.samplePosition);
+            }
+            continue;
+        }
+    }
+
+    // Chord changes settling within the rest of the block (so chord follow is not held up until
+    // the next event) and a chord follow still pending
+    if (numSamples > 0) {
+        commitSettledChord(numSamples - 1);
+    }
+    followPendingBefore(numSamples);
+
+    // Step 4: The rest of the block's scheduled events (including what step 3 scheduled into it).
+    // Both clocks move to the block end even when nothing is pending.
+    scheduler.advance(blockStart + numSamples, handleScheduled);
+    delayLine.advance(blockStart + numSamples, handleDelayed);
+
+    // Step 5: Output cleanup (redundant note events, same-sample order; see setOutputCleanup)
+    outputPeephole.process(outputEvents);
+
+    // outputEvents now holds the generated events in time order.
+    // Writing them back (and optionally merging pass-through MIDI) is up to the host adapter.
+    publishMemoryUsage();
+}
+
+void ChordPatternCoordinator::onIsPlayingChanged(const IsPlayingEvent& event)
+{
+    PHU_ARP_RT_SECTION();
+
+    // When DAW stops playing, clear all notes and chord
+    if (event.oldValue == true && event.newValue == false) {
+        ENGINE_LOG(logger, "DAW stopped - cleaning up notes");
+
+        // Queue note-off events for all playing notes before clearing (at sample position 0).
+        // The host picks them up via takeStopFlush()/getOutputEvents().
+        outputEvents.clear();
+        std::array<NoteMask, 16> sent {};  // Pitches per channel that got a note-off above
+        for (const auto& playing : patternTracker.getPlayingNotes()) {
+            outputEvents.push_back(MidiEvent::noteOff(
+                playing.getChannel(),
+                playing.getNoteNumber(),
+                static_cast<uint8_t>(playing.getVelocity()),
+                0
+            ));
+            sent[static_cast<size_t>(playing.getChannel() - 1)].set(playing.getNoteNumber());
+        }
+        // Scheduled and delayed note-offs still have to reach the instrument (unless already sent
+        // above); everything else scheduled or delayed is dropped
+        // (gate and strum events are covered by the playing notes)
+        auto flushNoteOff = [&](const MidiEvent& evt, long long, uint32_t tag) {
+            if ((tag & gateTag) != 0 || !evt.isNoteOff()) {
+                return;
+            }
+            if (!sent[static_cast<size_t>(evt.getChannel() - 1)].test(evt.getNoteNumber())) {
+                outputEvents.push_back(MidiEvent::noteOff(evt.getChannel(), evt.getNoteNumber(),
+                                                          static_cast<uint8_t>(evt.getVelocity()), 0));
+            }
+        };
+        scheduler.flush(flushNoteOff);
+        delayLine.flush(flushNoteOff);
+        pendingRhythm.clear();
+        outputPeephole.reset();
+        stopFlushPending = true;
+
+        char text[64];
+        std::snprintf(text, sizeof(text), "Sending %d note-off events", static_cast<int>(outputEvents.size()));
+        ENGINE_LOG(logger, text);
+
+        // Now stop all currently playing notes (clears internal state)
+        patternTracker.stopAllPlayingNotes();
+        gatedKeys.fill(false);
+        strumEnd.fill(0);
+        triggerShift.fill(0);
+        rhythmGenerator.reset();
+
+        // Clear all stored chord notes (and a chord change still settling)
+        chordTracker.clearChord();
+        clearChordInput();
+        publishMemoryUsage();
+        ENGINE_LOG(logger, "Cleared all playing notes and chord");
+    }
+}
@@ -0,0 +1,538 @@
+#pragma once
+
+#include "ChordNotesTracker.h"
+#include "ControlRouting.h"
+#include "PatternTracker.h"
+#include "MidiEvent.h"
+#include "EngineLogger.h"
+#include "EventScheduler.h"
+#include "MemoryUsage.h"
+#include "NoteGate.h"
+#include "NoteMask.h"
+#include "GrooveQuantize.h"
+#include "NoteStrum.h"
+#include "OutputPeephole.h"
+#include "RhythmGenerator.h"
+#include "RhythmKeyMap.h"
+#include "../lib/SyncGlobals.h"
+#include "../lib/SyncGlobalsListener.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * ChordPatternCoordinator
+ * 
+ * Coordinates the processing of chord notes (channel 1) and rhythm pattern notes (channel 16)
+ * to produce output notes (channel 2). This implements the algorithm from the Lua version.
+ * 
+ * Processing order is critical:
+ * 1. Process rhythm pattern note-offs first (to prevent hanging notes during chord changes)
+ * 2. Process chord note updates (channel 1 note-on/off)
+ * 3. Process rhythm pattern note-ons (to trigger chord notes)
+ * 
+ * Key concepts:
+ * - Channel 1: Chord note input (defines which notes are in the chord)
+ * - Channel 16: Rhythm pattern input (triggers chord notes with optional octave offset)
+ * - Channel 2: Output notes (actual MIDI output)
+ * - RHYTHM_ROOT_NOTE: Base note (e.g., C1 = 24) for computing chord index from pattern
+ * 
+ * Usage Pattern:
+ *   ChordNotesTracker chordTracker;
+ *   PatternTracker patternTracker(chordTracker);
+ *   ChordPatternCoordinator coordinator(chordTracker, patternTracker);
+ *   
+ *   // In processBlock:
+ *   coordinator.processBlock(events.data(), events.size(), numSamples);
+ *   for (const auto& evt : coordinator.getOutputEvents()) { ... }
+ *
+ * Output events can also be scheduled for later blocks (scheduleOutputEvent); the coordinator
+ * keeps them in an EventScheduler timing wheel on its own sample clock, which processBlock
+ * advances by the block length.
+ *
+ * With a latency (setLatencySamples, reported to the host as plugin latency) every output event
+ * leaves through a second timing wheel (the delay line) that many samples later than generated,
+ * which gives strums (setStrum) room to begin before their trigger and lets groove quantize
+ * (setGrooveQuantize) pull late triggers onto the grid.
+ *
+ * Rhythm can also come from the built-in RhythmGenerator (getRhythmGenerator(), needs the
+ * SyncGlobals beat grid via setBeatGrid()); its events are merged with the rhythm input before
+ * ordering, so the rhythm input channel is optional.
+ *
+ * The coordinator works on raw MIDI events only (see MidiEvent) and has no framework
+ * dependency. Hosts (the plugin, command-line tools) convert their own buffers to/from
+ * MidiEvent around processBlock.
+ */
+class ChordPatternCoordinator : public GlobalsEventListener {
+private:
+    ChordNotesTracker& chordTracker;
+    PatternTracker& patternTracker;
+    int rhythmRootNote;                    // Root note for rhythm pattern (default: C1 = 24)
+    EngineLogger* logger = nullptr;        // Instance-scoped logger (optional)
+
+    // MIDI routing channels (1..16)
+    int chordInputChannel = 1;
+    int rhythmInputChannel = 16;
+    int outputChannel = 2;
+
+    // Scratch buffers reused per audio block to avoid heap churn on the audio thread.
+    // Sized by prepare(); processBlock only grows them if a block exceeds the prepared size
+    // (which a PHU_ARP_RT_TRAP build reports as an allocation).
+    std::vector<MidiEvent> tempEventBuffer;
+    std::vector<MidiEvent> sortScratch;    // Merge buffer of the stable event sort
+    std::vector<MidiEvent> outputEvents;
+
+    // Built-in rhythm source, stepped by the beat grid of the owning SyncGlobals
+    RhythmGenerator rhythmGenerator;
+    const BeatGrid* beatGrid = nullptr;
+
+    // Output events due in later blocks (sample clock = start of the next block)
+    EventScheduler scheduler;
+
+    // Gate of generated notes; Fixed/Ratchet schedule note-offs and repeats per trigger.
+    // Scheduled gate events are tagged with their rhythm key and its generation at the trigger;
+    // a retrigger (or a routing change) bumps the generation and so voids them.
+    NoteGate noteGate;
+    std::array<uint16_t, 128> gateGeneration {};
+    std::array<bool, 128> gatedKeys {};    // Current trigger of the key ignores its note-off
+    double bpm = 120.0;                    // Tempo for gate lengths (GLOBALS events)
+    double sampleRate = 48000.0;
+    static constexpr uint32_t gateTag = 0x80000000u;
+
+    // Strum key (see NoteStrum). Its note-ons go through the delay line tagged like gate events,
+    // so a retrigger voids those not yet played; note-offs wait for the strum's last note-on.
+    NoteStrum strum;
+    std::array<long long, 128> strumEnd {}; // Output time of each key's last strum note-on
+    bool strumDownNext = false;            // Alternate: direction of the next strum
+
+    // Groove quantize of rhythm triggers (see GrooveQuantize); needs the beat grid. Each key's
+    // events leave the delay line shifted by its trigger's offset from the grid (never before
+    // the engine time, so late triggers are pulled in by at most the latency).
+    GrooveQuantize quantize;
+    std::array<long long, 128> triggerShift {}; // Quantize shift of each key's current trigger
+
+    // Output delay (lookahead): generated events leave delayLine latencySamples after their
+    // engine time (output clock = engine clock, advanced in lockstep)
+    int latencySamples = 0;
+    EventScheduler delayLine;
+
+    // Rhythm key -> chord note overrides (nullptr = default mapping), owned by the caller
+    const RhythmKeyMap* rhythmKeyMap = nullptr;
+
+    // Chord input: keys down plus the notes the sustain (CC64) and sostenuto (CC66) pedals and
+    // latch keep; their union (chordInputNotes) is what the chord tracker follows
+    std::array<uint8_t, 128> chordVelocity {}; // Last note-on velocity of each chord input note
+    NoteMask chordKeysDown;
+    NoteMask sustainedChordNotes;          // Released while the sustain pedal is down
+    NoteMask sostenutoChordNotes;          // Down when the sostenuto pedal went down
+    NoteMask latchedChordNotes;            // Released with latch on, until the next chord starts
+    bool sustainPedalDown = false;
+    bool sostenutoPedalDown = false;
+    bool chordLatch = false;
+    NoteMask chordInputNotes() const noexcept {
+        return chordKeysDown | sustainedChordNotes | sostenutoChordNotes | latchedChordNotes;
+    }
+    bool updateChordInput(const MidiEvent& msg) noexcept;
+    void applyChordInput() noexcept;
+    void clearChordInput() noexcept;
+
+    // Chord settle window: chord input only updates the notes above; the chord tracker takes them
+    // over in one step once the input has been quiet for chordSettleSamples (0 = immediately)
+    int chordSettleSamples = 0;
+    long long chordCommitTime = -1;        // When the chord input becomes the chord, -1 = settled
+    long long chordCommitCount = 0;
+    void commitHeldChord() noexcept;
+
+    // Legato chord follow: held notes move to the new chord on a chord change (pitch diff only)
+    bool chordFollow = false;
+    long long followedPitchCount = 0;      // Note-offs plus note-ons sent by chord follow
+
+    // Late-chord grace window: rhythm input waits in pendingRhythm (a third timing wheel, bounded)
+    // and is processed activeGrace samples late, against the chord as it is by then, with its
+    // output pulled back by the same amount. A new window applies once nothing is pending.
+    int chordGraceSamples = 0;
+    int activeGrace = 0;
+    EventScheduler pendingRhythm { 256 };
+    size_t droppedTriggerCount = 0;
+    static constexpr size_t pendingNoteOffReserve = 64; // Entries kept free for note-offs
+    MemoryGauge pendingRhythmMemory;
+
+    // Control routing (see ControlRouting): with thinning, lastControl holds the index of each
+    // control's last routed message in tempEventBuffer (only that one goes out)
+    ControlRouting controlRouting;
+    std::array<int, ControlRouting::numControls> lastControl {};
+    size_t routedControlCount = 0;
+    size_t thinnedControlCount = 0;
+
+    // Polyphony cap (0 = none): a note-on beyond it first steals a playing note (see setMaxVoices)
+    int maxVoices = 0;
+    size_t stolenVoiceCount = 0;
+
+    // Last pass over outputEvents: redundant note events out, same-sample order fixed (Off by default)
+    OutputPeephole outputPeephole;
+
+    // Set when a transport stop queued note-offs into outputEvents (see onIsPlayingChanged)
+    bool stopFlushPending = false;
+
+    // Set by releaseAllNotes(): end all notes (and clear the chord) at the start of the next block
+    bool releaseAllPending = false;
+    bool clearChordPending = false;
+
+    // Heap accounting, published by the audio thread after each block (see appendMemoryUsage)
+    MemoryGauge chordNotesMemory;
+    MemoryGauge playingNotesMemory;
+    MemoryGauge eventScratchMemory;
+    MemoryGauge sortScratchMemory;
+    MemoryGauge outputEventsMemory;
+    MemoryGauge schedulerMemory;
+    MemoryGauge delayLineMemory;
+
+    void publishMemoryUsage() noexcept;
+    
+    static constexpr int defaultChordInputChannel = 1;
+    static constexpr int defaultRhythmInputChannel = 16;
+    static constexpr int defaultOutputChannel = 2;
+
+public:
+    static constexpr size_t defaultMaxEventsPerBlock = 1024;
+    static constexpr size_t maxPlayingNotes = 256;
+
+public:
+    /**
+     * Constructor
+     * @param chordTracker Reference to the ChordNotesTracker
+     * @param patternTracker Reference to the PatternTracker
+     * @param rootNote Root note for rhythm pattern (default: C1 = 24)
+     */
+    ChordPatternCoordinator(ChordNotesTracker& chordTracker, 
+                           PatternTracker& patternTracker,
+                           int rootNote = 24,
+                           EngineLogger* loggerToUse = nullptr)
+        : chordTracker(chordTracker)
+        , patternTracker(patternTracker)
+        , rhythmRootNote(rootNote)
+        , logger(loggerToUse)
+        , chordInputChannel(defaultChordInputChannel)
+        , rhythmInputChannel(defaultRhythmInputChannel)
+        , outputChannel(defaultOutputChannel)
+    {
+        prepare(defaultMaxEventsPerBlock);
+    }
+
+    /**
+     * Preallocate all per-block storage (call outside the audio thread, e.g. in prepareToPlay).
+     * Blocks with up to maxEventsPerBlock input events are then processed without allocating.
+     */
+    void prepare(size_t maxEventsPerBlock);
+
+    void setLogger(EngineLogger* loggerToUse) noexcept { logger = loggerToUse; }
+    EngineLogger* getLogger() const noexcept { return logger; }
+
+    void setChordInputChannel(int channel) noexcept { chordInputChannel = channel; }
+    int getChordInputChannel() const noexcept { return chordInputChannel; }
+
+    void setRhythmInputChannel(int channel) noexcept { rhythmInputChannel = channel; }
+    int getRhythmInputChannel() const noexcept { return rhythmInputChannel; }
+
+    void setOutputChannel(int channel) noexcept { outputChannel = channel; }
+    int getOutputChannel() const noexcept { return outputChannel; }
+
+    /**
+     * Grid that drives the built-in rhythm generator (usually &syncGlobals.getBeatGrid();
+     * nullptr disables the generator). Must be updated before each processBlock call.
+     */
+    void setBeatGrid(const BeatGrid* grid) noexcept { beatGrid = grid; }
+
+    /**
+     * Rhythm key overrides (see RhythmKeyMap; nullptr = default mapping). The map must outlive its
+     * use here. Notes already playing keep the pitch they started with.
+     */
+    void setRhythmKeyMap(const RhythmKeyMap* keyMap) noexcept { rhythmKeyMap = keyMap; }
+    const RhythmKeyMap* getRhythmKeyMap() const noexcept { return rhythmKeyMap; }
+
+    /**
+     * End all playing notes at sample 0 of the next processBlock, e.g. after the input channels
+     * changed while notes were held (their note-offs would never arrive). The held chord is
+     * cleared too unless clearChord is false (chord input channel unchanged). Audio thread.
+     */
+    void releaseAllNotes(bool clearChord = true) noexcept {
+        releaseAllPending = true;
+        clearChordPending = clearChordPending || clearChord;
+    }
+
+    /**
+     * Sample time of the next processBlock's first sample on the coordinator's clock
+     * (samples processed since construction)
+     */
+    long long getSampleTime() const noexcept { return scheduler.getNow(); }
+
+    /**
+     * Emit an output event at an absolute sample time (see getSampleTime), in whichever block it
+     * falls. Events already due come out at the start of the next block. Scheduled note-offs
+     * are sent on a transport stop, other scheduled events are dropped. Audio thread.
+     * @return false if the scheduler is full (see getScheduler)
+     */
+    bool scheduleOutputEvent(const MidiEvent& evt, long long sampleTime) noexcept {
+        return scheduler.schedule(evt, sampleTime);
+    }
+
+    // Capacity, occupancy and rejections of the scheduled events
+    const EventScheduler& getScheduler() const noexcept { return scheduler; }
+
+    /**
+     * Gate of the generated notes (see NoteGate). Takes effect with the next trigger; notes
+     * already playing keep their gate. Audio thread.
+     */
+    void setNoteGate(const NoteGate& gate) noexcept { noteGate = gate; }
+    const NoteGate& getNoteGate() const noexcept { return noteGate; }
+
+    /**
+     * Strum key (see NoteStrum; key NoteStrum::noKey = off). Takes effect with the next trigger.
+     * Audio thread.
+     */
+    void setStrum(const NoteStrum& strumToUse) noexcept { strum = strumToUse; }
+    const NoteStrum& getStrum() const noexcept { return strum; }
+
+    /**
+     * Groove quantize of rhythm triggers (see GrooveQuantize), against the beat grid
+     * (setBeatGrid). Takes effect with the next trigger. Audio thread.
+     */
+    void setGrooveQuantize(const GrooveQuantize& quantizeToUse) noexcept { quantize = quantizeToUse; }
+    const GrooveQuantize& getGrooveQuantize() const noexcept { return quantize; }
+
+    /**
+     * Delay all output by this many samples (the latency the host compensates for). Strums may
+     * begin up to this much before their trigger. Events already delayed keep their time.
+     * Audio thread.
+     */
+    void setLatencySamples(int samples) noexcept { latencySamples = samples > 0 ? samples : 0; }
+    int getLatencySamples() const noexcept { return latencySamples; }
+
+    /**
+     * Pass an event through the delay line so it stays aligned with the delayed output (e.g. MIDI
+     * on other channels). Call before the processBlock of its block, samplePosition relative to
+     * that block. Audio thread.
+     * @return false if the delay line is full (deliver the event undelayed)
+     */
+    bool delayEvent(const MidiEvent& evt) noexcept {
+        return delayLine.schedule(evt, delayLine.getNow() + evt.samplePosition + latencySamples);
+    }
+
+    // Capacity, occupancy and rejections of the delay line
+    const EventScheduler& getDelayLine() const noexcept { return delayLine; }
+
+    /**
+     * True while output is still on its way: scheduled events (gate note-offs, ratchets), the
+     * delay line or rhythm input held by the grace window. At the end of its input a renderer
+     * keeps processing empty blocks until this is false, then stops the transport.
+     */
+    bool hasPendingOutput() const noexcept {
+        return scheduler.size() != 0 || delayLine.size() != 0 || pendingRhythm.size() != 0;
+    }
+
+    /**
+     * Chord settle window: a chord change (the note-ons and note-offs of a chord played by hand,
+     * typically spread over 5-30 ms) becomes the current chord in one step, once the chord input
+     * has been quiet for this many samples. Rhythm triggers in between still use the previous
+     * chord. 0 = every chord note-on/off (and pedal change) applies at once. Audio thread.
+     */
+    void setChordSettleSamples(int samples) noexcept { chordSettleSamples = samples > 0 ? samples : 0; }
+    int getChordSettleSamples() const noexcept { return chordSettleSamples; }
+
+    // Chord states taken over from the settle window (each settled chord change counts once)
+    long long getChordCommitCount() const noexcept { return chordCommitCount; }
+
+    /**
+     * Chord latch: released chord notes stay in the chord until the first key of the next chord
+     * (a note-on while no chord key is down) replaces them. Turning latch off drops the latched
+     * notes. The sustain (CC64) and sostenuto (CC66) pedals on the chord input channel always keep
+     * the notes they hold. Audio thread.
+     */
+    void setChordLatch(bool enabled) noexcept { chordLatch = enabled; }
+    bool getChordLatch() const noexcept { return chordLatch; }
+
+    /**
+     * Legato chord follow: when the chord changes, held notes move to the note their chord index
+     * and octave give in the new chord (once per change position, after the settle window if
+     * any). Only pitches that change get a note-off / note-on; a pitch both chords share keeps
+     * sounding. Notes of strums and Fixed/Ratchet gates keep their pitch. Off by default (notes
+     * keep the pitch they started with). Audio thread.
+     */
+    void setChordFollow(bool enabled) noexcept { chordFollow = enabled; }
+    bool getChordFollow() const noexcept { return chordFollow; }
+
+    // Note-offs plus note-ons chord follow has sent
+    long long getFollowedPitchCount() const noexcept { return followedPitchCount; }
+
+    /**
+     * Output cleanup (see OutputPeephole): Clean drops note-offs of pitches that are not sounding
+     * and note-ons ended at the same sample, Legato also turns a same-sample note-off + note-on of
+     * a sounding pitch into nothing (the note goes on). With either, events at the same sample
+     * leave as note-offs, other messages, note-ons. Off by default. Audio thread.
+     */
+    void setOutputCleanup(OutputCleanup cleanup) noexcept { outputPeephole.setCleanup(cleanup); }
+    OutputCleanup getOutputCleanup() const noexcept { return outputPeephole.getCleanup(); }
+
+    // Events removed by output cleanup, in total and by kind
+    const OutputPeephole& getOutputPeephole() const noexcept { return outputPeephole; }
+
+    /**
+     * Late-chord grace window: rhythm triggers resolve against the chord as it is this many
+     * samples after them, so a hit landing shortly before its chord (recorded material, loose
+     * playing) still plays the new chord, at its own time. Rhythm input is held that long, which
+     * needs as much latency: hosts add the window to setLatencySamples (it is limited to the
+     * latency; strums anticipate only within the rest). Takes effect once no rhythm input is
+     * pending. Audio thread.
+     */
+    void setChordGraceSamples(int samples) noexcept { chordGraceSamples = samples > 0 ? samples : 0; }
+    int getChordGraceSamples() const noexcept { return chordGraceSamples; }
+
+    // Rhythm input held by the grace window (capacity, peak) and note-ons dropped because it was full
+    const EventScheduler& getPendingRhythm() const noexcept { return pendingRhythm; }
+    size_t getDroppedTriggerCount() const noexcept { return droppedTriggerCount; }
+
+    /**
+     * Control routing (see ControlRouting): controllers, pitch bend and channel pressure of the
+     * chord and rhythm inputs go to the output channel (with the latency), polyphonic aftertouch
+     * of a rhythm key to the notes that key plays (with the key's output delay, e.g. quantize or
+     * the grace window, and never before a note's note-on, e.g. a strum note still to come).
+     * Thinning keeps the last value of each control per block. Off by default (consumed like the
+     * notes). Audio thread.
+     */
+    void setControlRouting(const ControlRouting& routing) noexcept { controlRouting = routing; }
+    const ControlRouting& getControlRouting() const noexcept { return controlRouting; }
+
+    // Messages routed to the output (one per note for aftertouch), and routed input dropped by thinning
+    size_t getRoutedControlCount() const noexcept { return routedControlCount; }
+    size_t getThinnedControlCount() const noexcept { return thinnedControlCount; }
+
+    /**
+     * Polyphony cap: with this many notes playing, a new note-on first ends the playing note the
+     * steal policy picks (setVoiceSteal, see VoicePool), with a note-off at the new note's output
+     * time (a strum note still waiting to sound ends right after the strum's last note-on).
+     * Stealing a note is O(1). 0 (default) = no cap; at most maxPlayingNotes. Audio thread.
+     */
+    void setMaxVoices(int voices) noexcept {
+        maxVoices = std::min(std::max(voices, 0), static_cast<int>(maxPlayingNotes));
+    }
+    int getMaxVoices() const noexcept { return maxVoices; }
+
+    void setVoiceSteal(VoiceSteal steal) noexcept { patternTracker.setVoiceSteal(steal); }
+    VoiceSteal getVoiceSteal() const noexcept { return patternTracker.getVoiceSteal(); }
+
+    // Notes ended by the polyphony cap
+    size_t getStolenVoiceCount() const noexcept { return stolenVoiceCount; }
+
+    RhythmGenerator& getRhythmGenerator() noexcept { return rhythmGenerator; }
+    const RhythmGenerator& getRhythmGenerator() const noexcept { return rhythmGenerator; }
+
+    /**
+     * True if MIDI on this channel is consumed/replaced by the coordinator
+     * (chord input, rhythm input and output channel).
+     */
+    bool consumesChannel(int channel) const noexcept {
+        return channel == chordInputChannel || channel == rhythmInputChannel || channel == outputChannel;
+    }
+    
+    /**
+     * Set the rhythm root note
+     * @param rootNote MIDI note number (e.g., 24 for C1)
+     */
+    void setRhythmRootNote(int rootNote) {
+        rhythmRootNote = rootNote;
+    }
+    
+    /**
+     * Get the rhythm root note
+     * @return MIDI note number
+     */
+    int getRhythmRootNote() const {
+        return rhythmRootNote;
+    }
+    
+    /**
+     * Process a block of MIDI events
+     *
+     * Purpose:
+     * - Consume incoming chord input (ch 1) and rhythm trigger input (ch 16)
+     * - Produce output note events (ch 2) with deterministic timing and robust note-off matching
+     *
+     * Edge cases this implementation is designed to tackle (see ChordPatternCoordinator_ProblemCases.md):
+     * 1) Rhythm note On + Off in the same block (must respect time order)
+     * 2) Rhythm note Off + On in the same block (must not create phantom/stuck notes)
+     * 3) Chord updates between rhythm On and Off in the same block (avoid "time travel")
+     * 4) Chord changes while a rhythm note is held across blocks (note-off must match the note-on)
+     * 5) Chord index shifts while held (insert/remove notes changes indices)
+     * 6) Chord cleared / chord too small before note-off (must still be able to stop)
+     * 8) Repeated rhythm NoteOn without NoteOff (retrigger should be deterministic)
+     * 9) Rhythm note below root (negative-relative mapping must be correct)
+     * 10) Off-by-one timing hack (avoid shifting note-ons earlier to "fix" ordering)
+     *
+     * Notes:
+     * - Some cases (e.g. "same output pitch from multiple triggers") require voice ownership/ref-counting
+     *   beyond what plain MIDI note-on/off semantics can guarantee.
+     *
+     * @param events Input events of this block (any order, positions relative to the block start)
+     * @param numEvents Number of input events
+     * @param numSamples Block length; scheduled events due before its end are emitted
+     *
+     * The generated events (output channel only, plus delayEvent() events) are available via
+     * getOutputEvents() until the next call, sorted by sample position and delayed by
+     * getLatencySamples().
+     */
+    void processBlock(const MidiEvent* events, size_t numEvents, int numSamples);
+
+    /**
+     * Generated output events of the last processBlock call (or of a transport stop flush)
+     */
+    const std::vector<MidiEvent>& getOutputEvents() const noexcept {
+        return outputEvents;
+    }
+
+    /**
+     * Returns true once after a transport stop queued note-offs into getOutputEvents().
+     * Hosts that do not call processBlock while stopped use this to deliver the flush.
+     */
+    bool takeStopFlush() noexcept {
+        const bool pending = stopFlushPending;
+        stopFlushPending = false;
+        return pending;
+    }
+    
+    /**
+     * Append the heap usage of the engine components (trackers, scratch buffers) with their
+     * high-water marks since construction. Safe to call from any thread; values are as of the
+     * last processed block.
+     *
+     * @param componentsEmbedded True if the trackers and the coordinator are members of an object
+     *                           whose size the caller reports itself (e.g. the plugin processor)
+     */
+    void appendMemoryUsage(MemoryReport& report, bool componentsEmbedded = false) const noexcept;
+
+    /**
+     * Handle DAW play/stop state changes
+     * When DAW stops, queue note-offs for all playing notes and clear state
+     */
+    void onIsPlayingChanged(const IsPlayingEvent& event) override;
+
+    // Tempo and sample rate for tempo-synced gate lengths
+    void onBPMChanged(const BPMEvent& event) override {
+        if (event.newValues.bpm > 0.0) {
+            bpm = event.newValues.bpm;
+        }
+    }
+    void onSampleRateChanged(const SampleRateEvent& event) override {
+        if (event.newRate > 0.0) {
+            sampleRate = event.newRate;
+        }
+    }
+};
+
+/**
+ * SyncGlobals that calls the coordinator directly (static dispatch, no virtual call).
+ * Bind the coordinator once: syncGlobals.getStaticListeners().bind(coordinator);
+ * Further listeners can still be added with addEventListener.
+ */
+using CoordinatorSyncGlobals = BasicSyncGlobals<GlobalsStaticDispatch<ChordPatternCoordinator>>;
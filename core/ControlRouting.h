@@ -0,0 +1,120 @@
+#pragma once
+
+#include "MidiEvent.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * ControlRouting
+ *
+ * Which non-note messages of the chord and rhythm input channels the coordinator passes on to
+ * its output channel (by default they are consumed like the notes):
+ * - controllers (CC), pitch bend and channel pressure, moved to the output channel as they are
+ * - polyphonic aftertouch on a rhythm key, sent to each output note that key plays (the rhythm
+ *   input only; chord notes do not sound)
+ *
+ * Sustain (CC64) and sostenuto (CC66) on the chord channel always stay there (they hold chord
+ * notes, see ChordPatternCoordinator::setChordLatch).
+ *
+ * With thinning on, a routed message is dropped when a later one in the same block sets the same
+ * control (controller number, pitch bend, channel pressure, aftertouch of a rhythm key) again,
+ * so a fast controller sweep leaves at most one value per control and block. Bank select, data
+ * entry, (N)RPN and channel mode controllers are order dependent and never thinned.
+ *
+ * Fixed size and trivially copyable, so it can be handed to the audio thread as is.
+ *
+ * Usage:
+ *   ControlRouting routing;
+ *   routing.chordInput = ControlRouting::controllers | ControlRouting::pitchBend;
+ *   routing.rhythmInput = ControlRouting::all;
+ *   coordinator.setControlRouting(routing);
+ */
+struct ControlRouting {
+    static constexpr uint8_t controllers = 1;
+    static constexpr uint8_t pitchBend = 2;
+    static constexpr uint8_t channelPressure = 4;
+    static constexpr uint8_t polyAftertouch = 8;
+    static constexpr uint8_t all = controllers | pitchBend | channelPressure | polyAftertouch;
+
+    // Controls one block can set (thinning): 128 controllers, pitch bend, channel pressure and
+    // the aftertouch of 128 rhythm keys
+    static constexpr int numControls = 128 + 2 + 128;
+
+    uint8_t chordInput = 0;                // Kinds routed from the chord input channel
+    uint8_t rhythmInput = 0;               // Kinds routed from the rhythm input channel
+    bool thin = true;                      // Keep only the last value of a control per block
+
+    bool isActive() const noexcept { return (chordInput | rhythmInput) != 0; }
+
+    /**
+     * Control a message sets on the output (0..numControls-1), -1 if it is not routed from
+     * that input (isRhythmInput: it came from the rhythm channel, else from the chord channel)
+     */
+    int controlOf(const MidiEvent& msg, bool isRhythmInput) const noexcept {
+        const uint8_t kinds = isRhythmInput ? rhythmInput : chordInput;
+        if (msg.isController()) {
+            const int number = msg.getControllerNumber();
+            const bool isPedal = !isRhythmInput && (number == 64 || number == 66);
+            return (kinds & controllers) != 0 && !isPedal ? number : -1;
+        }
+        if (msg.isPitchWheel()) {
+            return (kinds & pitchBend) != 0 ? 128 : -1;
+        }
+        if (msg.isChannelPressure()) {
+            return (kinds & channelPressure) != 0 ? 129 : -1;
+        }
+        if (msg.isAftertouch() && isRhythmInput) {
+            return (kinds & polyAftertouch) != 0 ? 130 + msg.getNoteNumber() : -1;
+        }
+        return -1;
+    }
+
+    /**
+     * False for the controllers whose order matters (bank select, data entry, increment and
+     * decrement, (N)RPN numbers, channel mode messages)
+     */
+    static bool isThinnable(int control) noexcept {
+        switch (control) {
+            case 0: case 32:                   // Bank select
+            case 6: case 38:                   // Data entry
+            case 96: case 97:                  // Data increment / decrement
+            case 98: case 99: case 100: case 101: // NRPN / RPN number
+                return false;
+            default:
+                return control < 120 || control >= 128;
+        }
+    }
+
+    /**
+     * Parse a comma-separated list of kinds: "cc", "bend", "pressure", "poly", "all" or "none",
+     * e.g. "cc,bend"
+     * @return false for an unknown kind
+     */
+    static bool parseKinds(const std::string& text, uint8_t& kinds) {
+        uint8_t parsed = 0;
+        size_t start = 0;
+        while (start <= text.size()) {
+            const size_t comma = text.find(',', start);
+            const std::string kind = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+            if (kind == "cc") {
+                parsed |= controllers;
+            } else if (kind == "bend") {
+                parsed |= pitchBend;
+            } else if (kind == "pressure") {
+                parsed |= channelPressure;
+            } else if (kind == "poly") {
+                parsed |= polyAftertouch;
+            } else if (kind == "all") {
+                parsed |= all;
+            } else if (kind != "none") {
+                return false;
+            }
+            if (comma == std::string::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+        kinds = parsed;
+        return true;
+    }
+};
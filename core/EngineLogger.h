@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * EngineLogger
+ *
+ * Minimal logging sink used by the engine. The engine only ever hands over
+ * plain, NUL-terminated text so it stays free of any framework string type.
+ * Implementations decide how (and on which thread) messages are delivered,
+ * e.g. the plugin's EditorLogger or stderr in the command-line tools.
+ *
+ * Usage:
+ *   ENGINE_LOG(logger, "DAW stopped - cleaning up notes");
+ */
+class EngineLogger {
+public:
+    virtual ~EngineLogger() = default;
+
+    /**
+     * Log a message. May be called from the audio thread.
+     * @param message NUL-terminated UTF-8 text (only valid for the duration of the call)
+     */
+    virtual void logEngineMessage(const char* message) noexcept = 0;
+};
+
+// Convenience macro for instance-scoped engine logging
+#define ENGINE_LOG(loggerPtr, msg) \
+    do { \
+        if ((loggerPtr) != nullptr) \
+            (loggerPtr)->logEngineMessage((msg)); \
+    } while(0)
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "MidiEvent.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * EventScheduler
+ *
+ * Fixed-capacity hierarchical timing wheel for output events due in later blocks.
+ * Times are absolute sample times on the owner's sample clock.
+ *
+ * Four levels of 256 slots. Level 0 has one slot per sample; each higher level slot covers a whole
+ * lower wheel (256, 65536, 16M samples). An event goes to the lowest level whose slot range
+ * contains both now and its time, and moves down one level each time the clock enters its slot
+ * (cascade). Occupancy bitmaps let advance() skip empty slots, so draining costs O(due events)
+ * plus a few bitmap words per block. Events due at the same sample come out in scheduling order.
+ *
+ * Entries live in a node pool allocated once (constructor / reserve()); schedule() and advance()
+ * never allocate. When the pool is full, or the time is too far ahead (maxDelaySamples, about
+ * 12 hours at 48 kHz), schedule() fails and counts the rejection.
+ *
+ * Each event carries a caller-defined tag (e.g. the owner and a generation, so stale entries can
+ * be recognised and skipped when they come due instead of searching the wheel to cancel them).
+ *
+ * Usage:
+ *   EventScheduler scheduler;                        // Clock starts at 0
+ *   scheduler.schedule(MidiEvent::noteOff(2, 60, 0, 0), scheduler.getNow() + 12000);
+ *
+ *   // Per block of numSamples:
+ *   scheduler.advance(scheduler.getNow() + numSamples,
+ *       [&](const MidiEvent& evt, long long time, uint32_t tag) { ... });
+ */
+class EventScheduler {
+public:
+    static constexpr size_t defaultCapacity = 1024;
+    static constexpr int numLevels = 4;
+    static constexpr int slotBits = 8;
+    static constexpr int slotsPerLevel = 1 << slotBits;
+    static constexpr long long maxDelaySamples = 1LL << 31;
+
+private:
+    static constexpr int32_t none = -1;
+    static constexpr int wordsPerLevel = slotsPerLevel / 64;
+
+    struct Node {
+        MidiEvent event;
+        long long time = 0;
+        int32_t next = none;
+        uint32_t tag = 0;
+    };
+
+    struct Slot {
+        int32_t head = none;
+        int32_t tail = none;
+    };
+
+    std::vector<Node> nodes;               // Pool, sized once
+    int32_t freeList = none;
+
+    std::array<std::array<Slot, slotsPerLevel>, numLevels> slots {};
+    std::array<std::array<uint64_t, wordsPerLevel>, numLevels> occupied {};
+
+    long long now = 0;                     // First sample not yet advanced over
+    size_t count = 0;
+    size_t peakCount = 0;
+    size_t rejectedCount = 0;
+
+    static int slotIndex(long long time, int level) noexcept {
+        return static_cast<int>((time >> (slotBits * level)) & (slotsPerLevel - 1));
+    }
+
+    // Lowest level whose current slot range also contains time (time >= now)
+    int levelFor(long long time) const noexcept {
+        const unsigned long long differing = static_cast<unsigned long long>(time ^ now);
+        int level = 0;
+        while (level < numLevels - 1 && (differing >> (slotBits * (level + 1))) != 0) {
+            ++level;
+        }
+        return level;
+    }
+
+    void append(int level, int slot, int32_t index) noexcept {
+        Slot& target = slots[static_cast<size_t>(level)][static_cast<size_t>(slot)];
+        nodes[static_cast<size_t>(index)].next = none;
+        if (target.tail == none) {
+            target.head = index;
+            occupied[static_cast<size_t>(level)][static_cast<size_t>(slot >> 6)] |= 1ULL << (slot & 63);
+        } else {
+            nodes[static_cast<size_t>(target.tail)].next = index;
+        }
+        target.tail = index;
+    }
+
+    // Detach a slot's list and clear its occupancy bit
+    int32_t take(int level, int slot) noexcept {
+        Slot& source = slots[static_cast<size_t>(level)][static_cast<size_t>(slot)];
+        const int32_t head = source.head;
+        source.head = none;
+        source.tail = none;
+        occupied[static_cast<size_t>(level)][static_cast<size_t>(slot >> 6)] &= ~(1ULL << (slot & 63));
+        return head;
+    }
+
+    void insert(int32_t index) noexcept {
+        const long long time = nodes[static_cast<size_t>(index)].time;
+        const int level = levelFor(time);
+        append(level, slotIndex(time, level), index);
+    }
+
+    void release(int32_t index) noexcept {
+        nodes[static_cast<size_t>(index)].next = freeList;
+        freeList = index;
+        --count;
+    }
+
+    // The clock entered a new level-0 wheel: move the entries of the slots now current one level down
+    void cascade() noexcept {
+        int top = 1;
+        while (top < numLevels - 1 && slotIndex(now, top) == 0) {
+            ++top;
+        }
+        for (int level = top; level >= 1; --level) {
+            int32_t index = take(level, slotIndex(now, level));
+            while (index != none) {
+                const int32_t next = nodes[static_cast<size_t>(index)].next;
+                insert(index);
+                index = next;
+            }
+        }
+    }
+
+    // First occupied level-0 slot in [from, to], -1 if none
+    int nextOccupied(int from, int to) const noexcept {
+        const auto& bits = occupied[0];
+        for (int word = from >> 6; word <= to >> 6; ++word) {
+            uint64_t mask = bits[static_cast<size_t>(word)];
+            if (word == from >> 6) {
+                mask &= ~0ULL << (from & 63);
+            }
+            if (word == to >> 6 && (to & 63) != 63) {
+                mask &= (1ULL << ((to & 63) + 1)) - 1;
+            }
+            if (mask != 0) {
+                return (word << 6) + countTrailingZeros(mask);
+            }
+        }
+        return -1;
+    }
+
+    static int countTrailingZeros(uint64_t mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(mask);
+#else
+        int bit = 0;
+        while ((mask & 1) == 0) {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+public:
+    explicit EventScheduler(size_t capacity = defaultCapacity) {
+        reserve(capacity);
+    }
+
+    EventScheduler(const EventScheduler&) = delete;
+    EventScheduler& operator=(const EventScheduler&) = delete;
+
+    /**
+     * Size the node pool (outside the audio thread). Drops all scheduled events.
+     */
+    void reserve(size_t capacity) {
+        nodes.assign(capacity, Node {});
+        clear();
+    }
+
+    /**
+     * Drop all scheduled events (the clock keeps running)
+     */
+    void clear() noexcept {
+        for (auto& level : slots) {
+            level.fill(Slot {});
+        }
+        for (auto& level : occupied) {
+            level.fill(0);
+        }
+        freeList = none;
+        for (size_t i = nodes.size(); i-- > 0;) {
+            nodes[i].next = freeList;
+            freeList = static_cast<int32_t>(i);
+        }
+        count = 0;
+    }
+
+    /**
+     * Schedule an event at an absolute sample time. Times before getNow() are due in the next
+     * advance(). The event's samplePosition is ignored (advance() reports the time).
+     * @return false if the pool is full or the time is more than maxDelaySamples ahead
+     */
+    bool schedule(const MidiEvent& event, long long time, uint32_t tag = 0) noexcept {
+        if (freeList == none || time - now >= maxDelaySamples) {
+            ++rejectedCount;
+            return false;
+        }
+        const int32_t index = freeList;
+        Node& node = nodes[static_cast<size_t>(index)];
+        freeList = node.next;
+        node.event = event;
+        node.time = time < now ? now : time;
+        node.tag = tag;
+        insert(index);
+        if (++count > peakCount) {
+            peakCount = count;
+        }
+        return true;
+    }
+
+    /**
+     * Move the clock to end (exclusive) and hand out every event due before it, in time order:
+     * callback(const MidiEvent& event, long long time, uint32_t tag). Events scheduled for a
+     * time already passed report the clock position at which they were scheduled.
+     * The callback must not schedule (split the advance instead).
+     */
+    template<typename Callback>
+    void advance(long long end, Callback&& callback) noexcept {
+        if (count == 0) {
+            now = end > now ? end : now;
+            return;
+        }
+        while (now < end) {
+            const long long wheelEnd = (now | (slotsPerLevel - 1)) + 1;
+            const long long stop = end < wheelEnd ? end : wheelEnd;
+            if (count != 0) {
+                const int last = slotIndex(stop - 1, 0);
+                for (int slot = nextOccupied(slotIndex(now, 0), last); slot >= 0;
+                     slot = slot < last ? nextOccupied(slot + 1, last) : -1) {
+                    int32_t index = take(0, slot);
+                    while (index != none) {
+                        const Node& node = nodes[static_cast<size_t>(index)];
+                        const int32_t next = node.next;
+                        callback(node.event, node.time, node.tag);
+                        release(index);
+                        index = next;
+                    }
+                }
+            }
+            now = stop;
+            if (now == wheelEnd && count != 0) {
+                cascade();
+            }
+        }
+    }
+
+    /**
+     * Remove all scheduled events, handing each to callback(const MidiEvent&, long long time,
+     * uint32_t tag) in no particular order (e.g. to send pending note-offs on a transport stop)
+     */
+    template<typename Callback>
+    void flush(Callback&& callback) noexcept {
+        for (int level = 0; level < numLevels; ++level) {
+            for (int slot = 0; slot < slotsPerLevel; ++slot) {
+                for (int32_t index = slots[static_cast<size_t>(level)][static_cast<size_t>(slot)].head; index != none;
+                     index = nodes[static_cast<size_t>(index)].next) {
+                    const Node& node = nodes[static_cast<size_t>(index)];
+                    callback(node.event, node.time, node.tag);
+                }
+            }
+        }
+        clear();
+    }
+
+    long long getNow() const noexcept { return now; }
+
+    size_t size() const noexcept { return count; }
+    size_t capacity() const noexcept { return nodes.size(); }
+    size_t getPeakSize() const noexcept { return peakCount; }
+    size_t getRejectedCount() const noexcept { return rejectedCount; }
+
+    // Pool bytes (for memory reports)
+    static constexpr size_t bytesPerEvent = sizeof(Node);
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+/**
+ * GrooveTemplate
+ *
+ * Timing and velocity of each grid line in a repeating cycle of numSteps lines (e.g. 16 for a
+ * bar of 16ths). Fixed size and trivially copyable, so it can be handed to the audio thread as is.
+ */
+struct GrooveTemplate {
+    static constexpr int maxSteps = 32;
+
+    int numSteps = 0;                      // 0 = no template
+    float timing[maxSteps] {};             // Offset of each line, fraction of a grid step (-0.5..0.5)
+    float velocity[maxSteps] {};           // Velocity scale of each line (0..2)
+
+    /**
+     * Parse one entry per grid line: timing in percent of a step, optionally followed by the
+     * velocity in percent, e.g. "0 +12 0 -8/80 0 +12/110"
+     * @return false if malformed or out of range (error describes the problem)
+     */
+    static bool parse(const std::string& text, GrooveTemplate& groove, std::string& error) {
+        GrooveTemplate parsed;
+        const char* cursor = text.c_str();
+        for (;;) {
+            while (*cursor == ' ' || *cursor == '\t' || *cursor == ',' || *cursor == '\n' || *cursor == '\r') {
+                ++cursor;
+            }
+            if (*cursor == '\0') {
+                break;
+            }
+            if (parsed.numSteps == maxSteps) {
+                error = "Groove has more than " + std::to_string(maxSteps) + " steps";
+                return false;
+            }
+            char* end = nullptr;
+            const double timing = std::strtod(cursor, &end);
+            if (end == cursor || timing < -50.0 || timing > 50.0) {
+                error = "Invalid groove timing at step " + std::to_string(parsed.numSteps + 1) + " (-50..50 percent)";
+                return false;
+            }
+            double velocity = 100.0;
+            if (*end == '/') {
+                const char* velocityText = end + 1;
+                velocity = std::strtod(velocityText, &end);
+                if (end == velocityText || velocity < 0.0 || velocity > 200.0) {
+                    error = "Invalid groove velocity at step " + std::to_string(parsed.numSteps + 1) + " (0..200 percent)";
+                    return false;
+                }
+            }
+            if (*end != '\0' && *end != ' ' && *end != '\t' && *end != ',' && *end != '\n' && *end != '\r') {
+                error = "Unexpected character in groove step " + std::to_string(parsed.numSteps + 1);
+                return false;
+            }
+            parsed.timing[parsed.numSteps] = static_cast<float>(timing / 100.0);
+            parsed.velocity[parsed.numSteps] = static_cast<float>(velocity / 100.0);
+            ++parsed.numSteps;
+            cursor = end;
+        }
+        groove = parsed;
+        return true;
+    }
+};
+
+/**
+ * GrooveQuantize
+ *
+ * Optional quantize stage for rhythm triggers: each trigger moves toward the nearest line of a
+ * grid on the host's musical position (BeatGrid), by strength. Every second line can be swung
+ * and a groove template shifts and accents single lines. Applied per trigger by the coordinator,
+ * so all notes of the trigger (including strums, gate repeats and note-offs) move together.
+ *
+ * Early triggers are held until their quantized time (in the coordinator's delay line); late ones
+ * can only be pulled in as far as the coordinator's latency (lookahead) allows.
+ *
+ * Usage:
+ *   GrooveQuantize quantize;
+ *   quantize.enabled = true;
+ *   quantize.gridQuarters = 0.25;          // 16ths
+ *   quantize.strength = 0.8;
+ *   quantize.swing = 0.58;                 // MPC-style 58 %
+ *   coordinator.setGrooveQuantize(quantize);
+ */
+struct GrooveQuantize {
+    static constexpr double minGridQuarters = 1.0 / 16.0;
+    static constexpr double maxGridQuarters = 4.0;
+
+    bool enabled = false;
+    double gridQuarters = 0.25;            // Grid step (default 1/16)
+    double strength = 1.0;                 // 0 = off .. 1 = onto the line
+    double swing = 0.5;                    // Position of every second line within its pair (0.5 = straight .. 0.75)
+    GrooveTemplate groove;
+
+    /**
+     * Position (quarters) of grid line index, with swing and groove applied
+     */
+    double linePpq(long long index) const noexcept {
+        const double grid = getGridQuarters();
+        double ppq = static_cast<double>(index) * grid;
+        if ((index & 1) != 0) {
+            const double clampedSwing = swing < 0.5 ? 0.5 : swing > 0.75 ? 0.75 : swing;
+            ppq += (clampedSwing * 2.0 - 1.0) * grid;
+        }
+        if (groove.numSteps > 0) {
+            ppq += groove.timing[static_cast<size_t>(stepOf(index))] * grid;
+        }
+        return ppq;
+    }
+
+    /**
+     * Quantized position of a trigger at ppq, and the velocity scale of its grid line
+     */
+    double quantize(double ppq, double& velocityScale) const noexcept {
+        const long long nearest = static_cast<long long>(std::floor(ppq / getGridQuarters() + 0.5));
+        long long bestIndex = nearest;
+        double best = linePpq(nearest);
+        for (long long index = nearest - 1; index <= nearest + 1; index += 2) {
+            const double line = linePpq(index);
+            if (std::abs(line - ppq) < std::abs(best - ppq)) {
+                best = line;
+                bestIndex = index;
+            }
+        }
+        velocityScale = groove.numSteps > 0 ? groove.velocity[static_cast<size_t>(stepOf(bestIndex))] : 1.0;
+        const double amount = strength < 0.0 ? 0.0 : strength > 1.0 ? 1.0 : strength;
+        return ppq + amount * (best - ppq);
+    }
+
+    double getGridQuarters() const noexcept {
+        return gridQuarters < minGridQuarters ? minGridQuarters : gridQuarters > maxGridQuarters ? maxGridQuarters : gridQuarters;
+    }
+
+private:
+    long long stepOf(long long index) const noexcept {
+        const long long step = index % groove.numSteps;
+        return step < 0 ? step + groove.numSteps : step;
+    }
+};
@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& path, std::string& error)
+{
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        error = "cannot stat " + path;
+        return false;
+    }
+
+    fileHandle = file;
+    opened = true;
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    if (mappedSize == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        error = "cannot map " + path;
+        return false;
+    }
+    mappingHandle = mapping;
+
+    mappedData = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (mappedData == nullptr) {
+        close();
+        error = "cannot map " + path;
+        return false;
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        error = "cannot stat " + path;
+        return false;
+    }
+
+    fileDescriptor = fd;
+    opened = true;
+    mappedSize = static_cast<size_t>(info.st_size);
+    if (mappedSize == 0) {
+        return true;
+    }
+
+    void* address = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) {
+        close();
+        error = "cannot map " + path;
+        return false;
+    }
+    mappedData = static_cast<const uint8_t*>(address);
+
+    // Files are walked front to back
+    ::madvise(address, mappedSize, MADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+void MappedFile::close() noexcept
+{
+#if defined(_WIN32)
+    if (mappedData != nullptr) {
+        UnmapViewOfFile(mappedData);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+    }
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (mappedData != nullptr) {
+        ::munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+    }
+    fileDescriptor = -1;
+#endif
+    mappedData = nullptr;
+    mappedSize = 0;
+    opened = false;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * MappedFile
+ *
+ * Read-only memory mapping of a whole file (POSIX mmap / Win32 file mapping).
+ * The mapping stays valid until close() or destruction; data is paged in on demand
+ * instead of being copied into a heap buffer.
+ *
+ * Usage:
+ *   MappedFile file;
+ *   std::string error;
+ *   if (!file.open("corpus.mid", error)) { ... }
+ *   parse(file.data(), file.size());
+ */
+class MappedFile {
+private:
+    const uint8_t* mappedData = nullptr;
+    size_t mappedSize = 0;
+    bool opened = false;
+
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Map a file read-only
+     * @return false if the file cannot be opened or mapped (error describes the problem)
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * Unmap (safe to call when nothing is mapped)
+     */
+    void close() noexcept;
+
+    bool isOpen() const noexcept {
+        return opened;
+    }
+
+    const uint8_t* data() const noexcept {
+        return mappedData;
+    }
+
+    size_t size() const noexcept {
+        return mappedSize;
+    }
+};
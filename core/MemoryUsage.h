@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * One row of a per-instance memory report
+ */
+struct MemoryUsage {
+    const char* component = "";
+    size_t objectBytes = 0;         // sizeof the component object
+    bool embedded = false;          // Object lives inside its owner (objectBytes already counted there)
+    size_t heapBytes = 0;           // Heap currently owned (reserved capacity)
+    size_t heapPeakBytes = 0;       // High-water of heapBytes since load
+    size_t usedBytes = 0;           // Part of heapBytes holding live data
+    size_t usedPeakBytes = 0;       // High-water of usedBytes since load
+};
+
+/**
+ * Heap bytes owned / in use by a vector
+ */
+template<typename T>
+size_t heapBytesOf(const std::vector<T>& v) noexcept {
+    return v.capacity() * sizeof(T);
+}
+
+template<typename T>
+size_t usedBytesOf(const std::vector<T>& v) noexcept {
+    return v.size() * sizeof(T);
+}
+
+/**
+ * MemoryGauge
+ *
+ * Current value and high-water mark of one component's heap usage.
+ * Written by the thread that owns the component (usually the audio thread; relaxed atomic
+ * stores, no allocation), read from any thread (editor, export).
+ */
+class MemoryGauge {
+private:
+    std::atomic<size_t> heap { 0 };
+    std::atomic<size_t> heapPeak { 0 };
+    std::atomic<size_t> used { 0 };
+    std::atomic<size_t> usedPeak { 0 };
+
+public:
+    void update(size_t heapBytes, size_t usedBytes) noexcept {
+        heap.store(heapBytes, std::memory_order_relaxed);
+        used.store(usedBytes, std::memory_order_relaxed);
+        if (heapBytes > heapPeak.load(std::memory_order_relaxed)) {
+            heapPeak.store(heapBytes, std::memory_order_relaxed);
+        }
+        if (usedBytes > usedPeak.load(std::memory_order_relaxed)) {
+            usedPeak.store(usedBytes, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Raise the used high-water mark to a peak observed between updates
+     */
+    void notePeakUsed(size_t usedBytes) noexcept {
+        if (usedBytes > usedPeak.load(std::memory_order_relaxed)) {
+            usedPeak.store(usedBytes, std::memory_order_relaxed);
+        }
+    }
+
+    MemoryUsage read(const char* component, size_t objectBytes, bool embedded) const noexcept {
+        MemoryUsage usage;
+        usage.component = component;
+        usage.objectBytes = objectBytes;
+        usage.embedded = embedded;
+        usage.heapBytes = heap.load(std::memory_order_relaxed);
+        usage.heapPeakBytes = heapPeak.load(std::memory_order_relaxed);
+        usage.usedBytes = used.load(std::memory_order_relaxed);
+        usage.usedPeakBytes = usedPeak.load(std::memory_order_relaxed);
+        return usage;
+    }
+};
+
+/**
+ * MemoryReport
+ *
+ * Fixed-capacity collection of MemoryUsage rows for one instance, with text/CSV formatting
+ * for the editor and for export (budgets, regression checks).
+ *
+ * Usage:
+ *   MemoryReport report;
+ *   coordinator.appendMemoryUsage(report);
+ *   report.add(loggerUsage);
+ *   std::string csv = report.toCsv();
+ */
+class MemoryReport {
+public:
+    static constexpr size_t maxRows = 16;
+
+private:
+    std::array<MemoryUsage, maxRows> rows {};
+    size_t numRows = 0;
+
+public:
+    void add(const MemoryUsage& usage) noexcept {
+        if (numRows < maxRows) {
+            rows[numRows++] = usage;
+        }
+    }
+
+    void clear() noexcept { numRows = 0; }
+    size_t size() const noexcept { return numRows; }
+    const MemoryUsage& operator[](size_t index) const noexcept { return rows[index]; }
+
+    /**
+     * Column sums (objectBytes without embedded objects)
+     */
+    MemoryUsage totals() const noexcept {
+        MemoryUsage sum;
+        sum.component = "total";
+        for (size_t i = 0; i < numRows; ++i) {
+            sum.objectBytes += rows[i].embedded ? 0 : rows[i].objectBytes;
+            sum.heapBytes += rows[i].heapBytes;
+            sum.heapPeakBytes += rows[i].heapPeakBytes;
+            sum.usedBytes += rows[i].usedBytes;
+            sum.usedPeakBytes += rows[i].usedPeakBytes;
+        }
+        return sum;
+    }
+
+    /**
+     * Total footprint: non-embedded objects plus all heap bytes
+     */
+    size_t totalBytes() const noexcept {
+        const MemoryUsage sum = totals();
+        return sum.objectBytes + sum.heapBytes;
+    }
+
+    /**
+     * High-water of the total footprint (sum of the per-component peaks, an upper bound)
+     */
+    size_t totalPeakBytes() const noexcept {
+        const MemoryUsage sum = totals();
+        return sum.objectBytes + sum.heapPeakBytes;
+    }
+
+    /**
+     * Aligned table, one component per line plus a total line
+     */
+    std::string toText() const {
+        std::string text;
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-26s %10s %10s %10s %10s %10s\n",
+                      "component", "object", "heap", "heap peak", "used", "used peak");
+        text += line;
+        for (size_t i = 0; i < numRows; ++i) {
+            const auto& r = rows[i];
+            std::snprintf(line, sizeof(line), "%-26s %9zu%s %10zu %10zu %10zu %10zu\n",
+                          r.component, r.objectBytes, r.embedded ? "*" : " ",
+                          r.heapBytes, r.heapPeakBytes, r.usedBytes, r.usedPeakBytes);
+            text += line;
+        }
+        const MemoryUsage sum = totals();
+        std::snprintf(line, sizeof(line), "%-26s %10zu %10zu %10zu %10zu %10zu\n",
+                      "total", sum.objectBytes, sum.heapBytes, sum.heapPeakBytes, sum.usedBytes, sum.usedPeakBytes);
+        text += line;
+        std::snprintf(line, sizeof(line), "footprint %zu bytes, peak %zu bytes (* = inside owner object)\n",
+                      totalBytes(), totalPeakBytes());
+        text += line;
+        return text;
+    }
+
+    /**
+     * CSV with a header row; the last row holds the column sums
+     */
+    std::string toCsv() const {
+        std::string csv = "component,object_bytes,embedded,heap_bytes,heap_peak_bytes,used_bytes,used_peak_bytes\n";
+        char line[160];
+        for (size_t i = 0; i < numRows; ++i) {
+            const auto& r = rows[i];
+            std::snprintf(line, sizeof(line), "%s,%zu,%d,%zu,%zu,%zu,%zu\n",
+                          r.component, r.objectBytes, r.embedded ? 1 : 0,
+                          r.heapBytes, r.heapPeakBytes, r.usedBytes, r.usedPeakBytes);
+            csv += line;
+        }
+        const MemoryUsage sum = totals();
+        std::snprintf(line, sizeof(line), "total,%zu,0,%zu,%zu,%zu,%zu\n",
+                      sum.objectBytes, sum.heapBytes, sum.heapPeakBytes, sum.usedBytes, sum.usedPeakBytes);
+        csv += line;
+        return csv;
+    }
+};
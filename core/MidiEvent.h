@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * MidiEvent
+ *
+ * Compact, framework-independent MIDI channel message with a sample position.
+ * This is the event type the engine works on: raw status/data bytes (max. 3 bytes,
+ * i.e. channel voice messages) plus the offset of the event inside the current block.
+ *
+ * The query helpers follow the semantics of juce::MidiMessage so the algorithm reads the same:
+ * - isNoteOn() is false for a note-on with velocity 0
+ * - isNoteOff() is true for a note-off and for a note-on with velocity 0
+ *
+ * Usage:
+ *   auto on = MidiEvent::noteOn(2, 60, 100, samplePosition);
+ *   if (evt.isForChannel(16) && evt.isNoteOn()) { ... }
+ */
+struct MidiEvent {
+    int samplePosition = 0;   // Offset inside the current block (samples)
+    uint8_t status = 0;       // Status byte (message type | channel - 1)
+    uint8_t data1 = 0;        // First data byte (e.g. note number)
+    uint8_t data2 = 0;        // Second data byte (e.g. velocity)
+    uint8_t size = 0;         // Number of valid bytes (1..3)
+
+    MidiEvent() = default;
+
+    MidiEvent(uint8_t statusByte, uint8_t d1, uint8_t d2, int pos)
+        : samplePosition(pos), status(statusByte), data1(d1), data2(d2),
+          size(static_cast<uint8_t>(getMessageLengthFromStatus(statusByte))) {}
+
+    /**
+     * Build an event from raw bytes.
+     * @return false if the bytes are not a complete channel voice message (e.g. sysex)
+     */
+    static bool fromRawData(const uint8_t* data, int numBytes, int pos, MidiEvent& out) noexcept {
+        if (data == nullptr || numBytes <= 0 || (data[0] & 0x80) == 0 || data[0] >= 0xf0) {
+            return false;
+        }
+        const int len = getMessageLengthFromStatus(data[0]);
+        if (numBytes < len) {
+            return false;
+        }
+        out.samplePosition = pos;
+        out.status = data[0];
+        out.data1 = len > 1 ? (data[1] & 0x7f) : 0;
+        out.data2 = len > 2 ? (data[2] & 0x7f) : 0;
+        out.size = static_cast<uint8_t>(len);
+        return true;
+    }
+
+    /**
+     * Expected length in bytes of a channel voice message with the given status byte
+     */
+    static int getMessageLengthFromStatus(uint8_t statusByte) noexcept {
+        switch (statusByte & 0xf0) {
+            case 0xc0:
+            case 0xd0:
+                return 2;
+            default:
+                return 3;
+        }
+    }
+
+    static MidiEvent noteOn(int channel, int noteNumber, uint8_t velocity, int pos = 0) noexcept {
+        return MidiEvent(static_cast<uint8_t>(0x90 | ((channel - 1) & 0x0f)),
+                         static_cast<uint8_t>(noteNumber & 0x7f),
+                         static_cast<uint8_t>(velocity & 0x7f), pos);
+    }
+
+    static MidiEvent noteOff(int channel, int noteNumber, uint8_t velocity = 0, int pos = 0) noexcept {
+        return MidiEvent(static_cast<uint8_t>(0x80 | ((channel - 1) & 0x0f)),
+                         static_cast<uint8_t>(noteNumber & 0x7f),
+                         static_cast<uint8_t>(velocity & 0x7f), pos);
+    }
+
+    static MidiEvent controller(int channel, int controllerNumber, int value, int pos = 0) noexcept {
+        return MidiEvent(static_cast<uint8_t>(0xb0 | ((channel - 1) & 0x0f)),
+                         static_cast<uint8_t>(controllerNumber & 0x7f),
+                         static_cast<uint8_t>(value & 0x7f), pos);
+    }
+
+    static MidiEvent aftertouch(int channel, int noteNumber, int value, int pos = 0) noexcept {
+        return MidiEvent(static_cast<uint8_t>(0xa0 | ((channel - 1) & 0x0f)),
+                         static_cast<uint8_t>(noteNumber & 0x7f),
+                         static_cast<uint8_t>(value & 0x7f), pos);
+    }
+
+    // The same message on another channel
+    MidiEvent withChannel(int channel) const noexcept {
+        MidiEvent evt = *this;
+        evt.status = static_cast<uint8_t>((status & 0xf0) | ((channel - 1) & 0x0f));
+        return evt;
+    }
+
+    const uint8_t* getRawData() const noexcept {
+        return &status;
+    }
+    int getRawDataSize() const noexcept {
+        return size;
+    }
+
+    // MIDI channel, 1..16
+    int getChannel() const noexcept {
+        return (status & 0x0f) + 1;
+    }
+    bool isForChannel(int channel) const noexcept {
+        return getChannel() == channel;
+    }
+
+    bool isNoteOn() const noexcept {
+        return (status & 0xf0) == 0x90 && data2 != 0;
+    }
+    bool isNoteOff() const noexcept {
+        return (status & 0xf0) == 0x80 || ((status & 0xf0) == 0x90 && data2 == 0);
+    }
+
+    bool isProgramChange() const noexcept {
+        return (status & 0xf0) == 0xc0;
+    }
+    bool isController() const noexcept {
+        return (status & 0xf0) == 0xb0;
+    }
+    bool isAftertouch() const noexcept {
+        return (status & 0xf0) == 0xa0;
+    }
+    bool isChannelPressure() const noexcept {
+        return (status & 0xf0) == 0xd0;
+    }
+    bool isPitchWheel() const noexcept {
+        return (status & 0xf0) == 0xe0;
+    }
+
+    int getNoteNumber() const noexcept {
+        return data1;
+    }
+    int getVelocity() const noexcept {
+        return data2;
+    }
+    int getProgramChangeNumber() const noexcept {
+        return data1;
+    }
+    int getControllerNumber() const noexcept {
+        return data1;
+    }
+    int getControllerValue() const noexcept {
+        return data2;
+    }
+    int getAfterTouchValue() const noexcept {
+        return data2;
+    }
+};
+
+static_assert(sizeof(MidiEvent) == 8, "MidiEvent is meant to stay a compact 8-byte record");
@@ -0,0 +1,259 @@
+#include "MidiFileReader.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint32_t readBigEndian(const uint8_t* p, int numBytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < numBytes; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// Reads a variable-length quantity (max. 4 bytes). Returns false if it runs past end.
+inline bool readVariableLength(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (p >= end) {
+            return false;
+        }
+        const uint8_t byte = *p++;
+        value = (value << 7) | (byte & 0x7f);
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool MidiFileReader::open(const std::string& path, std::string& error)
+{
+    if (!mapping.open(path, error)) {
+        return false;
+    }
+    if (!openMemory(mapping.data(), mapping.size(), error)) {
+        mapping.close();
+        return false;
+    }
+    return true;
+}
+
+bool MidiFileReader::openMemory(const uint8_t* data, size_t size, std::string& error)
+{
+    tracks.clear();
+    tempoMap.clear();
+    lengthInTicks = 0;
+
+    if (data == nullptr || size < 14 || std::memcmp(data, "MThd", 4) != 0) {
+        error = "not a Standard MIDI File";
+        return false;
+    }
+    const uint32_t headerLength = readBigEndian(data + 4, 4);
+    if (headerLength < 6 || size < 8 + static_cast<size_t>(headerLength)) {
+        error = "truncated header";
+        return false;
+    }
+    format = static_cast<int>(readBigEndian(data + 8, 2));
+    const uint32_t numTracks = readBigEndian(data + 10, 2);
+    const uint32_t division = readBigEndian(data + 12, 2);
+    if (division & 0x8000) {
+        error = "SMPTE time division is not supported";
+        return false;
+    }
+    if (division == 0) {
+        error = "invalid time division";
+        return false;
+    }
+    ticksPerQuarter = static_cast<int>(division);
+
+    // Locate the track chunks (unknown chunk types are skipped)
+    const uint8_t* p = data + 8 + headerLength;
+    const uint8_t* end = data + size;
+    tracks.reserve(numTracks);
+    while (tracks.size() < numTracks && end - p >= 8) {
+        const uint32_t chunkLength = readBigEndian(p + 4, 4);
+        const bool isTrack = std::memcmp(p, "MTrk", 4) == 0;
+        p += 8;
+        if (static_cast<size_t>(end - p) < chunkLength) {
+            error = "truncated chunk";
+            return false;
+        }
+        if (isTrack) {
+            TrackCursor cursor;
+            cursor.begin = p;
+            cursor.end = p + chunkLength;
+            tracks.push_back(cursor);
+        }
+        p += chunkLength;
+    }
+
+    // Validation pass: walks every event once, collects tempo map and length
+    for (const auto& track : tracks) {
+        TrackCursor cursor = track;
+        cursor.pos = cursor.begin;
+        MidiFileEvent evt;
+        for (;;) {
+            uint32_t tempo = 0;
+            const char* stepError = nullptr;
+            const StepResult result = step(cursor, evt, tempo, stepError);
+            if (result == StepResult::Error) {
+                error = stepError;
+                tracks.clear();
+                return false;
+            }
+            if (result == StepResult::Tempo) {
+                tempoMap.push_back({cursor.tick, tempo});
+            }
+            if (result == StepResult::EndOfTrack) {
+                break;
+            }
+        }
+        lengthInTicks = std::max(lengthInTicks, cursor.tick);
+    }
+
+    std::stable_sort(tempoMap.begin(), tempoMap.end(),
+        [](const TempoChange& a, const TempoChange& b) { return a.tick < b.tick; });
+
+    rewind();
+    return true;
+}
+
+void MidiFileReader::rewind()
+{
+    for (auto& cursor : tracks) {
+        cursor.pos = cursor.begin;
+        cursor.tick = 0;
+        cursor.runningStatus = 0;
+        prefetch(cursor);
+    }
+}
+
+bool MidiFileReader::next(MidiFileEvent& evt)
+{
+    // Pick the earliest pending event; equal ticks resolve to the lower track index.
+    TrackCursor* earliest = nullptr;
+    for (auto& cursor : tracks) {
+        if (cursor.hasPending && (earliest == nullptr || cursor.pending.tick < earliest->pending.tick)) {
+            earliest = &cursor;
+        }
+    }
+    if (earliest == nullptr) {
+        return false;
+    }
+
+    evt = earliest->pending;
+    prefetch(*earliest);
+    return true;
+}
+
+void MidiFileReader::prefetch(TrackCursor& cursor)
+{
+    cursor.hasPending = false;
+    uint32_t tempo = 0;
+    const char* error = nullptr;
+    for (;;) {
+        const StepResult result = step(cursor, cursor.pending, tempo, error);
+        if (result == StepResult::ChannelEvent) {
+            cursor.hasPending = true;
+            return;
+        }
+        if (result == StepResult::EndOfTrack || result == StepResult::Error) {
+            return;
+        }
+    }
+}
+
+MidiFileReader::StepResult MidiFileReader::step(TrackCursor& cursor, MidiFileEvent& evt, uint32_t& tempo, const char*& error)
+{
+    const uint8_t*& p = cursor.pos;
+    const uint8_t* end = cursor.end;
+
+    if (p >= end) {
+        // Missing end-of-track meta event: tolerated
+        return StepResult::EndOfTrack;
+    }
+
+    uint32_t delta = 0;
+    if (!readVariableLength(p, end, delta)) {
+        error = "truncated delta time";
+        return StepResult::Error;
+    }
+    cursor.tick += delta;
+
+    if (p >= end) {
+        error = "truncated event";
+        return StepResult::Error;
+    }
+
+    uint8_t status = *p;
+    if (status & 0x80) {
+        ++p;
+    } else if (cursor.runningStatus != 0) {
+        status = cursor.runningStatus;
+    } else {
+        error = "data byte without running status";
+        return StepResult::Error;
+    }
+
+    if (status == 0xff) {
+        // Meta event
+        if (p >= end) {
+            error = "truncated meta event";
+            return StepResult::Error;
+        }
+        const uint8_t type = *p++;
+        uint32_t length = 0;
+        if (!readVariableLength(p, end, length) || static_cast<size_t>(end - p) < length) {
+            error = "truncated meta event";
+            return StepResult::Error;
+        }
+        const uint8_t* payload = p;
+        p += length;
+        cursor.runningStatus = 0;
+        if (type == 0x2f) {
+            p = end;
+            return StepResult::EndOfTrack;
+        }
+        if (type == 0x51 && length == 3) {
+            tempo = readBigEndian(payload, 3);
+            return StepResult::Tempo;
+        }
+        return StepResult::Other;
+    }
+
+    if (status == 0xf0 || status == 0xf7) {
+        // Sysex: skipped
+        uint32_t length = 0;
+        if (!readVariableLength(p, end, length) || static_cast<size_t>(end - p) < length) {
+            error = "truncated sysex event";
+            return StepResult::Error;
+        }
+        p += length;
+        cursor.runningStatus = 0;
+        return StepResult::Other;
+    }
+
+    if (status >= 0xf0) {
+        error = "unexpected system message in track";
+        return StepResult::Error;
+    }
+
+    cursor.runningStatus = status;
+    const int numDataBytes = MidiEvent::getMessageLengthFromStatus(status) - 1;
+    if (end - p < numDataBytes) {
+        error = "truncated channel message";
+        return StepResult::Error;
+    }
+
+    evt.tick = cursor.tick;
+    evt.message = MidiEvent(status,
+                            static_cast<uint8_t>(p[0] & 0x7f),
+                            numDataBytes > 1 ? static_cast<uint8_t>(p[1] & 0x7f) : 0,
+                            0);
+    p += numDataBytes;
+    return StepResult::ChannelEvent;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "StandardMidiFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * MidiFileReader
+ *
+ * Zero-copy Standard MIDI File reader.
+ * The file is memory-mapped and the track chunks are walked in place: every track has a cursor
+ * into the mapping, and next() merges the cursors by tick, decoding one variable-length delta and
+ * one channel message at a time straight into a MidiFileEvent. No event list is built.
+ *
+ * open() validates the whole file once (and collects the tempo map and length in ticks), so
+ * next() cannot run into malformed data later. Sysex and meta events other than tempo/end-of-track
+ * are skipped. Events with equal ticks are returned in track order.
+ *
+ * Usage:
+ *   MidiFileReader reader;
+ *   if (!reader.open("in.mid", error)) { ... }
+ *   MidiFileEvent evt;
+ *   while (reader.next(evt)) { ... }
+ */
+class MidiFileReader {
+private:
+    struct TrackCursor {
+        const uint8_t* begin = nullptr;     // First byte of the track chunk body
+        const uint8_t* pos = nullptr;       // Next unread byte
+        const uint8_t* end = nullptr;       // One past the chunk body
+        uint32_t tick = 0;                  // Absolute tick of the last decoded event
+        uint8_t runningStatus = 0;
+        bool hasPending = false;            // pending holds the next channel event of this track
+        MidiFileEvent pending;
+    };
+
+    enum class StepResult {
+        ChannelEvent,
+        Tempo,
+        Other,
+        EndOfTrack,
+        Error
+    };
+
+    MappedFile mapping;
+    std::vector<TrackCursor> tracks;
+    std::vector<TempoChange> tempoMap;
+    int format = 1;
+    int ticksPerQuarter = 480;
+    uint32_t lengthInTicks = 0;
+
+public:
+    /**
+     * Memory-map and validate a file
+     * @return false on I/O or format errors (error describes the problem)
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * Validate an in-memory SMF image (not copied: must outlive the reader)
+     * @return false on format errors (error describes the problem)
+     */
+    bool openMemory(const uint8_t* data, size_t size, std::string& error);
+
+    /**
+     * Restart reading from the first event
+     */
+    void rewind();
+
+    /**
+     * Read the next channel event (time-ordered across all tracks)
+     * @return false when all tracks are exhausted
+     */
+    bool next(MidiFileEvent& evt);
+
+    int getFormat() const noexcept {
+        return format;
+    }
+    int getTicksPerQuarter() const noexcept {
+        return ticksPerQuarter;
+    }
+    uint32_t getLengthInTicks() const noexcept {
+        return lengthInTicks;
+    }
+    size_t getNumTracks() const noexcept {
+        return tracks.size();
+    }
+    const std::vector<TempoChange>& getTempoMap() const noexcept {
+        return tempoMap;
+    }
+
+private:
+    static StepResult step(TrackCursor& cursor, MidiFileEvent& evt, uint32_t& tempo, const char*& error);
+    static void prefetch(TrackCursor& cursor);
+};
@@ -0,0 +1,185 @@
+#include "MidiFileWriter.h"
+
+bool MidiFileWriter::open(const std::string& path, int ticksPerQuarter, const std::vector<TempoChange>& tempoMap, std::string& error)
+{
+    abandon();
+
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        error = "cannot create " + path;
+        return false;
+    }
+    // We do our own buffering
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    buffer.clear();
+    trackBytes = 0;
+    totalBytes = 0;
+    lastTick = 0;
+    writeFailed = false;
+
+    // Header: format 1, tempo track + event track
+    for (char c : {'M', 'T', 'h', 'd'}) {
+        put(static_cast<uint8_t>(c));
+    }
+    putBigEndian(6, 4);
+    putBigEndian(1, 2);
+    putBigEndian(2, 2);
+    putBigEndian(static_cast<uint32_t>(ticksPerQuarter), 2);
+
+    // Tempo track: 7 bytes per tempo change + end-of-track, length known up front
+    uint32_t tempoTrackLength = 4;
+    {
+        uint32_t previous = 0;
+        for (const auto& tempo : tempoMap) {
+            tempoTrackLength += deltaLength(tempo.tick - previous) + 6;
+            previous = tempo.tick;
+        }
+    }
+    for (char c : {'M', 'T', 'r', 'k'}) {
+        put(static_cast<uint8_t>(c));
+    }
+    putBigEndian(tempoTrackLength, 4);
+    uint32_t previous = 0;
+    for (const auto& tempo : tempoMap) {
+        putDelta(tempo.tick - previous);
+        previous = tempo.tick;
+        put(0xff);
+        put(0x51);
+        put(0x03);
+        putBigEndian(tempo.microsecondsPerQuarter, 3);
+    }
+    putVariableLength(0);
+    put(0xff);
+    put(0x2f);
+    put(0x00);
+
+    // Event track header; length is patched in close()
+    for (char c : {'M', 'T', 'r', 'k'}) {
+        put(static_cast<uint8_t>(c));
+    }
+    trackLengthOffset = static_cast<long>(getBytesWritten());
+    putBigEndian(0, 4);
+    trackBytes = 0;
+    return true;
+}
+
+void MidiFileWriter::write(const MidiFileEvent& evt)
+{
+    const uint32_t tick = evt.tick < lastTick ? lastTick : evt.tick;
+    const uint64_t before = getBytesWritten();
+
+    putDelta(tick - lastTick);
+    lastTick = tick;
+
+    const uint8_t* raw = evt.message.getRawData();
+    for (int i = 0; i < evt.message.getRawDataSize(); ++i) {
+        put(raw[i]);
+    }
+
+    trackBytes += getBytesWritten() - before;
+}
+
+bool MidiFileWriter::close(uint32_t lengthInTicks, std::string& error)
+{
+    if (file == nullptr) {
+        error = "writer is not open";
+        return false;
+    }
+
+    const uint64_t before = getBytesWritten();
+    putDelta(lengthInTicks > lastTick ? lengthInTicks - lastTick : 0);
+    put(0xff);
+    put(0x2f);
+    put(0x00);
+    trackBytes += getBytesWritten() - before;
+    flush();
+
+    uint8_t length[4];
+    for (int i = 0; i < 4; ++i) {
+        length[i] = static_cast<uint8_t>((trackBytes >> (8 * (3 - i))) & 0xff);
+    }
+    if (std::fseek(file, trackLengthOffset, SEEK_SET) != 0 || std::fwrite(length, 1, 4, file) != 4) {
+        writeFailed = true;
+    }
+
+    if (std::fclose(file) != 0) {
+        writeFailed = true;
+    }
+    file = nullptr;
+
+    if (writeFailed) {
+        error = "write failed";
+        return false;
+    }
+    return true;
+}
+
+uint32_t MidiFileWriter::deltaLength(uint32_t delta)
+{
+    uint32_t length = 0;
+    while (delta > maxDelta) {
+        length += 4 + 3;
+        delta -= maxDelta;
+    }
+    length += 1;
+    while (delta >>= 7) {
+        ++length;
+    }
+    return length;
+}
+
+void MidiFileWriter::putDelta(uint32_t delta)
+{
+    // A variable-length quantity holds at most 28 bits: longer gaps are bridged with empty text
+    // events (FF 01 00), which players ignore
+    while (delta > maxDelta) {
+        putVariableLength(maxDelta);
+        put(0xff);
+        put(0x01);
+        put(0x00);
+        delta -= maxDelta;
+    }
+    putVariableLength(delta);
+}
+
+void MidiFileWriter::putVariableLength(uint32_t value)
+{
+    uint8_t bytes[4];
+    int count = 0;
+    do {
+        bytes[count++] = static_cast<uint8_t>(value & 0x7f);
+        value >>= 7;
+    } while (value != 0 && count < 4);
+
+    while (count > 1) {
+        put(static_cast<uint8_t>(bytes[--count] | 0x80));
+    }
+    put(bytes[0]);
+}
+
+void MidiFileWriter::putBigEndian(uint32_t value, int numBytes)
+{
+    for (int i = numBytes - 1; i >= 0; --i) {
+        put(static_cast<uint8_t>((value >> (8 * i)) & 0xff));
+    }
+}
+
+void MidiFileWriter::flush()
+{
+    if (file != nullptr && !buffer.empty()) {
+        if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            writeFailed = true;
+        }
+    }
+    totalBytes += buffer.size();
+    buffer.clear();
+}
+
+void MidiFileWriter::abandon() noexcept
+{
+    if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    buffer.clear();
+}
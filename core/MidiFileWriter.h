@@ -0,0 +1,86 @@
+#pragma once
+
+#include "StandardMidiFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * MidiFileWriter
+ *
+ * Buffered streaming Standard MIDI File writer (format 1: tempo track + one event track).
+ * Events are encoded straight into a fixed-size buffer that is flushed in large chunks;
+ * the event track length is patched in on close(), so the output never has to be held in memory.
+ *
+ * Usage:
+ *   MidiFileWriter writer;
+ *   if (!writer.open("out.mid", ticksPerQuarter, tempoMap, error)) { ... }
+ *   for (...) writer.write(evt);   // events in tick order
+ *   writer.close(lengthInTicks, error);
+ */
+class MidiFileWriter {
+private:
+    static constexpr size_t bufferCapacity = 64 * 1024;
+    static constexpr uint32_t maxDelta = 0x0fffffff; // Largest delta time a variable-length quantity holds
+
+    std::FILE* file = nullptr;
+    std::vector<uint8_t> buffer;
+    long trackLengthOffset = 0;       // File offset of the event track's length field
+    uint64_t trackBytes = 0;          // Bytes of the event track body written so far
+    uint64_t totalBytes = 0;
+    uint32_t lastTick = 0;
+    bool writeFailed = false;
+
+public:
+    MidiFileWriter() {
+        buffer.reserve(bufferCapacity);
+    }
+    ~MidiFileWriter() {
+        abandon();
+    }
+
+    MidiFileWriter(const MidiFileWriter&) = delete;
+    MidiFileWriter& operator=(const MidiFileWriter&) = delete;
+
+    /**
+     * Create the file, write header and tempo track and start the event track
+     * @return false if the file cannot be created
+     */
+    bool open(const std::string& path, int ticksPerQuarter, const std::vector<TempoChange>& tempoMap, std::string& error);
+
+    /**
+     * Append an event. Events must be passed in tick order (earlier ticks are clamped); a gap
+     * longer than a delta time holds (2^28 - 1 ticks) is bridged with empty text events.
+     */
+    void write(const MidiFileEvent& evt);
+
+    /**
+     * Terminate the event track, patch its length and close the file
+     * @param lengthInTicks End-of-track position (at least the last event's tick)
+     * @return false if any write failed
+     */
+    bool close(uint32_t lengthInTicks, std::string& error);
+
+    /**
+     * Bytes written to the file so far (including buffered bytes)
+     */
+    uint64_t getBytesWritten() const noexcept {
+        return totalBytes + buffer.size();
+    }
+
+private:
+    void put(uint8_t byte) {
+        if (buffer.size() == bufferCapacity) {
+            flush();
+        }
+        buffer.push_back(byte);
+    }
+    void putDelta(uint32_t delta);                 // Delta time, split by filler events if too large
+    static uint32_t deltaLength(uint32_t delta);   // Bytes putDelta() writes
+    void putVariableLength(uint32_t value);        // At most maxDelta
+    void putBigEndian(uint32_t value, int numBytes);
+    void flush();
+    void abandon() noexcept;
+};
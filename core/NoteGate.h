@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+/**
+ * How long generated notes last
+ */
+enum class GateMode {
+    Follow,     // Until the rhythm trigger's note-off (default)
+    Fixed,      // A fixed musical length per trigger
+    Ratchet     // Ratchets notes spread evenly over the fixed length
+};
+
+/**
+ * NoteGate
+ *
+ * Gate settings of the coordinator's generated notes. With Fixed and Ratchet the length is
+ * tempo-synced (in quarters at the tempo of the trigger) and the trigger's own note-off is
+ * ignored, so drum pads sending very short notes still play full-length notes.
+ * The note-offs and repeats are scheduled sample-accurately across blocks (see EventScheduler).
+ *
+ * Usage:
+ *   NoteGate gate;
+ *   gate.mode = GateMode::Ratchet;
+ *   gate.lengthQuarters = 0.5;             // Eighth note
+ *   gate.ratchets = 3;
+ *   coordinator.setNoteGate(gate);
+ */
+struct NoteGate {
+    static constexpr int maxRatchets = 8;
+    static constexpr double minLengthQuarters = 1.0 / 64.0;
+    static constexpr double maxLengthQuarters = 64.0;
+
+    GateMode mode = GateMode::Follow;
+    double lengthQuarters = 0.25;          // Fixed/Ratchet: length per trigger (default 1/16)
+    int ratchets = 2;                      // Ratchet: notes per trigger (1..maxRatchets)
+    double ratchetGate = 0.5;              // Ratchet: sounding part of each repeat (0..1]
+
+    int getNumNotes() const noexcept {
+        if (mode == GateMode::Ratchet) {
+            return ratchets < 1 ? 1 : ratchets > maxRatchets ? maxRatchets : ratchets;
+        }
+        return 1;
+    }
+
+    /**
+     * Note onsets and lengths in samples relative to the trigger (Fixed/Ratchet)
+     * @return Number of notes (getNumNotes())
+     */
+    int plan(double samplesPerQuarter, long long onsets[maxRatchets], long long lengths[maxRatchets]) const noexcept {
+        const double quarters = lengthQuarters < minLengthQuarters ? minLengthQuarters
+                              : lengthQuarters > maxLengthQuarters ? maxLengthQuarters : lengthQuarters;
+        const double total = quarters * samplesPerQuarter;
+        const int numNotes = getNumNotes();
+        const double slot = total / numNotes;
+        const double gate = mode == GateMode::Ratchet ? (ratchetGate <= 0.0 ? 0.0 : ratchetGate > 1.0 ? 1.0 : ratchetGate) : 1.0;
+        for (int i = 0; i < numNotes; ++i) {
+            onsets[i] = std::llround(i * slot);
+            const long long next = std::llround((i + 1) * slot);
+            const long long length = std::llround(slot * gate);
+            lengths[i] = length < 1 ? 1 : length > next - onsets[i] ? next - onsets[i] : length;
+        }
+        return numNotes;
+    }
+
+    /**
+     * Parse a note length: "1/16", "3/8", "1/8t" (triplet), "1/4." (dotted) or quarters ("0.5")
+     * @return false if malformed or out of range
+     */
+    static bool parseLength(const std::string& text, double& quarters) {
+        const char* begin = text.c_str();
+        char* end = nullptr;
+        const double numerator = std::strtod(begin, &end);
+        if (end == begin || numerator <= 0.0) {
+            return false;
+        }
+        double value = numerator;
+        if (*end == '/') {
+            const char* denominatorText = end + 1;
+            const long denominator = std::strtol(denominatorText, &end, 10);
+            if (end == denominatorText || denominator <= 0) {
+                return false;
+            }
+            value = 4.0 * numerator / static_cast<double>(denominator);
+        }
+        if (*end == 't') {
+            value *= 2.0 / 3.0;
+            ++end;
+        } else if (*end == '.') {
+            value *= 1.5;
+            ++end;
+        }
+        if (*end != '\0' || value < minLengthQuarters || value > maxLengthQuarters) {
+            return false;
+        }
+        quarters = value;
+        return true;
+    }
+
+    /**
+     * Parse "follow", "fixed" or "ratchet"
+     */
+    static bool parseMode(const std::string& text, GateMode& mode) {
+        if (text == "follow") {
+            mode = GateMode::Follow;
+        } else if (text == "fixed") {
+            mode = GateMode::Fixed;
+        } else if (text == "ratchet") {
+            mode = GateMode::Ratchet;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
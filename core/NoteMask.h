@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * NoteMask
+ *
+ * Set of MIDI note numbers (0-127) in two 64-bit words. Union, difference and comparison are a
+ * few bitwise instructions, so note sets (held keys, pedal-sustained notes, sounding pitches) can
+ * be diffed without searching note lists. forEach visits the notes in ascending order.
+ *
+ * Usage:
+ *   NoteMask held;
+ *   held.set(60);
+ *   held.set(64);
+ *   const NoteMask released = before & ~held;
+ *   released.forEach([&](int note) { ... });
+ */
+struct NoteMask {
+    uint64_t words[2] {};
+
+    void set(int note) noexcept { words[(note >> 6) & 1] |= 1ULL << (note & 63); }
+    void reset(int note) noexcept { words[(note >> 6) & 1] &= ~(1ULL << (note & 63)); }
+    bool test(int note) const noexcept { return ((words[(note >> 6) & 1] >> (note & 63)) & 1) != 0; }
+
+    // Clears the note; true if it was set
+    bool take(int note) noexcept {
+        const bool present = test(note);
+        reset(note);
+        return present;
+    }
+
+    void clear() noexcept {
+        words[0] = 0;
+        words[1] = 0;
+    }
+
+    bool any() const noexcept { return (words[0] | words[1]) != 0; }
+
+    int count() const noexcept { return popCount(words[0]) + popCount(words[1]); }
+
+    // Lowest / highest note in the set, -1 if empty
+    int lowest() const noexcept {
+        return words[0] != 0 ? countTrailingZeros(words[0]) : words[1] != 0 ? 64 + countTrailingZeros(words[1]) : -1;
+    }
+    int highest() const noexcept {
+        return words[1] != 0 ? 127 - countLeadingZeros(words[1]) : words[0] != 0 ? 63 - countLeadingZeros(words[0]) : -1;
+    }
+
+    /**
+     * Call callback(int note) for each note in the set, lowest first
+     */
+    template<typename Callback>
+    void forEach(Callback&& callback) const {
+        for (int word = 0; word < 2; ++word) {
+            for (uint64_t bits = words[word]; bits != 0; bits &= bits - 1) {
+                callback((word << 6) + countTrailingZeros(bits));
+            }
+        }
+    }
+
+    NoteMask operator|(const NoteMask& other) const noexcept { return { { words[0] | other.words[0], words[1] | other.words[1] } }; }
+    NoteMask operator&(const NoteMask& other) const noexcept { return { { words[0] & other.words[0], words[1] & other.words[1] } }; }
+    NoteMask operator^(const NoteMask& other) const noexcept { return { { words[0] ^ other.words[0], words[1] ^ other.words[1] } }; }
+    NoteMask operator~() const noexcept { return { { ~words[0], ~words[1] } }; }
+    NoteMask& operator|=(const NoteMask& other) noexcept { return *this = *this | other; }
+    NoteMask& operator&=(const NoteMask& other) noexcept { return *this = *this & other; }
+
+    bool operator==(const NoteMask& other) const noexcept { return words[0] == other.words[0] && words[1] == other.words[1]; }
+    bool operator!=(const NoteMask& other) const noexcept { return !(*this == other); }
+
+private:
+    static int countTrailingZeros(uint64_t bits) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(bits);
+#else
+        int bit = 0;
+        while ((bits & 1) == 0) {
+            bits >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    static int countLeadingZeros(uint64_t bits) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(bits);
+#else
+        int bit = 0;
+        while ((bits & (1ULL << 63)) == 0) {
+            bits <<= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    static int popCount(uint64_t bits) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(bits);
+#else
+        int count = 0;
+        for (; bits != 0; bits &= bits - 1) {
+            ++count;
+        }
+        return count;
+#endif
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+
+/**
+ * Order in which a strum plays the chord notes
+ */
+enum class StrumDirection {
+    Up,         // Lowest note first
+    Down,       // Highest note first
+    Alternate   // Up, down, up, ... on successive strums
+};
+
+/**
+ * NoteStrum
+ *
+ * A rhythm key that plays the whole current chord as a strum instead of one chord index.
+ * The note-ons are spread evenly over a tempo-synced time (first to last note). Part of the spread
+ * can come before the trigger (anticipation), so the strum's centre or end lands on the grid;
+ * that needs lookahead, i.e. the coordinator's latency (ChordPatternCoordinator::setLatencySamples),
+ * which caps how early a strum may begin.
+ *
+ * All strummed notes belong to the strum key: its note-off (or a fixed gate) ends them together,
+ * but never before the last note of the strum has started.
+ *
+ * Usage:
+ *   NoteStrum strum;
+ *   strum.key = 12;                        // Rhythm key root + 12 strums
+ *   strum.direction = StrumDirection::Down;
+ *   strum.spreadQuarters = 0.125;          // 1/32 from first to last note
+ *   strum.anticipation = 0.5;              // Centred on the grid
+ *   coordinator.setStrum(strum);
+ *   coordinator.setLatencySamples(480);    // 10 ms lookahead at 48 kHz
+ */
+struct NoteStrum {
+    static constexpr int noKey = -128;
+    static constexpr int maxNotes = 16;            // Chord notes strummed (lowest first)
+    static constexpr double maxSpreadQuarters = 4.0;
+
+    int key = noKey;                       // Rhythm key relative to the root note, noKey = off
+    StrumDirection direction = StrumDirection::Up;
+    double spreadQuarters = 0.125;         // First to last note (default 1/32)
+    double anticipation = 0.5;             // Part of the spread before the trigger (0..1)
+
+    bool isEnabled() const noexcept { return key != noKey; }
+
+    /**
+     * Onset of the index-th note (in playing order) relative to the trigger, in samples.
+     * Negative onsets (anticipation) are limited to maxLeadSamples.
+     */
+    long long noteOffset(int index, int numNotes, double samplesPerQuarter, long long maxLeadSamples) const noexcept {
+        if (numNotes < 2) {
+            return 0;
+        }
+        const double quarters = spreadQuarters < 0.0 ? 0.0 : spreadQuarters > maxSpreadQuarters ? maxSpreadQuarters : spreadQuarters;
+        const double spread = quarters * samplesPerQuarter;
+        const double part = anticipation < 0.0 ? 0.0 : anticipation > 1.0 ? 1.0 : anticipation;
+        const long long wantedLead = std::llround(spread * part);
+        const long long lead = wantedLead < maxLeadSamples ? wantedLead : maxLeadSamples < 0 ? 0 : maxLeadSamples;
+        return std::llround(spread * index / (numNotes - 1)) - lead;
+    }
+
+    /**
+     * Parse "up", "down" or "alternate"
+     */
+    static bool parseDirection(const std::string& text, StrumDirection& direction) {
+        if (text == "up") {
+            direction = StrumDirection::Up;
+        } else if (text == "down") {
+            direction = StrumDirection::Down;
+        } else if (text == "alternate") {
+            direction = StrumDirection::Alternate;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
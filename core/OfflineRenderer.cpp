@@ -0,0 +1,176 @@
+#include "OfflineRenderer.h"
+#include "ChordNotesTracker.h"
+#include "ChordPatternCoordinator.h"
+#include "MidiFileReader.h"
+#include "MidiFileWriter.h"
+#include "PatternTracker.h"
+#include "TempoMap.h"
+#include "../lib/SyncGlobals.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+/**
+ * Shared render loop.
+ * nextInput(MidiFileEvent&) yields the input events in tick order (false at the end),
+ * emitOutput(const MidiFileEvent&) receives the generated events in tick order.
+ */
+template<typename NextInput, typename EmitOutput>
+void renderStream(const OfflineRenderSettings& settings,
+                  const std::vector<TempoChange>& tempoChanges,
+                  int ticksPerQuarter,
+                  uint32_t lengthInTicks,
+                  NextInput&& nextInput,
+                  EmitOutput&& emitOutput,
+                  OfflineRenderStats& stats)
+{
+    stats = OfflineRenderStats();
+
+    // Fresh engine per render (same wiring as the plugin)
+    CoordinatorSyncGlobals syncGlobals;
+    ChordNotesTracker chordTracker;
+    PatternTracker patternTracker(chordTracker);
+    ChordPatternCoordinator coordinator(chordTracker, patternTracker, settings.rhythmRootNote);
+    coordinator.setChordInputChannel(settings.chordInputChannel);
+    coordinator.setRhythmInputChannel(settings.rhythmInputChannel);
+    coordinator.setOutputChannel(settings.outputChannel);
+    coordinator.setNoteGate(settings.gate);
+    coordinator.setStrum(settings.strum);
+    const int graceSamples = static_cast<int>(std::lround(settings.chordGraceMs * settings.sampleRate / 1000.0));
+    coordinator.setLatencySamples(settings.latencySamples + graceSamples);
+    coordinator.setChordGraceSamples(graceSamples);
+    coordinator.setGrooveQuantize(settings.quantize);
+    coordinator.setChordSettleSamples(static_cast<int>(std::lround(settings.chordSettleMs * settings.sampleRate / 1000.0)));
+    coordinator.setChordLatch(settings.chordLatch);
+    coordinator.setChordFollow(settings.chordFollow);
+    coordinator.setOutputCleanup(settings.outputCleanup);
+    coordinator.setControlRouting(settings.controlRouting);
+    coordinator.setMaxVoices(settings.maxVoices);
+    coordinator.setVoiceSteal(settings.voiceSteal);
+    syncGlobals.getStaticListeners().bind(coordinator);
+    syncGlobals.updateSampleRate(settings.sampleRate);
+    coordinator.setBeatGrid(&syncGlobals.getBeatGrid());
+    if (settings.rhythmPattern) {
+        syncGlobals.setGridSubdivisionsPerQuarter(settings.rhythmPattern->table.linesPerQuarter);
+        coordinator.getRhythmGenerator().setStepTable(&settings.rhythmPattern->table);
+    }
+
+    const TempoMap tempoMap(tempoChanges, ticksPerQuarter, settings.sampleRate);
+    const int64_t blockSize = settings.blockSize > 0 ? settings.blockSize : 512;
+    const int64_t latency = coordinator.getLatencySamples();
+    const int64_t endSample = tempoMap.ticksToSamples(lengthInTicks) + latency;
+
+    std::vector<MidiEvent> blockEvents;
+    blockEvents.reserve(256);
+
+    auto collectOutput = [&](int64_t blockStart) {
+        for (const auto& evt : coordinator.getOutputEvents()) {
+            MidiFileEvent fileEvent;
+            // Latency compensation (an event a full delay line let out undelayed may fall before 0)
+            fileEvent.tick = tempoMap.samplesToTicks(std::max<int64_t>(blockStart + evt.samplePosition - latency, 0));
+            fileEvent.message = evt;
+            fileEvent.message.samplePosition = 0;
+            emitOutput(fileEvent);
+            ++stats.outputEvents;
+        }
+    };
+
+    TransportInfo transport;
+    transport.isValid = true;
+    transport.hasBpm = true;
+    transport.isPlaying = true;
+    transport.hasPpqPosition = true;
+
+    MidiFileEvent pending;
+    bool hasPending = nextInput(pending);
+    int64_t pendingSample = hasPending ? tempoMap.ticksToSamples(pending.tick) : 0;
+
+    int64_t blockStart = 0;
+    for (; blockStart <= endSample; blockStart += blockSize) {
+        const int64_t blockEnd = blockStart + blockSize;
+
+        blockEvents.clear();
+        while (hasPending && pendingSample < blockEnd) {
+            MidiEvent evt = pending.message;
+            evt.samplePosition = static_cast<int>(pendingSample - blockStart);
+            blockEvents.push_back(evt);
+
+            hasPending = nextInput(pending);
+            pendingSample = hasPending ? tempoMap.ticksToSamples(pending.tick) : 0;
+        }
+        stats.inputEvents += blockEvents.size();
+
+        transport.bpm = tempoMap.bpmAtSample(blockStart);
+        transport.ppqPosition = tempoMap.quartersAtSample(blockStart);
+        syncGlobals.updateDAWGlobals(static_cast<int>(blockSize), transport);
+        coordinator.processBlock(blockEvents.data(), blockEvents.size(), static_cast<int>(blockSize));
+        syncGlobals.finishRun(static_cast<int>(blockSize));
+        ++stats.blocks;
+
+        collectOutput(blockStart);
+    }
+
+    // Stop the transport: flushes all notes that are still playing
+    transport.isPlaying = false;
+    syncGlobals.updateDAWGlobals(static_cast<int>(blockSize), transport);
+    if (coordinator.takeStopFlush()) {
+        collectOutput(blockStart);
+    }
+    stats.removedEvents = coordinator.getOutputPeephole().getRemovedCount();
+    stats.stolenVoices = coordinator.getStolenVoiceCount();
+    syncGlobals.getStaticListeners().unbind<ChordPatternCoordinator>();
+}
+
+} // namespace
+
+void OfflineRenderer::render(const MidiFileData& input, MidiFileData& output, OfflineRenderStats& stats) const
+{
+    output = MidiFileData();
+    output.format = 1;
+    output.ticksPerQuarter = input.ticksPerQuarter;
+    output.tempoMap = input.tempoMap;
+    output.events.reserve(input.events.size());
+
+    size_t nextEvent = 0;
+    renderStream(settings, input.tempoMap, input.ticksPerQuarter, input.lengthInTicks,
+        [&](MidiFileEvent& evt) {
+            if (nextEvent >= input.events.size()) {
+                return false;
+            }
+            evt = input.events[nextEvent++];
+            return true;
+        },
+        [&](const MidiFileEvent& evt) { output.events.push_back(evt); },
+        stats);
+
+    output.lengthInTicks = output.events.empty() ? input.lengthInTicks
+                                                 : std::max(input.lengthInTicks, output.events.back().tick);
+}
+
+bool OfflineRenderer::renderFile(const std::string& inputPath, const std::string& outputPath,
+                                 OfflineRenderStats& stats, std::string& error) const
+{
+    MidiFileReader reader;
+    if (!reader.open(inputPath, error)) {
+        return false;
+    }
+
+    MidiFileWriter writer;
+    if (!writer.open(outputPath, reader.getTicksPerQuarter(), reader.getTempoMap(), error)) {
+        return false;
+    }
+
+    uint32_t lastTick = 0;
+    renderStream(settings, reader.getTempoMap(), reader.getTicksPerQuarter(), reader.getLengthInTicks(),
+        [&](MidiFileEvent& evt) { return reader.next(evt); },
+        [&](const MidiFileEvent& evt) {
+            writer.write(evt);
+            lastTick = std::max(lastTick, evt.tick);
+        },
+        stats);
+
+    return writer.close(std::max(reader.getLengthInTicks(), lastTick), error);
+}
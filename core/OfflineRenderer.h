@@ -0,0 +1,125 @@
+#pragma once
+
+#include "ControlRouting.h"
+#include "GrooveQuantize.h"
+#include "NoteGate.h"
+#include "NoteStrum.h"
+#include "OutputPeephole.h"
+#include "PatternCompiler.h"
+#include "StandardMidiFile.h"
+#include "VoicePool.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Settings for an offline render (simulated host)
+ */
+struct OfflineRenderSettings {
+    double sampleRate = 48000.0;
+    int blockSize = 512;                 // Simulated audio block size (samples)
+    int rhythmRootNote = 24;             // C1
+    int chordInputChannel = 1;
+    int rhythmInputChannel = 16;
+    int outputChannel = 2;
+
+    // Built-in rhythm (compiled pattern, see PatternCompiler); nullptr = rhythm only from the input file
+    std::shared_ptr<const CompiledPattern> rhythmPattern;
+
+    // Length of the generated notes (default: follow the rhythm note-offs)
+    NoteGate gate;
+
+    // Strum key (default: off) and the engine's lookahead in samples. The output is shifted back
+    // by the latency, as a host compensating for it would.
+    NoteStrum strum;
+    int latencySamples = 0;
+
+    // Groove quantize of rhythm triggers (default: off); late triggers need latencySamples
+    GrooveQuantize quantize;
+
+    // Chord settle window in milliseconds (0 = chord input applies at once)
+    double chordSettleMs = 0.0;
+
+    // Late-chord grace window in milliseconds; added to the latency (and compensated like it)
+    double chordGraceMs = 0.0;
+
+    // Chord notes stay until the next chord starts (chord latch)
+    bool chordLatch = false;
+
+    // Held notes move to the new chord on a chord change (legato chord follow)
+    bool chordFollow = false;
+
+    // Redundant note events removed from the output (see OutputPeephole)
+    OutputCleanup outputCleanup = OutputCleanup::Off;
+
+    // CC, pitch bend and aftertouch of the inputs passed on to the output (default: consumed)
+    ControlRouting controlRouting;
+
+    // Polyphony cap (0 = off) and the note it steals
+    int maxVoices = 0;
+    VoiceSteal voiceSteal = VoiceSteal::Oldest;
+};
+
+/**
+ * Counters of one offline render
+ */
+struct OfflineRenderStats {
+    size_t inputEvents = 0;              // Channel messages fed into the coordinator
+    size_t outputEvents = 0;             // Generated events written to the output
+    size_t blocks = 0;                   // Simulated processBlock calls
+    size_t removedEvents = 0;            // Events dropped by output cleanup
+    size_t stolenVoices = 0;             // Notes ended by the polyphony cap
+};
+
+/**
+ * OfflineRenderer
+ *
+ * Runs ChordPatternCoordinator over a MIDI file faster than real time.
+ * Ticks are converted to samples via the file's tempo map, the event stream is cut into
+ * simulated blocks of settings.blockSize samples (as a host would deliver it), and the
+ * generated events are converted back to ticks. The transport plays from the first sample
+ * to the end of the file (plus the latency) and is then stopped, so hanging notes are flushed.
+ *
+ * Each call uses fresh engine state, so the result only depends on the input and the settings
+ * (deterministic, safe to run several renderers on different threads).
+ *
+ * Usage:
+ *   OfflineRenderer renderer(settings);
+ *   OfflineRenderStats stats;
+ *
+ *   // In memory
+ *   MidiFileData generated;
+ *   renderer.render(input, generated, stats);
+ *
+ *   // File to file, streaming (memory-mapped reader, buffered writer)
+ *   renderer.renderFile("in.mid", "out.mid", stats, error);
+ */
+class OfflineRenderer {
+private:
+    OfflineRenderSettings settings;
+
+public:
+    explicit OfflineRenderer(const OfflineRenderSettings& settingsToUse)
+        : settings(settingsToUse) {}
+
+    const OfflineRenderSettings& getSettings() const noexcept {
+        return settings;
+    }
+
+    /**
+     * Render the generated output track of a file
+     * @param input Parsed input file (chord and rhythm channels)
+     * @param output Receives the generated events (same time division and tempo map as the input)
+     * @param stats Receives event/block counters
+     */
+    void render(const MidiFileData& input, MidiFileData& output, OfflineRenderStats& stats) const;
+
+    /**
+     * Render a file to a file without materializing the event lists.
+     * The input is memory-mapped and walked in place, the output is streamed through a buffered writer.
+     * @return false on I/O or format errors (error describes the problem)
+     */
+    bool renderFile(const std::string& inputPath, const std::string& outputPath,
+                    OfflineRenderStats& stats, std::string& error) const;
+};
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "MidiEvent.h"
+#include "NoteMask.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * What the output peephole pass does (see OutputPeephole)
+ */
+enum class OutputCleanup {
+    Off,        // Output as generated
+    Clean,      // Drop redundant note events, keep retriggers (note-off + note-on of a sounding pitch)
+    Legato      // Clean, and a retrigger of a sounding pitch is dropped (the note just goes on)
+};
+
+/**
+ * OutputPeephole
+ *
+ * Final pass over a block's output events (sorted by sample position) that removes note events a
+ * synth does not need, for slow links such as 5-pin DIN MIDI (about 1000 events per second):
+ * - note-offs for pitches that are not sounding (duplicates, e.g. from overlapping triggers)
+ * - a note-on cancelled by a note-off at the same sample
+ * - with Legato, a note-off + note-on of a sounding pitch at the same sample (retrigger)
+ *
+ * Events at the same sample come out in a fixed order: note-offs, other messages, note-ons, then
+ * polyphonic aftertouch (each in generated order). A retrigger always reaches the synth as
+ * note-off, then note-on, and aftertouch reaches a note started at its sample (as generated).
+ *
+ * The sounding state is kept per channel across blocks (NoteMask per channel); it only knows the
+ * events that went through process(), so reset() it when notes are ended some other way (e.g. a
+ * transport stop flush). A note-on for a pitch that is already sounding counts it once, so
+ * overlapping notes of one pitch are ended by their first note-off. No allocation after reserve().
+ *
+ * Usage:
+ *   OutputPeephole peephole;
+ *   peephole.reserve(maxEventsPerBlock);
+ *   peephole.setCleanup(OutputCleanup::Legato);
+ *   peephole.process(outputEvents);          // Per block, in place
+ */
+class OutputPeephole {
+private:
+    static constexpr uint16_t none = 0xffff;
+    static constexpr size_t numKeys = 16 * 128;
+
+    OutputCleanup cleanup = OutputCleanup::Off;
+    std::array<NoteMask, 16> sounding {};  // Pitches on (per channel) after the events so far
+
+    // Per (channel, pitch) while a same-sample group is resolved: indices into the group
+    std::array<NoteMask, 16> inGroup {};
+    std::array<uint16_t, numKeys> firstOff {};
+    std::array<uint16_t, numKeys> lastOff {};
+    std::array<uint16_t, numKeys> lastOn {};
+    std::vector<MidiEvent> group;          // Copy of the group being reordered
+
+    size_t removedNoteOffs = 0;
+    size_t removedNoteOns = 0;
+    size_t mergedRetriggers = 0;
+
+    static bool isNoteEvent(const MidiEvent& evt) noexcept { return evt.isNoteOn() || evt.isNoteOff(); }
+    static size_t keyOf(const MidiEvent& evt) noexcept {
+        return static_cast<size_t>((evt.getChannel() - 1) * 128 + evt.getNoteNumber());
+    }
+
+    // Single event at its sample (the common case)
+    bool keepSingle(const MidiEvent& evt) noexcept {
+        NoteMask& channel = sounding[static_cast<size_t>(evt.getChannel() - 1)];
+        if (evt.isNoteOn()) {
+            channel.set(evt.getNoteNumber());
+        } else if (evt.isNoteOff() && !channel.take(evt.getNoteNumber())) {
+            ++removedNoteOffs;
+            return false;
+        }
+        return true;
+    }
+
+    // Events [begin, end) share a sample: decide per pitch what goes out, write it from out on
+    size_t resolveGroup(std::vector<MidiEvent>& events, size_t begin, size_t end, size_t out) {
+        group.assign(events.begin() + static_cast<std::ptrdiff_t>(begin), events.begin() + static_cast<std::ptrdiff_t>(end));
+        const uint16_t size = static_cast<uint16_t>(group.size());
+
+        for (uint16_t i = 0; i < size; ++i) {
+            const MidiEvent& evt = group[i];
+            if (!isNoteEvent(evt)) {
+                continue;
+            }
+            const size_t key = keyOf(evt);
+            NoteMask& seen = inGroup[static_cast<size_t>(evt.getChannel() - 1)];
+            if (!seen.test(evt.getNoteNumber())) {
+                seen.set(evt.getNoteNumber());
+                firstOff[key] = none;
+                lastOff[key] = none;
+                lastOn[key] = none;
+            }
+            if (evt.isNoteOn()) {
+                lastOn[key] = i;
+            } else {
+                firstOff[key] = firstOff[key] == none ? i : firstOff[key];
+                lastOff[key] = i;
+            }
+        }
+
+        // Per pitch (once, at its first event): the note-off (firstOff) and note-on (lastOn) that
+        // go out, none = dropped
+        for (uint16_t i = 0; i < size; ++i) {
+            const MidiEvent& evt = group[i];
+            if (!isNoteEvent(evt) || !inGroup[static_cast<size_t>(evt.getChannel() - 1)].take(evt.getNoteNumber())) {
+                continue;
+            }
+            const size_t key = keyOf(evt);
+            NoteMask& channel = sounding[static_cast<size_t>(evt.getChannel() - 1)];
+            const bool wasOn = channel.test(evt.getNoteNumber());
+            const bool endsOn = lastOn[key] != none && (lastOff[key] == none || lastOn[key] > lastOff[key]);
+            if (endsOn) {
+                // (any note-off of the pitch in the group comes before its last note-on)
+                if (!wasOn) {
+                    // Off before a fresh note-on: nothing to end
+                    firstOff[key] = none;
+                } else if (cleanup == OutputCleanup::Legato) {
+                    // Retrigger (or repeated note-on) of a sounding pitch: it just goes on
+                    if (firstOff[key] != none) {
+                        ++mergedRetriggers;
+                    }
+                    firstOff[key] = none;
+                    lastOn[key] = none;
+                }
+                channel.set(evt.getNoteNumber());
+            } else {
+                // Ends off: one note-off if it was sounding, note-ons in between are cancelled
+                firstOff[key] = wasOn ? firstOff[key] : none;
+                lastOn[key] = none;
+                channel.reset(evt.getNoteNumber());
+            }
+        }
+
+        // Note-offs, other messages, note-ons, polyphonic aftertouch
+        for (uint16_t i = 0; i < size; ++i) {
+            if (group[i].isNoteOff()) {
+                if (firstOff[keyOf(group[i])] == i) {
+                    events[out++] = group[i];
+                } else {
+                    ++removedNoteOffs;
+                }
+            }
+        }
+        for (uint16_t i = 0; i < size; ++i) {
+            if (!isNoteEvent(group[i]) && !group[i].isAftertouch()) {
+                events[out++] = group[i];
+            }
+        }
+        for (uint16_t i = 0; i < size; ++i) {
+            if (group[i].isNoteOn()) {
+                if (lastOn[keyOf(group[i])] == i) {
+                    events[out++] = group[i];
+                } else {
+                    ++removedNoteOns;
+                }
+            }
+        }
+        for (uint16_t i = 0; i < size; ++i) {
+            if (group[i].isAftertouch()) {
+                events[out++] = group[i];
+            }
+        }
+        return out;
+    }
+
+public:
+    /**
+     * Room for the largest group of events at one sample (call outside the audio thread)
+     */
+    void reserve(size_t maxEvents) {
+        group.reserve(maxEvents < none ? maxEvents : none);
+    }
+
+    void setCleanup(OutputCleanup cleanupToUse) noexcept { cleanup = cleanupToUse; }
+    OutputCleanup getCleanup() const noexcept { return cleanup; }
+
+    /**
+     * Clean up a block's events in place (sorted by samplePosition). With Off the events are
+     * left as they are; the sounding state is still tracked, so cleanup can be turned on while
+     * notes play without losing their note-offs.
+     */
+    void process(std::vector<MidiEvent>& events) {
+        if (cleanup == OutputCleanup::Off) {
+            for (const auto& evt : events) {
+                if (evt.isNoteOn()) {
+                    sounding[static_cast<size_t>(evt.getChannel() - 1)].set(evt.getNoteNumber());
+                } else if (evt.isNoteOff()) {
+                    sounding[static_cast<size_t>(evt.getChannel() - 1)].reset(evt.getNoteNumber());
+                }
+            }
+            return;
+        }
+        const size_t count = events.size();
+        size_t out = 0;
+        for (size_t begin = 0; begin < count;) {
+            size_t end = begin + 1;
+            while (end < count && end - begin < none && events[end].samplePosition == events[begin].samplePosition) {
+                ++end;
+            }
+            if (end - begin == 1) {
+                if (keepSingle(events[begin])) {
+                    events[out++] = events[begin];
+                }
+            } else {
+                out = resolveGroup(events, begin, end, out);
+            }
+            begin = end;
+        }
+        events.resize(out);
+    }
+
+    /**
+     * Forget the sounding notes (all notes were ended outside process())
+     */
+    void reset() noexcept {
+        sounding.fill(NoteMask());
+    }
+
+    bool isSounding(int channel, int noteNumber) const noexcept {
+        return sounding[static_cast<size_t>((channel - 1) & 15)].test(noteNumber);
+    }
+
+    // Events removed (only note events are), and the retriggers Legato merged (each removed a
+    // note-off and a note-on)
+    size_t getRemovedCount() const noexcept { return removedNoteOffs + removedNoteOns; }
+    size_t getRemovedNoteOffCount() const noexcept { return removedNoteOffs; }
+    size_t getRemovedNoteOnCount() const noexcept { return removedNoteOns; }
+    size_t getMergedRetriggerCount() const noexcept { return mergedRetriggers; }
+
+    /**
+     * Parse "off", "clean" or "legato"
+     */
+    static bool parseCleanup(const std::string& text, OutputCleanup& cleanupOut) {
+        if (text == "off") {
+            cleanupOut = OutputCleanup::Off;
+        } else if (text == "clean") {
+            cleanupOut = OutputCleanup::Clean;
+        } else if (text == "legato") {
+            cleanupOut = OutputCleanup::Legato;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "PatternCompiler.h"
+#include "../lib/SpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * PatternCompileWorker
+ *
+ * Compiles rhythm pattern text on its own thread and hands the step table to the audio thread,
+ * so editing a pattern never parses or allocates inside processBlock:
+ *
+ * 1. submit() (message thread) stores the text and wakes the worker. Submissions are coalesced:
+ *    only the latest text is compiled.
+ * 2. The worker compiles it. A good table is published through an atomic pointer; an error is
+ *    kept in the status for the editor, and the previous table stays in use.
+ * 3. update() (audio thread, once per block) swaps the published table in and hands the old one
+ *    back to the worker for deletion via a lock-free queue (same scheme as BeatBuffers). It does
+ *    not signal the worker (a condition variable notify can be a syscall); the worker polls.
+ *
+ * Usage:
+ *   PatternCompileWorker patterns;
+ *   patterns.submit("0: x . x x | E(3,8)");                // message thread
+ *
+ *   // processBlock, before updateDAWGlobals:
+ *   if (patterns.update()) {
+ *       const StepTable* table = patterns.getActive();
+ *       syncGlobals.setGridSubdivisionsPerQuarter(table->linesPerQuarter);
+ *       coordinator.getRhythmGenerator().setStepTable(table);
+ *   }
+ *
+ *   // Editor timer:
+ *   PatternCompileWorker::Status status = patterns.getStatus();
+ */
+class PatternCompileWorker {
+public:
+    /**
+     * Result of the latest compilation (message thread view)
+     */
+    struct Status {
+        unsigned generation = 0;         // Submission the status belongs to (0 = nothing compiled yet)
+        bool ok = true;
+        std::string error;               // Compiler message if !ok
+        int numLanes = 0;                // Of the last good table
+        int numLines = 0;
+        int linesPerQuarter = 0;
+    };
+
+private:
+    // Request (message thread -> worker)
+    std::mutex requestLock;
+    std::string requestedText;
+    std::atomic<unsigned> requestGeneration { 0 };
+
+    // Worker -> message thread
+    mutable std::mutex statusLock;
+    Status status;
+
+    // Worker -> audio: newest good pattern (nullptr once taken)
+    std::atomic<CompiledPattern*> ready { nullptr };
+
+    // Audio -> worker: replaced patterns to delete
+    SpscQueue<CompiledPattern*, 16> retired;
+
+    // Audio thread only
+    CompiledPattern* active = nullptr;
+
+    std::atomic<size_t> compileCount { 0 };
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::atomic<bool> stopping { false };
+    std::thread worker;
+
+    static constexpr auto pollInterval = std::chrono::milliseconds(10);
+
+    void freeRetired() {
+        CompiledPattern* old = nullptr;
+        while (retired.pop(old)) {
+            delete old;
+        }
+    }
+
+    void run() {
+        unsigned compiledGeneration = 0;
+        while (!stopping.load(std::memory_order_acquire)) {
+            {
+                std::unique_lock<std::mutex> lock(wakeLock);
+                wake.wait_for(lock, pollInterval, [&]() {
+                    return stopping.load(std::memory_order_acquire)
+                        || requestGeneration.load(std::memory_order_acquire) != compiledGeneration
+                        || retired.front() != nullptr;
+                });
+            }
+            freeRetired();
+
+            std::string text;
+            unsigned generation = 0;
+            {
+                std::lock_guard<std::mutex> lock(requestLock);
+                generation = requestGeneration.load(std::memory_order_relaxed);
+                if (generation == compiledGeneration || stopping.load(std::memory_order_acquire)) {
+                    continue;
+                }
+                text = requestedText;
+            }
+            compiledGeneration = generation;
+
+            auto* pattern = new CompiledPattern();
+            std::string error;
+            const bool ok = PatternCompiler::compile(text, *pattern, error);
+            compileCount.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(statusLock);
+                status.generation = generation;
+                status.ok = ok;
+                status.error = error;
+                if (ok) {
+                    status.numLanes = pattern->table.numLanes;
+                    status.numLines = pattern->table.numLines;
+                    status.linesPerQuarter = pattern->table.linesPerQuarter;
+                }
+            }
+            if (!ok) {
+                delete pattern;
+                continue;
+            }
+            // A pattern the audio thread has not picked up yet is superseded: take it back and delete it
+            delete ready.exchange(pattern, std::memory_order_acq_rel);
+        }
+    }
+
+public:
+    PatternCompileWorker()
+        : worker([this]() { run(); }) {}
+
+    ~PatternCompileWorker() {
+        stopping.store(true, std::memory_order_release);
+        wake.notify_one();
+        worker.join();
+        freeRetired();
+        delete ready.exchange(nullptr);
+        delete active;
+    }
+
+    PatternCompileWorker(const PatternCompileWorker&) = delete;
+    PatternCompileWorker& operator=(const PatternCompileWorker&) = delete;
+
+    /**
+     * Queue pattern text for compilation (any thread except the audio thread)
+     * @return Generation of this submission (compare with Status::generation)
+     */
+    unsigned submit(const std::string& text) {
+        unsigned generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(requestLock);
+            requestedText = text;
+            generation = requestGeneration.load(std::memory_order_relaxed) + 1;
+            requestGeneration.store(generation, std::memory_order_release);
+        }
+        wake.notify_one();
+        return generation;
+    }
+
+    /**
+     * Latest compilation result (message thread)
+     */
+    Status getStatus() const {
+        std::lock_guard<std::mutex> lock(statusLock);
+        return status;
+    }
+
+    /**
+     * Number of compilations run so far (good or not)
+     */
+    size_t getCompileCount() const noexcept { return compileCount.load(std::memory_order_relaxed); }
+
+    /**
+     * Audio thread, once per block: install a newly compiled table. Wait-free.
+     * @return true if getActive() changed in this call
+     */
+    bool update() noexcept {
+        if (ready.load(std::memory_order_relaxed) == nullptr) {
+            return false;
+        }
+        // The old table goes back to the worker; if its queue is full, keep the old one one more block
+        if (active != nullptr && !retired.push(active)) {
+            return false;
+        }
+        // No notify here: the worker frees the old table within its poll interval
+        active = ready.exchange(nullptr, std::memory_order_acq_rel);
+        return true;
+    }
+
+    /**
+     * Table in use (audio thread), nullptr until the first good compilation
+     */
+    const StepTable* getActive() const noexcept { return active != nullptr ? &active->table : nullptr; }
+};
@@ -0,0 +1,403 @@
+#include "PatternCompiler.h"
+#include "../lib/BeatGrid.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+struct ParsedStep {
+    uint8_t velocity = 0;                // 0 = rest (unless tie)
+    uint8_t ratchet = 1;
+    bool tie = false;
+};
+
+struct ParsedLane {
+    int key = 0;
+    int lineNumber = 0;
+    long long lengthNum = 1;             // Step length in quarter notes: lengthNum / lengthDen
+    long long lengthDen = 4;
+    std::vector<ParsedStep> steps;
+};
+
+long long gcd(long long a, long long b) noexcept {
+    while (b != 0) {
+        const long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+long long lcm(long long a, long long b) noexcept {
+    return a / gcd(a, b) * b;
+}
+
+/**
+ * Recursive-descent parser for one lane ("KEY: ITEMS [/DIVISION]").
+ * Errors name the line and column of the offending character.
+ */
+class LaneParser {
+private:
+    const std::string& text;
+    size_t pos;
+    const size_t end;
+    const size_t lineStart;
+    const int lineNumber;
+    std::string& error;
+
+    bool fail(const std::string& message) {
+        error = "line " + std::to_string(lineNumber) + ", column " + std::to_string(pos - lineStart + 1) + ": " + message;
+        return false;
+    }
+
+    bool atEnd() const noexcept { return pos >= end; }
+    char peek() const noexcept { return atEnd() ? '\0' : text[pos]; }
+
+    void skipSpace() noexcept {
+        while (!atEnd() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '|')) {
+            ++pos;
+        }
+    }
+
+    bool expect(char c) {
+        skipSpace();
+        if (peek() != c) {
+            return fail(std::string("expected '") + c + "'");
+        }
+        ++pos;
+        return true;
+    }
+
+    bool parseInt(int& value) {
+        skipSpace();
+        const size_t start = pos;
+        if (peek() == '-' || peek() == '+') {
+            ++pos;
+        }
+        long long parsed = 0;
+        const size_t digits = pos;
+        while (!atEnd() && text[pos] >= '0' && text[pos] <= '9') {
+            parsed = std::min(parsed * 10 + (text[pos] - '0'), 1000000LL);
+            ++pos;
+        }
+        if (pos == digits) {
+            pos = start;
+            return fail("expected a number");
+        }
+        value = static_cast<int>(text[start] == '-' ? -parsed : parsed);
+        return true;
+    }
+
+    bool push(std::vector<ParsedStep>& steps, const ParsedStep& step) {
+        if (static_cast<int>(steps.size()) >= PatternCompiler::maxStepsPerLane) {
+            return fail("more than " + std::to_string(PatternCompiler::maxStepsPerLane) + " steps");
+        }
+        steps.push_back(step);
+        return true;
+    }
+
+    bool parseEuclid(std::vector<ParsedStep>& steps) {
+        ++pos; // 'E'
+        int hits = 0;
+        int length = 0;
+        int rotation = 0;
+        if (!expect('(') || !parseInt(hits) || !expect(',') || !parseInt(length)) {
+            return false;
+        }
+        skipSpace();
+        if (peek() == ',') {
+            ++pos;
+            if (!parseInt(rotation)) {
+                return false;
+            }
+        }
+        if (!expect(')')) {
+            return false;
+        }
+        if (length < 1 || length > PatternCompiler::maxStepsPerLane || hits < 0 || hits > length) {
+            return fail("Euclidean rhythm needs 0 <= hits <= steps, got E(" + std::to_string(hits) + "," + std::to_string(length) + ")");
+        }
+        rotation = ((rotation % length) + length) % length;
+        for (int i = 0; i < length; ++i) {
+            // Bresenham spread: step j is a hit if (j * hits) mod length < hits
+            const long long j = (i + rotation) % length;
+            ParsedStep step;
+            step.velocity = (j * hits) % length < hits ? 100 : 0;
+            if (!push(steps, step)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseItem(std::vector<ParsedStep>& steps) {
+        const size_t first = steps.size();
+        const char c = peek();
+        ParsedStep step;
+
+        if (c == 'x' || c == 'X' || c == 'o') {
+            ++pos;
+            step.velocity = c == 'X' ? 127 : (c == 'x' ? 100 : 60);
+            if (peek() == '*') {
+                ++pos;
+                int ratchet = 0;
+                if (!parseInt(ratchet)) {
+                    return false;
+                }
+                if (ratchet < 1 || ratchet > PatternCompiler::maxRatchet) {
+                    return fail("ratchet must be 1.." + std::to_string(PatternCompiler::maxRatchet));
+                }
+                step.ratchet = static_cast<uint8_t>(ratchet);
+            }
+            if (!push(steps, step)) {
+                return false;
+            }
+        } else if (c == '.' || c == '-') {
+            ++pos;
+            if (!push(steps, step)) {
+                return false;
+            }
+        } else if (c == '_') {
+            if (steps.empty() || (steps.back().velocity == 0 && !steps.back().tie)) {
+                return fail("tie '_' needs a note before it");
+            }
+            ++pos;
+            step.tie = true;
+            if (!push(steps, step)) {
+                return false;
+            }
+        } else if (c == '[') {
+            ++pos;
+            if (!parseItems(steps, true)) {
+                return false;
+            }
+        } else if (c == 'E') {
+            if (!parseEuclid(steps)) {
+                return false;
+            }
+        } else {
+            return fail(std::string("unexpected '") + c + "'");
+        }
+
+        if (peek() == '!') {
+            ++pos;
+            int count = 0;
+            if (!parseInt(count)) {
+                return false;
+            }
+            if (count < 1) {
+                return fail("repeat count must be at least 1");
+            }
+            const size_t itemEnd = steps.size();
+            for (int r = 1; r < count; ++r) {
+                for (size_t i = first; i < itemEnd; ++i) {
+                    if (!push(steps, steps[i])) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    bool parseItems(std::vector<ParsedStep>& steps, bool inGroup) {
+        for (;;) {
+            skipSpace();
+            if (atEnd() || (!inGroup && peek() == '/')) {
+                return inGroup ? fail("missing ']'") : true;
+            }
+            if (peek() == ']') {
+                if (!inGroup) {
+                    return fail("unexpected ']'");
+                }
+                ++pos;
+                return true;
+            }
+            if (!parseItem(steps)) {
+                return false;
+            }
+        }
+    }
+
+public:
+    LaneParser(const std::string& textToParse, size_t begin, size_t segmentEnd, size_t lineBegin, int line, std::string& errorOut)
+        : text(textToParse), pos(begin), end(segmentEnd), lineStart(lineBegin), lineNumber(line), error(errorOut) {}
+
+    /**
+     * @param lane Receives the lane; lane.steps stays empty for a blank segment
+     */
+    bool parse(ParsedLane& lane) {
+        lane.lineNumber = lineNumber;
+        skipSpace();
+        if (atEnd()) {
+            return true;
+        }
+        if (!parseInt(lane.key)) {
+            return false;
+        }
+        if (lane.key < -127 || lane.key > 127) {
+            return fail("rhythm key must be -127..127");
+        }
+        if (!expect(':') || !parseItems(lane.steps, false)) {
+            return false;
+        }
+        if (lane.steps.empty()) {
+            return fail("lane has no steps");
+        }
+
+        int division = 16;
+        bool triplet = false;
+        if (peek() == '/') {
+            ++pos;
+            if (!parseInt(division)) {
+                return false;
+            }
+            if (division != 1 && division != 2 && division != 4 && division != 8 && division != 16 && division != 32 && division != 64) {
+                return fail("division must be 1, 2, 4, 8, 16, 32 or 64");
+            }
+            if (peek() == 't') {
+                ++pos;
+                triplet = true;
+            }
+            skipSpace();
+            if (!atEnd()) {
+                return fail(std::string("unexpected '") + peek() + "' after the division");
+            }
+        }
+        lane.lengthNum = triplet ? 8 : 4;
+        lane.lengthDen = triplet ? division * 3 : division;
+        const long long divisor = gcd(lane.lengthNum, lane.lengthDen);
+        lane.lengthNum /= divisor;
+        lane.lengthDen /= divisor;
+        return true;
+    }
+};
+
+} // namespace
+
+bool PatternCompiler::compile(const std::string& text, CompiledPattern& pattern, std::string& error)
+{
+    std::vector<ParsedLane> lanes;
+
+    // Physical lines; '#' comments run to the end of the line; ';' separates lanes within a line
+    size_t lineStart = 0;
+    for (int lineNumber = 1; lineStart <= text.size(); ++lineNumber) {
+        size_t lineEnd = text.find('\n', lineStart);
+        lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+        const size_t comment = text.find('#', lineStart);
+        const size_t contentEnd = comment < lineEnd ? comment : lineEnd;
+
+        size_t segmentStart = lineStart;
+        while (segmentStart <= contentEnd) {
+            size_t segmentEnd = text.find(';', segmentStart);
+            segmentEnd = segmentEnd < contentEnd ? segmentEnd : contentEnd;
+
+            ParsedLane lane;
+            LaneParser parser(text, segmentStart, segmentEnd, lineStart, lineNumber, error);
+            if (!parser.parse(lane)) {
+                return false;
+            }
+            if (!lane.steps.empty()) {
+                if (static_cast<int>(lanes.size()) == StepTable::maxLanes) {
+                    error = "line " + std::to_string(lineNumber) + ": more than " + std::to_string(StepTable::maxLanes) + " lanes";
+                    return false;
+                }
+                lanes.push_back(std::move(lane));
+            }
+            segmentStart = segmentEnd + 1;
+        }
+        lineStart = lineEnd + 1;
+    }
+
+    CompiledPattern compiled;
+    if (lanes.empty()) {
+        pattern = std::move(compiled);
+        return true;
+    }
+
+    // Grid resolution: every step and every ratchet hit must start on a line
+    long long linesPerQuarter = 1;
+    for (const ParsedLane& lane : lanes) {
+        bool used[maxRatchet + 1] = {};
+        for (const ParsedStep& step : lane.steps) {
+            used[step.ratchet] = true;
+        }
+        for (long long ratchet = 1; ratchet <= maxRatchet; ++ratchet) {
+            if (!used[ratchet]) {
+                continue;
+            }
+            const long long hitDen = lane.lengthDen * ratchet;
+            linesPerQuarter = lcm(linesPerQuarter, hitDen / gcd(lane.lengthNum, hitDen));
+            if (linesPerQuarter > BeatGrid::maxSubdivisionsPerQuarter) {
+                error = "line " + std::to_string(lane.lineNumber) + ": needs a grid of " + std::to_string(linesPerQuarter)
+                    + " lines per quarter (max " + std::to_string(BeatGrid::maxSubdivisionsPerQuarter)
+                    + "); mix fewer triplet and ratchet divisions";
+                return false;
+            }
+        }
+    }
+
+    // Cycle: LCM of the lane lengths (polymeter)
+    long long numLines = 1;
+    std::vector<long long> laneLines(lanes.size());
+    for (size_t l = 0; l < lanes.size(); ++l) {
+        laneLines[l] = static_cast<long long>(lanes[l].steps.size()) * linesPerQuarter * lanes[l].lengthNum / lanes[l].lengthDen;
+        const long long cycle = lcm(numLines, laneLines[l]);
+        if (cycle > maxTableLines) {
+            error = "line " + std::to_string(lanes[l].lineNumber) + ": pattern cycle of " + std::to_string(cycle)
+                + " grid lines is longer than " + std::to_string(maxTableLines) + "; use lane lengths with common factors";
+            return false;
+        }
+        numLines = cycle;
+    }
+
+    StepTable& table = compiled.table;
+    table.linesPerQuarter = static_cast<int>(linesPerQuarter);
+    table.numLines = static_cast<int>(numLines);
+    table.numLanes = static_cast<int>(lanes.size());
+    compiled.cells.assign(static_cast<size_t>(numLines) * lanes.size(), StepCell());
+
+    std::vector<StepCell> laneCells;
+    for (size_t l = 0; l < lanes.size(); ++l) {
+        const ParsedLane& lane = lanes[l];
+        const long long length = laneLines[l];
+        const long long stepLines = linesPerQuarter * lane.lengthNum / lane.lengthDen;
+        table.keys[l] = lane.key;
+
+        // Resolve steps to note starts and releases in lane-local lines
+        laneCells.assign(static_cast<size_t>(length), StepCell());
+        bool noteOpen = false;
+        long long line = 0;
+        for (const ParsedStep& step : lane.steps) {
+            if (step.tie) {
+                line += stepLines;
+                continue;
+            }
+            if (noteOpen) {
+                laneCells[static_cast<size_t>(line)].release = 1;
+                noteOpen = false;
+            }
+            if (step.velocity > 0) {
+                const long long hitLines = stepLines / step.ratchet;
+                for (long long hit = 0; hit < step.ratchet; ++hit) {
+                    StepCell& cell = laneCells[static_cast<size_t>(line + hit * hitLines)];
+                    cell.velocity = step.velocity;
+                    cell.release = hit > 0 ? 1 : cell.release;
+                }
+                noteOpen = true;
+            }
+            line += stepLines;
+        }
+        if (noteOpen) {
+            laneCells[0].release = 1;    // The last note ends where the lane starts over
+        }
+
+        for (long long row = 0; row < numLines; ++row) {
+            compiled.cells[static_cast<size_t>(row) * lanes.size() + l] = laneCells[static_cast<size_t>(row % length)];
+        }
+    }
+
+    table.cells = compiled.cells.data();
+    pattern = std::move(compiled);
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * What one lane does at one grid line of a compiled pattern
+ */
+struct StepCell {
+    uint8_t velocity = 0;                // Note-on velocity, 0 = no note starts here
+    uint8_t release = 0;                 // 1 = the lane's previous note ends here (before a new one starts)
+};
+
+/**
+ * Compiled rhythm pattern: one row of numLanes cells per grid line, numLines rows per cycle.
+ * A view: the cells live in a CompiledPattern or in a memory-mapped preset bank, immutable once
+ * built. Playback reads row (line index mod numLines).
+ */
+struct StepTable {
+    static constexpr int maxLanes = 8;
+
+    int linesPerQuarter = 4;             // Grid resolution the table was compiled for
+    int numLines = 0;                    // Cycle length in grid lines (LCM of the lane lengths)
+    int numLanes = 0;
+    int keys[maxLanes] = {};             // Rhythm key per lane, relative to the root note
+    const StepCell* cells = nullptr;     // numLines * numLanes, row-major
+
+    const StepCell* row(long long lineIndex) const noexcept {
+        long long r = lineIndex % numLines;
+        r += r < 0 ? numLines : 0;
+        return cells + static_cast<size_t>(r) * static_cast<size_t>(numLanes);
+    }
+};
+
+/**
+ * A StepTable together with the storage of its cells (compiler output)
+ */
+struct CompiledPattern {
+    StepTable table;
+    std::vector<StepCell> cells;
+
+    CompiledPattern() = default;
+    CompiledPattern(CompiledPattern&&) = default;             // Vector storage moves along, table.cells stays valid
+    CompiledPattern& operator=(CompiledPattern&&) = default;
+    CompiledPattern(const CompiledPattern&) = delete;
+    CompiledPattern& operator=(const CompiledPattern&) = delete;
+};
+
+/**
+ * PatternCompiler
+ *
+ * Compiles the rhythm pattern text into a step table, so playback needs no parsing and no per-feature
+ * logic: every step, tie, ratchet, Euclidean fill and polymeter is resolved here into note starts
+ * and releases on a common grid.
+ *
+ * One lane per line (or separated by ';'), '#' starts a comment:
+ *
+ *   KEY: ITEMS [/DIVISION]
+ *
+ *   KEY        rhythm key relative to the root note (-127..127)
+ *   x X o      hit with velocity 100, accent 127, ghost 60
+ *   . -        rest
+ *   _          tie: the previous note lasts one more step
+ *   x*3        ratchet: 3 equal hits within the step (2..8)
+ *   E(5,8,2)   Euclidean: 5 hits spread over 8 steps, rotated left by 2 (rotation optional)
+ *   [x . x]    group
+ *   ITEM!4     repeat an item (step, group or Euclidean) 4 times
+ *   |          ignored (bar separator for readability)
+ *   DIVISION   step length: 1 2 4 8 16 32 64, optional 't' for triplets (default 16)
+ *
+ * Lanes of different lengths loop independently (polymeter); the table cycle is the LCM of the
+ * lane lengths. The grid resolution is the smallest one that puts every step and ratchet hit on a
+ * grid line (at most BeatGrid::maxSubdivisionsPerQuarter).
+ *
+ * Usage:
+ *   CompiledPattern pattern;
+ *   std::string error;
+ *   if (!PatternCompiler::compile("0: x . x x*2 | E(3,8) /16\n12: X _ . . /8t", pattern, error)) {
+ *       ... error is "line 1, column 12: ..." ...
+ *   }
+ */
+class PatternCompiler {
+public:
+    static constexpr int maxStepsPerLane = 1024;
+    static constexpr int maxRatchet = 8;
+    static constexpr int maxTableLines = 4096;
+
+    /**
+     * Compile pattern text (any thread but the audio thread: allocates).
+     * Empty text (or only comments) compiles to a table without lanes.
+     * @return false on syntax or size errors (error says where; pattern is left unchanged)
+     */
+    static bool compile(const std::string& text, CompiledPattern& pattern, std::string& error);
+};
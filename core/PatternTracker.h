@@ -0,0 +1,405 @@
+#pragma once
+
+#include "ChordNotesTracker.h"
+#include "MidiEvent.h"
+#include "NoteMask.h"
+#include "VoicePool.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * PatternTracker
+ * 
+ * Manages pattern playback by tracking which chord notes are currently playing.
+ * Handles the mapping between rhythm patterns and chord notes.
+ * 
+ * Key responsibilities:
+ * - Track currently playing notes from the chord
+ * - Start/stop notes with octave offsets
+ * - Compute chord index and octave offset from rhythm patterns
+ * - Keep the playing notes in a VoicePool by age, to pick the one a polyphony cap steals
+ * 
+ * Usage Pattern:
+ *   ChordNotesTracker chordTracker;
+ *   PatternTracker patternTracker(chordTracker);
+ *   
+ *   // Start playing chord notes
+ *   patternTracker.startPlayingNote(0, 12);  // Play first chord note + octave
+ *   patternTracker.stopPlayingNote(0, 12);   // Stop first chord note + octave
+ */
+class PatternTracker {
+public:
+    /**
+     * Represents a note that is currently playing
+     * Includes the octave offset applied when it was triggered
+     */
+    struct PlayingNote {
+        MidiEvent message;              // Note-on event containing note information
+        int originalChordIndex;         // Index in chord that triggered this (at note-on time)
+        int octaveOffset;               // Octave offset used when triggered (at note-on time)
+        int ownerRhythmNote;            // Rhythm input note number that owns this note (-1 if unknown)
+        int voice = -1;                 // Slot in the voice pool (-1 if it was full)
+        long long onTime = 0;           // Output time of its note-on (caller's sample clock, 0 = unknown)
+        
+        PlayingNote(const MidiEvent& msg,
+                    int chordIdx = -1,
+                    int octaveOffsetSemitones = 0,
+                    int rhythmOwnerNote = -1)
+            : message(msg)
+            , originalChordIndex(chordIdx)
+            , octaveOffset(octaveOffsetSemitones)
+            , ownerRhythmNote(rhythmOwnerNote)
+        {}
+        
+        // Helper methods for easy access
+        int getNoteNumber() const { return message.getNoteNumber(); }
+        int getVelocity() const { return message.getVelocity(); }
+        int getChannel() const { return message.getChannel(); }
+    };
+
+private:
+    ChordNotesTracker& chordTracker;       // Reference to chord tracker
+    std::vector<PlayingNote> playingNotes; // Currently playing notes
+    size_t peakPlayingNotes = 0;           // High-water of playingNotes.size() (memory accounting)
+    VoicePool voices;                      // The playing notes by age (voice stealing)
+    std::array<uint16_t, VoicePool::capacity> noteOfVoice {}; // Voice slot -> index in playingNotes
+
+    // After playingNotes was compacted (the passes doing it are O(notes) anyway)
+    void reindexVoices() noexcept {
+        for (size_t i = 0; i < playingNotes.size(); ++i) {
+            if (playingNotes[i].voice >= 0) {
+                noteOfVoice[static_cast<size_t>(playingNotes[i].voice)] = static_cast<uint16_t>(i);
+            }
+        }
+    }
+    void indexLastVoice() noexcept {
+        const int voice = playingNotes.back().voice;
+        if (voice >= 0) {
+            noteOfVoice[static_cast<size_t>(voice)] = static_cast<uint16_t>(playingNotes.size() - 1);
+        }
+    }
+
+    // Pitch a note's chord index and octave give in the current chord, -1 if none
+    int chordPitchOf(const PlayingNote& playingNote) const noexcept {
+        const MidiEvent* chordNote = chordTracker.getChordNoteByIndex(playingNote.originalChordIndex);
+        if (chordNote == nullptr) {
+            return -1;
+        }
+        const int note = chordNote->getNoteNumber() + playingNote.octaveOffset;
+        return note >= 0 && note <= 127 ? note : -1;
+    }
+    
+public:
+    /**
+     * Constructor
+     * @param tracker Reference to the ChordNotesTracker
+     */
+    explicit PatternTracker(ChordNotesTracker& tracker)
+        : chordTracker(tracker) {}
+    
+    /**
+     * Preallocate room for maxNotes playing notes (call outside the audio thread)
+     */
+    void reserve(size_t maxNotes) {
+        playingNotes.reserve(maxNotes);
+    }
+
+    /**
+     * Get the number of notes currently playing
+     */
+    size_t getPlayingNotesCount() const {
+        return playingNotes.size();
+    }
+    
+    /**
+     * Largest number of simultaneously playing notes seen since construction
+     */
+    size_t getPeakPlayingNotesCount() const {
+        return peakPlayingNotes;
+    }
+    
+    /**
+     * Start playing a chord note with an octave offset
+     * Adds to the tracking list of currently playing notes
+     * 
+     * @param chordIndex Index in chord (0-based)
+     * @param octaveOffset Octave offset in semitones (typically multiples of 12)
+     * @return The actual MIDI note number being played, or -1 if chord index invalid
+     */
+    int startPlayingNote(int chordIndex, int octaveOffset = 0) {
+        const MidiEvent* chordNote = chordTracker.getChordNoteByIndex(chordIndex);
+        if (chordNote == nullptr) {
+            return -1;
+        }
+        
+        int actualNote = chordNote->getNoteNumber() + octaveOffset;
+        auto playingMessage = MidiEvent::noteOn(
+            2, 
+            actualNote, 
+            static_cast<uint8_t>(chordNote->getVelocity())
+        );
+        PlayingNote playingNote(playingMessage, chordIndex, octaveOffset, -1);
+        playingNote.voice = voices.add(actualNote, chordNote->getVelocity());
+        playingNotes.push_back(playingNote);
+        indexLastVoice();
+        peakPlayingNotes = std::max(peakPlayingNotes, playingNotes.size());
+        
+        return actualNote;
+    }
+
+    /**
+     * Start playing a note owned by a rhythm input note.
+     * This stores the concrete output note number so it can be stopped later even if the chord changes.
+     *
+     * @param rhythmNoteNumber Rhythm input note number (channel 16 note)
+     * @param actualNote Concrete output MIDI note number
+     * @param velocity Velocity to use for the note-on
+     * @param channel Output channel (default: 2)
+     * @param chordIndex Index in chord at note-on time (optional, for diagnostics)
+     * @param octaveOffset Octave offset at note-on time (optional, for diagnostics)
+     * @param onTime When the note-on leaves, if it is delayed (optional, e.g. a strum note)
+     */
+    void startPlayingRhythmOwnedNote(int rhythmNoteNumber,
+                                    int actualNote,
+                                    uint8_t velocity,
+                                    int channel = 2,
+                                    int chordIndex = -1,
+                                    int octaveOffset = 0,
+                                    long long onTime = 0) {
+        auto playingMessage = MidiEvent::noteOn(channel, actualNote, velocity);
+        playingNotes.emplace_back(playingMessage, chordIndex, octaveOffset, rhythmNoteNumber);
+        playingNotes.back().voice = voices.add(actualNote, velocity);
+        playingNotes.back().onTime = onTime;
+        indexLastVoice();
+        peakPlayingNotes = std::max(peakPlayingNotes, playingNotes.size());
+    }
+    
+    /**
+     * Stop playing note(s) with a specific chord index and octave offset
+     * Removes matching notes from the playing list
+     * 
+     * @param chordIndex Index in chord (0-based)
+     * @param octaveOffset Octave offset in semitones
+     * @return Number of notes stopped
+     */
+    int stopPlayingNote(int chordIndex, int octaveOffset = 0) {
+        // Remove all playing notes that were started with this chordIndex + octaveOffset.
+        // This is intentionally independent from the *current* chord state.
+        auto oldSize = playingNotes.size();
+        playingNotes.erase(
+            std::remove_if(playingNotes.begin(), playingNotes.end(),
+                [this, chordIndex, octaveOffset](const PlayingNote& pn) {
+                    if (pn.originalChordIndex != chordIndex || pn.octaveOffset != octaveOffset) {
+                        return false;
+                    }
+                    voices.remove(pn.voice);
+                    return true;
+                }),
+            playingNotes.end());
+        reindexVoices();
+        
+        return static_cast<int>(oldSize - playingNotes.size());
+    }
+
+    /**
+     * Stop all notes owned by a specific rhythm input note.
+     * Calls onStopped(const PlayingNote&) for each stopped note (so the caller can emit matching
+     * note-offs) and compacts the playing list in place - no allocation on the audio thread.
+     *
+     * @return Number of notes stopped
+     */
+    template<typename Callback>
+    int stopPlayingNotesForRhythmOwner(int rhythmNoteNumber, Callback&& onStopped) {
+        int stoppedCount = 0;
+        auto keep = playingNotes.begin();
+        for (auto it = playingNotes.begin(); it != playingNotes.end(); ++it) {
+            if (it->ownerRhythmNote == rhythmNoteNumber) {
+                onStopped(*it);
+                voices.remove(it->voice);
+                ++stoppedCount;
+            } else {
+                if (keep != it) {
+                    *keep = *it;
+                }
+                ++keep;
+            }
+        }
+        playingNotes.erase(keep, playingNotes.end());
+        reindexVoices();
+        return stoppedCount;
+    }
+    
+    /**
+     * Legato chord follow: move the playing notes selected by follows(const PlayingNote&) (notes
+     * of one channel, started with a chord index) to the pitch their chord index and octave give
+     * in the current chord; those whose index the chord no longer has end.
+     *
+     * Only pitches that change are sent. The old and new pitch sets are diffed (NoteMask):
+     * each pitch leaving the set gets one onNoteOff(const PlayingNote&) (a note that held it),
+     * each pitch joining it one onNoteOn(const PlayingNote&) (the note now holding it, pitch
+     * already updated). Pitches in both sets keep sounding, whichever note holds them now.
+     * Compacts the playing list in place - no allocation on the audio thread.
+     *
+     * @return Number of pitches that changed (note-offs plus note-ons)
+     */
+    template<typename Follows, typename NoteOff, typename NoteOn>
+    int followChord(Follows&& follows, NoteOff&& onNoteOff, NoteOn&& onNoteOn) {
+        auto isFollowing = [&](const PlayingNote& playingNote) {
+            return playingNote.originalChordIndex >= 0 && follows(playingNote);
+        };
+
+        NoteMask before;
+        NoteMask after;
+        for (const auto& playingNote : playingNotes) {
+            if (isFollowing(playingNote)) {
+                before.set(playingNote.getNoteNumber());
+                const int pitch = chordPitchOf(playingNote);
+                if (pitch >= 0) {
+                    after.set(pitch);
+                }
+            }
+        }
+        if (before == after) {
+            return 0;
+        }
+
+        NoteMask leaving = before & ~after;
+        NoteMask joining = after & ~before;
+        int changed = 0;
+        for (const auto& playingNote : playingNotes) {
+            if (isFollowing(playingNote) && leaving.take(playingNote.getNoteNumber())) {
+                onNoteOff(playingNote);
+                ++changed;
+            }
+        }
+
+        auto keep = playingNotes.begin();
+        for (auto it = playingNotes.begin(); it != playingNotes.end(); ++it) {
+            if (isFollowing(*it)) {
+                const int pitch = chordPitchOf(*it);
+                if (pitch < 0) {
+                    voices.remove(it->voice);
+                    continue;
+                }
+                it->message = MidiEvent::noteOn(it->getChannel(), pitch, static_cast<uint8_t>(it->getVelocity()));
+                voices.setPitch(it->voice, pitch);
+                if (joining.take(pitch)) {
+                    onNoteOn(*it);
+                    ++changed;
+                }
+            }
+            if (keep != it) {
+                *keep = *it;
+            }
+            ++keep;
+        }
+        playingNotes.erase(keep, playingNotes.end());
+        reindexVoices();
+        return changed;
+    }
+    
+    /**
+     * Stop all currently playing notes
+     * @return Number of notes that were playing
+     */
+    int stopAllPlayingNotes() {
+        int count = static_cast<int>(playingNotes.size());
+        playingNotes.clear();
+        voices.clear();
+        return count;
+    }
+
+    /**
+     * Stop the note the steal policy picks (see setVoiceSteal): calls onStolen(const PlayingNote&)
+     * for it (so the caller can emit its note-off) and removes it. O(1): the voice slot gives the
+     * note's index, and the last playing note takes its place (the playing list is not in age
+     * order; the voice pool is).
+     *
+     * @return false if no note can be stolen
+     */
+    template<typename Callback>
+    bool stealVoice(Callback&& onStolen) {
+        const int victim = voices.victim();
+        if (victim < 0) {
+            return false;
+        }
+        const size_t index = noteOfVoice[static_cast<size_t>(victim)];
+        onStolen(playingNotes[index]);
+        voices.remove(victim);
+        if (index + 1 != playingNotes.size()) {
+            playingNotes[index] = playingNotes.back();
+            if (playingNotes[index].voice >= 0) {
+                noteOfVoice[static_cast<size_t>(playingNotes[index].voice)] = static_cast<uint16_t>(index);
+            }
+        }
+        playingNotes.pop_back();
+        return true;
+    }
+
+    /**
+     * Which playing note stealVoice() stops (default: the oldest)
+     */
+    void setVoiceSteal(VoiceSteal steal) noexcept { voices.setSteal(steal); }
+    VoiceSteal getVoiceSteal() const noexcept { return voices.getSteal(); }
+    
+    /**
+     * Get all currently playing notes as note-off messages
+     * Useful for generating note-offs before clearing (e.g., when DAW stops)
+     * 
+     * @param channel MIDI channel for the note-off events (default: 2, the output channel)
+     * @return Vector of note-off MIDI events for all playing notes
+     */
+    std::vector<MidiEvent> getAllPlayingNotesAsNoteOffs(int channel = 2) const {
+        std::vector<MidiEvent> noteOffs;
+        noteOffs.reserve(playingNotes.size());
+        
+        for (const auto& playingNote : playingNotes) {
+            auto noteOff = MidiEvent::noteOff(
+                channel,
+                playingNote.getNoteNumber(),
+                static_cast<uint8_t>(playingNote.getVelocity())
+            );
+            noteOffs.push_back(noteOff);
+        }
+        
+        return noteOffs;
+    }
+    
+    /**
+     * Get all currently playing notes
+     */
+    const std::vector<PlayingNote>& getPlayingNotes() const {
+        return playingNotes;
+    }
+    
+    /**
+     * Compute chord note index from a rhythm note
+     * 
+     * @param rhythmNote MIDI note number from rhythm pattern
+     * @param rootNote Root note to calculate relative to (e.g., 24 for C1)
+     * @return Chord note index (0-based, 0-11)
+     */
+    static int computeChordIndex(int rhythmNote, int rootNote) {
+        int relativeNoteIndex = rhythmNote - rootNote;
+        int mod = relativeNoteIndex % 12;
+        if (mod < 0) {
+            mod += 12;
+        }
+        return mod;  // 0-based [0..11]
+    }
+    
+    /**
+     * Compute octave offset from a rhythm note
+     * 
+     * @param rhythmNote MIDI note number from rhythm pattern
+     * @param rootNote Root note to calculate relative to (e.g., 24 for C1)
+     * @return Octave offset in semitones (multiples of 12)
+     */
+    static int computeOctaveOffset(int rhythmNote, int rootNote) {
+        int relativeNoteIndex = rhythmNote - rootNote;
+        return static_cast<int>(std::floor(relativeNoteIndex / 12.0)) * 12;
+    }
+};
@@ -0,0 +1,300 @@
+#include "PresetBank.h"
+#include "../lib/BeatGrid.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char bankMagic[8] = { 'P', 'H', 'U', 'B', 'A', 'N', 'K', '1' };
+constexpr uint32_t bankVersion = 1;
+constexpr size_t headerSize = 24;
+
+// Record: name[32], routing (4 bytes) + hasKeyMap + 3 reserved, linesPerQuarter u16, numLanes u16,
+// numLines u32, keys int8[8], cellOffset u32, cellCount u32, key map (2 bytes per key)
+constexpr size_t recordSize = 32 + 8 + 8 + StepTable::maxLanes + 8 + sizeof(RhythmKeyMap);
+
+static_assert(sizeof(StepCell) == 2, "bank files store StepCell arrays as is");
+
+uint32_t readLittleEndian(const uint8_t* p, int numBytes) {
+    uint32_t value = 0;
+    for (int i = numBytes - 1; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+void appendLittleEndian(std::vector<uint8_t>& out, uint32_t value, int numBytes) {
+    for (int i = 0; i < numBytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+std::string trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// Whitespace-separated integers; false if a field is not a number or the count is outside [minCount, maxCount]
+bool parseInts(const std::string& text, int* values, int minCount, int maxCount, int& count) {
+    count = 0;
+    const char* p = text.c_str();
+    for (;;) {
+        while (*p == ' ' || *p == '\t') {
+            ++p;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char* end = nullptr;
+        const long parsed = std::strtol(p, &end, 10);
+        if (end == p || (*end != '\0' && *end != ' ' && *end != '\t') || count == maxCount) {
+            return false;
+        }
+        values[count++] = static_cast<int>(parsed);
+        p = end;
+    }
+    return count >= minCount;
+}
+
+bool isValidRouting(const PresetRouting& routing) {
+    auto isChannel = [](int channel) { return channel >= 1 && channel <= 16; };
+    return isChannel(routing.chordInputChannel) && isChannel(routing.rhythmInputChannel)
+        && isChannel(routing.outputChannel) && routing.rhythmRootNote >= 0 && routing.rhythmRootNote <= 127;
+}
+
+} // namespace
+
+bool PresetBank::open(const std::string& bankPath, std::string& error)
+{
+    presets.clear();
+    path = bankPath;
+    if (!file.open(bankPath, error)) {
+        return false;
+    }
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+
+    if (size < headerSize || std::memcmp(data, bankMagic, sizeof(bankMagic)) != 0) {
+        error = bankPath + " is not a phu-arp preset bank";
+        return false;
+    }
+    const uint32_t version = readLittleEndian(data + 8, 4);
+    const uint32_t numPresets = readLittleEndian(data + 12, 4);
+    const uint32_t storedRecordSize = readLittleEndian(data + 16, 4);
+    const uint32_t recordOffset = readLittleEndian(data + 20, 4);
+    if (version != bankVersion || storedRecordSize != recordSize) {
+        error = bankPath + ": unsupported bank version " + std::to_string(version);
+        return false;
+    }
+    if (numPresets == 0 || numPresets > static_cast<uint32_t>(maxPresets)
+        || recordOffset < headerSize || recordOffset > size || (size - recordOffset) / recordSize < numPresets) {
+        error = bankPath + ": bad preset table";
+        return false;
+    }
+
+    presets.resize(numPresets);
+    for (uint32_t i = 0; i < numPresets; ++i) {
+        const uint8_t* record = data + recordOffset + static_cast<size_t>(i) * recordSize;
+        BankPreset& preset = presets[i];
+        auto fail = [&](const char* what) {
+            error = bankPath + ": preset " + std::to_string(i) + " has " + what;
+            presets.clear();
+            return false;
+        };
+
+        std::memcpy(preset.name, record, 32);
+        preset.name[BankPreset::maxNameLength] = '\0';
+
+        preset.routing.chordInputChannel = record[32];
+        preset.routing.rhythmInputChannel = record[33];
+        preset.routing.outputChannel = record[34];
+        preset.routing.rhythmRootNote = record[35];
+        preset.hasKeyMap = record[36] != 0;
+        if (!isValidRouting(preset.routing)) {
+            return fail("bad routing");
+        }
+
+        StepTable& table = preset.pattern;
+        table.linesPerQuarter = static_cast<int>(readLittleEndian(record + 40, 2));
+        table.numLanes = static_cast<int>(readLittleEndian(record + 42, 2));
+        table.numLines = static_cast<int>(readLittleEndian(record + 44, 4));
+        for (int l = 0; l < StepTable::maxLanes; ++l) {
+            table.keys[l] = static_cast<int8_t>(record[48 + l]);
+        }
+        const uint32_t cellOffset = readLittleEndian(record + 48 + StepTable::maxLanes, 4);
+        const uint32_t cellCount = readLittleEndian(record + 52 + StepTable::maxLanes, 4);
+        if (table.linesPerQuarter < 1 || table.linesPerQuarter > BeatGrid::maxSubdivisionsPerQuarter
+            || table.numLanes < 0 || table.numLanes > StepTable::maxLanes
+            || table.numLines < 0 || table.numLines > PatternCompiler::maxTableLines
+            || (table.numLines == 0) != (table.numLanes == 0)
+            || cellCount != static_cast<uint32_t>(table.numLines) * static_cast<uint32_t>(table.numLanes)
+            || cellOffset > size || (size - cellOffset) / sizeof(StepCell) < cellCount) {
+            return fail("a bad pattern table");
+        }
+        table.cells = reinterpret_cast<const StepCell*>(data + cellOffset);
+        for (uint32_t c = 0; c < cellCount; ++c) {
+            if (table.cells[c].velocity > 127 || table.cells[c].release > 1) {
+                return fail("bad pattern cells");
+            }
+        }
+
+        std::memcpy(&preset.keyMap, record + 56 + StepTable::maxLanes, sizeof(RhythmKeyMap));
+        for (const RhythmKeyMap::Entry& entry : preset.keyMap.entries) {
+            if (entry.chordIndex != RhythmKeyMap::useDefault && (entry.chordIndex < 0 || entry.chordIndex > 11 || entry.octave < -8 || entry.octave > 8)) {
+                return fail("a bad key map");
+            }
+        }
+    }
+    return true;
+}
+
+bool PresetBank::write(const std::string& bankPath, const std::vector<PresetDefinition>& definitions, std::string& error)
+{
+    if (definitions.empty() || definitions.size() > static_cast<size_t>(maxPresets)) {
+        error = "a bank holds 1.." + std::to_string(maxPresets) + " presets";
+        return false;
+    }
+
+    std::vector<uint8_t> bytes(bankMagic, bankMagic + sizeof(bankMagic));
+    appendLittleEndian(bytes, bankVersion, 4);
+    appendLittleEndian(bytes, static_cast<uint32_t>(definitions.size()), 4);
+    appendLittleEndian(bytes, static_cast<uint32_t>(recordSize), 4);
+    appendLittleEndian(bytes, static_cast<uint32_t>(headerSize), 4);
+
+    size_t cellOffset = headerSize + definitions.size() * recordSize;
+    for (const PresetDefinition& definition : definitions) {
+        if (!isValidRouting(definition.routing)) {
+            error = "preset '" + definition.name + "' has bad routing";
+            return false;
+        }
+        const StepTable& table = definition.pattern.table;
+        const size_t cellCount = static_cast<size_t>(table.numLines) * static_cast<size_t>(table.numLanes);
+
+        char name[32] = {};
+        std::strncpy(name, definition.name.c_str(), BankPreset::maxNameLength);
+        bytes.insert(bytes.end(), name, name + sizeof(name));
+        bytes.push_back(static_cast<uint8_t>(definition.routing.chordInputChannel));
+        bytes.push_back(static_cast<uint8_t>(definition.routing.rhythmInputChannel));
+        bytes.push_back(static_cast<uint8_t>(definition.routing.outputChannel));
+        bytes.push_back(static_cast<uint8_t>(definition.routing.rhythmRootNote));
+        appendLittleEndian(bytes, definition.hasKeyMap ? 1 : 0, 4);
+        appendLittleEndian(bytes, static_cast<uint32_t>(table.linesPerQuarter), 2);
+        appendLittleEndian(bytes, static_cast<uint32_t>(table.numLanes), 2);
+        appendLittleEndian(bytes, static_cast<uint32_t>(table.numLines), 4);
+        for (int l = 0; l < StepTable::maxLanes; ++l) {
+            bytes.push_back(static_cast<uint8_t>(static_cast<int8_t>(table.keys[l])));
+        }
+        appendLittleEndian(bytes, static_cast<uint32_t>(cellOffset), 4);
+        appendLittleEndian(bytes, static_cast<uint32_t>(cellCount), 4);
+        const uint8_t* keyMap = reinterpret_cast<const uint8_t*>(&definition.keyMap);
+        bytes.insert(bytes.end(), keyMap, keyMap + sizeof(RhythmKeyMap));
+        cellOffset += cellCount * sizeof(StepCell);
+    }
+    for (const PresetDefinition& definition : definitions) {
+        const StepTable& table = definition.pattern.table;
+        const uint8_t* cells = reinterpret_cast<const uint8_t*>(table.cells);
+        bytes.insert(bytes.end(), cells, cells + static_cast<size_t>(table.numLines) * static_cast<size_t>(table.numLanes) * sizeof(StepCell));
+    }
+
+    std::FILE* out = std::fopen(bankPath.c_str(), "wb");
+    if (out == nullptr) {
+        error = "cannot create " + bankPath;
+        return false;
+    }
+    const bool written = std::fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+    if (std::fclose(out) != 0 || !written) {
+        error = "write failed: " + bankPath;
+        return false;
+    }
+    return true;
+}
+
+bool PresetBank::parseSource(const std::string& text, std::vector<PresetDefinition>& definitions, std::string& error)
+{
+    definitions.clear();
+    std::vector<std::string> patternTexts;
+
+    size_t lineStart = 0;
+    for (int lineNumber = 1; lineStart <= text.size(); ++lineNumber) {
+        size_t lineEnd = text.find('\n', lineStart);
+        lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        const size_t comment = line.find('#');
+        line = trim(comment == std::string::npos ? line : line.substr(0, comment));
+        if (line.empty()) {
+            continue;
+        }
+        const std::string where = "line " + std::to_string(lineNumber) + ": ";
+
+        if (line.front() == '[') {
+            if (line.back() != ']' || line.size() < 3 || line.size() - 2 > static_cast<size_t>(BankPreset::maxNameLength)) {
+                error = where + "preset header must be [Name] with 1.." + std::to_string(BankPreset::maxNameLength) + " characters";
+                return false;
+            }
+            definitions.emplace_back();
+            definitions.back().name = trim(line.substr(1, line.size() - 2));
+            patternTexts.emplace_back();
+            continue;
+        }
+        if (definitions.empty()) {
+            error = where + "expected a [Name] preset header first";
+            return false;
+        }
+        PresetDefinition& definition = definitions.back();
+
+        const size_t space = line.find_first_of(" \t");
+        const std::string keyword = line.substr(0, space);
+        const std::string rest = space == std::string::npos ? std::string() : trim(line.substr(space));
+        int values[3] = {};
+        int count = 0;
+
+        if (keyword == "pattern") {
+            patternTexts.back() += rest + "\n";
+        } else if (keyword == "channels") {
+            if (!parseInts(rest, values, 3, 3, count)) {
+                error = where + "expected 'channels CHORD RHYTHM OUTPUT'";
+                return false;
+            }
+            definition.routing.chordInputChannel = values[0];
+            definition.routing.rhythmInputChannel = values[1];
+            definition.routing.outputChannel = values[2];
+            if (!isValidRouting(definition.routing)) {
+                error = where + "channels must be 1..16";
+                return false;
+            }
+        } else if (keyword == "root") {
+            if (!parseInts(rest, values, 1, 1, count) || values[0] < 0 || values[0] > 127) {
+                error = where + "expected 'root NOTE' (0..127)";
+                return false;
+            }
+            definition.routing.rhythmRootNote = values[0];
+        } else if (keyword == "key") {
+            if (!parseInts(rest, values, 2, 3, count) || !definition.keyMap.set(values[0], values[1], count == 3 ? values[2] : 0)) {
+                error = where + "expected 'key KEY CHORD_INDEX [OCTAVE]' (key -64..63, index 0..11, octave -8..8)";
+                return false;
+            }
+            definition.hasKeyMap = true;
+        } else {
+            error = where + "unknown keyword '" + keyword + "'";
+            return false;
+        }
+    }
+
+    if (definitions.empty()) {
+        error = "no presets";
+        return false;
+    }
+    for (size_t i = 0; i < definitions.size(); ++i) {
+        if (!PatternCompiler::compile(patternTexts[i], definitions[i].pattern, error)) {
+            error = "preset '" + definitions[i].name + "' pattern " + error;
+            return false;
+        }
+    }
+    return true;
+}
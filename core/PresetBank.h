@@ -0,0 +1,110 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "PatternCompiler.h"
+#include "RhythmKeyMap.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * MIDI routing of a preset (same meaning as the ChordPatternCoordinator setters)
+ */
+struct PresetRouting {
+    int chordInputChannel = 1;
+    int rhythmInputChannel = 16;
+    int outputChannel = 2;
+    int rhythmRootNote = 24;
+};
+
+/**
+ * One preset of a loaded bank. The pattern cells point into the mapped bank file.
+ */
+struct BankPreset {
+    static constexpr int maxNameLength = 31;
+
+    char name[maxNameLength + 1] = {};
+    PresetRouting routing;
+    StepTable pattern;                   // numLanes == 0: preset without built-in rhythm
+    RhythmKeyMap keyMap;
+    bool hasKeyMap = false;
+};
+
+/**
+ * Builder input for one preset (see PresetBank::write)
+ */
+struct PresetDefinition {
+    std::string name;
+    PresetRouting routing;
+    CompiledPattern pattern;
+    RhythmKeyMap keyMap;
+    bool hasKeyMap = false;
+};
+
+/**
+ * PresetBank
+ *
+ * A bank file of precompiled presets (routing, rhythm key map, compiled rhythm pattern).
+ * open() memory-maps the file and validates every record once; the step tables are used in
+ * place from the mapping, so a bank of hundreds of patterns costs one small record per preset
+ * on the heap. After open() the bank is immutable and can be read from the audio thread.
+ *
+ * File layout (little endian): 24-byte header ("PHUBANK1", version, preset count, record size,
+ * record offset), fixed-size preset records, then the StepCell arrays the records point to.
+ * Banks are built from a text source with phu-arp-bank (see parseSource for the format).
+ *
+ * Usage:
+ *   PresetBank bank;
+ *   std::string error;
+ *   if (!bank.open("live.phubank", error)) { ... }
+ *   const BankPreset* preset = bank.get(12);
+ */
+class PresetBank {
+public:
+    static constexpr int maxPresets = 4096;
+
+private:
+    MappedFile file;
+    std::vector<BankPreset> presets;
+    std::string path;
+
+public:
+    PresetBank() = default;
+    PresetBank(const PresetBank&) = delete;
+    PresetBank& operator=(const PresetBank&) = delete;
+
+    /**
+     * Map and validate a bank file (message thread)
+     * @return false if the file is missing, malformed or has no presets (error describes the problem)
+     */
+    bool open(const std::string& bankPath, std::string& error);
+
+    int size() const noexcept { return static_cast<int>(presets.size()); }
+
+    /**
+     * Preset by program number, nullptr if out of range
+     */
+    const BankPreset* get(int index) const noexcept {
+        return index >= 0 && index < size() ? &presets[static_cast<size_t>(index)] : nullptr;
+    }
+
+    const std::string& getPath() const noexcept { return path; }
+
+    /**
+     * Write a bank file (tools, not realtime)
+     */
+    static bool write(const std::string& bankPath, const std::vector<PresetDefinition>& definitions, std::string& error);
+
+    /**
+     * Parse and compile a bank source text. One section per preset:
+     *
+     *   [Name]                        starts a preset (up to 31 characters)
+     *   channels CHORD RHYTHM OUTPUT  input/output channels (default 1 16 2)
+     *   root NOTE                     rhythm root note (default 24)
+     *   key KEY CHORD_INDEX [OCTAVE]  rhythm key override (see RhythmKeyMap)
+     *   pattern LANE                  one rhythm pattern lane (see PatternCompiler), repeatable
+     *
+     * '#' starts a comment. Errors name the source line (pattern errors: the preset).
+     */
+    static bool parseSource(const std::string& text, std::vector<PresetDefinition>& definitions, std::string& error);
+};
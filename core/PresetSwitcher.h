@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ChordPatternCoordinator.h"
+#include "PresetBank.h"
+#include "../lib/SpscQueue.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+/**
+ * PresetSwitcher
+ *
+ * Program changes for a PresetBank without parsing or allocating on the audio thread:
+ *
+ * - loadBank() (message thread) maps and validates a bank and publishes it through an atomic
+ *   pointer; the audio thread swaps it in at its next update().
+ * - requestProgram() (message thread, host program list) and programChange() (audio thread, MIDI
+ *   program change) only store the program number.
+ * - update() (audio thread, once per block) picks up both and returns the preset to switch to.
+ *   apply() then repoints the coordinator at the preset's step table, key map and routing.
+ *
+ * A switch takes effect at the start of the block. The rhythm stays locked to the song position,
+ * so the new pattern continues at the matching step of the bar; held rhythm keys are released
+ * first. Replaced banks go back to the message thread through a lock-free queue, one block after
+ * the switch (the coordinator no longer points into them), and are freed by the next loadBank()
+ * or collectGarbage() call.
+ *
+ * Usage:
+ *   PresetSwitcher presets;
+ *   presets.loadBank("live.phubank", error);         // message thread
+ *   presets.requestProgram(3);
+ *
+ *   // processBlock, before updateDAWGlobals:
+ *   if (const BankPreset* preset = presets.update()) {
+ *       PresetSwitcher::apply(*preset, coordinator, syncGlobals);
+ *   }
+ */
+class PresetSwitcher {
+private:
+    // Message thread -> audio
+    std::atomic<PresetBank*> readyBank { nullptr };
+    std::atomic<int> requestedProgram { -1 };
+
+    // Audio -> message thread
+    SpscQueue<PresetBank*, 8> retiredBanks;
+    std::atomic<int> currentProgram { 0 };
+
+    // Message thread only: newest loaded bank (ready or active)
+    PresetBank* loadedBank = nullptr;
+
+    // Audio thread only
+    PresetBank* activeBank = nullptr;
+    PresetBank* retiringBank = nullptr;      // Replaced in the previous update(), retired in the next
+    const BankPreset* activePreset = nullptr;
+    int pendingMidiProgram = -1;
+    int program = 0;
+
+public:
+    PresetSwitcher() = default;
+
+    ~PresetSwitcher() {
+        collectGarbage();
+        delete readyBank.exchange(nullptr);
+        delete retiringBank;
+        delete activeBank;
+    }
+
+    PresetSwitcher(const PresetSwitcher&) = delete;
+    PresetSwitcher& operator=(const PresetSwitcher&) = delete;
+
+    /**
+     * Map a bank file and make it the active bank from the next block on (message thread).
+     * The current program number is kept (clamped to the new bank).
+     * @return false if the bank cannot be loaded (the previous bank stays active)
+     */
+    bool loadBank(const std::string& path, std::string& error) {
+        auto bank = std::make_unique<PresetBank>();
+        if (!bank->open(path, error)) {
+            return false;
+        }
+        collectGarbage();
+        loadedBank = bank.release();
+        // A bank the audio thread has not picked up yet never became active: free it right away
+        delete readyBank.exchange(loadedBank, std::memory_order_acq_rel);
+        return true;
+    }
+
+    /**
+     * Free banks the audio thread has replaced (message thread)
+     */
+    void collectGarbage() {
+        PresetBank* old = nullptr;
+        while (retiredBanks.pop(old)) {
+            delete old;
+        }
+    }
+
+    /**
+     * Message thread view of the newest loaded bank (nullptr if none), for program names
+     */
+    const PresetBank* getBank() const noexcept { return loadedBank; }
+
+    /**
+     * Switch program from the message thread (host program list, state restore)
+     */
+    void requestProgram(int index) noexcept {
+        requestedProgram.store(index, std::memory_order_release);
+    }
+
+    /**
+     * Program number last switched to by the audio thread
+     */
+    int getCurrentProgram() const noexcept { return currentProgram.load(std::memory_order_acquire); }
+
+    /**
+     * Switch program from a MIDI program change (audio thread)
+     */
+    void programChange(int index) noexcept {
+        pendingMidiProgram = index;
+    }
+
+    /**
+     * Audio thread, once per block. Wait-free.
+     * @return The preset to switch to, nullptr if nothing changed
+     */
+    const BankPreset* update() noexcept {
+        if (retiringBank != nullptr && retiredBanks.push(retiringBank)) {
+            retiringBank = nullptr;
+        }
+        bool changed = false;
+        if (retiringBank == nullptr && readyBank.load(std::memory_order_relaxed) != nullptr) {
+            retiringBank = activeBank;
+            activeBank = readyBank.exchange(nullptr, std::memory_order_acq_rel);
+            changed = true;
+        }
+        const int requested = requestedProgram.exchange(-1, std::memory_order_acq_rel);
+        if (requested >= 0) {
+            program = requested;
+            changed = true;
+        }
+        if (pendingMidiProgram >= 0) {
+            program = pendingMidiProgram;
+            pendingMidiProgram = -1;
+            changed = true;
+        }
+        if (!changed || activeBank == nullptr) {
+            return nullptr;
+        }
+        program = program < activeBank->size() ? program : activeBank->size() - 1;
+        const BankPreset* preset = activeBank->get(program);
+        currentProgram.store(program, std::memory_order_release);
+        if (preset == activePreset) {
+            return nullptr;
+        }
+        activePreset = preset;
+        return preset;
+    }
+
+    /**
+     * Preset last returned by update() (audio thread), nullptr before the first switch
+     */
+    const BankPreset* getActivePreset() const noexcept { return activePreset; }
+
+    /**
+     * Point the coordinator (and the grid resolution) at a preset. Audio thread, no allocation.
+     * Notes held under other input channels are released (their note-offs would not arrive), the
+     * chord only if the chord channel changed; output channel and root note changes keep the
+     * playing notes.
+     */
+    template<typename Globals>
+    static void apply(const BankPreset& preset, ChordPatternCoordinator& coordinator, Globals& syncGlobals) noexcept {
+        const PresetRouting& routing = preset.routing;
+        const bool chordChannelChanged = routing.chordInputChannel != coordinator.getChordInputChannel();
+        if (chordChannelChanged || routing.rhythmInputChannel != coordinator.getRhythmInputChannel()) {
+            coordinator.releaseAllNotes(chordChannelChanged);
+        }
+        coordinator.setChordInputChannel(routing.chordInputChannel);
+        coordinator.setRhythmInputChannel(routing.rhythmInputChannel);
+        coordinator.setOutputChannel(routing.outputChannel);
+        coordinator.setRhythmRootNote(routing.rhythmRootNote);
+        coordinator.setRhythmKeyMap(preset.hasKeyMap ? &preset.keyMap : nullptr);
+
+        if (preset.pattern.numLanes > 0) {
+            syncGlobals.setGridSubdivisionsPerQuarter(preset.pattern.linesPerQuarter);
+            coordinator.getRhythmGenerator().setStepTable(&preset.pattern);
+        } else {
+            coordinator.getRhythmGenerator().setStepTable(nullptr);
+        }
+    }
+};
@@ -0,0 +1,255 @@
+#include "RealtimeTrap.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(PHU_ARP_RT_TRAP)
+#include <new>
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <pthread.h>
+#endif
+#endif
+
+namespace {
+
+// Per-thread state: plain PODs so the hooks can touch them at any time (no TLS constructors)
+thread_local bool audioThread = false;
+thread_local int sectionDepth = 0;
+thread_local int suspendDepth = 0;
+thread_local bool inReport = false;
+
+std::atomic<uint64_t> allocationCount { 0 };
+std::atomic<uint64_t> deallocationCount { 0 };
+std::atomic<uint64_t> lockCount { 0 };
+
+RealtimeTrap::Action actionFromEnvironment() noexcept {
+    const char* value = std::getenv("PHU_ARP_RT_TRAP");
+    if (value != nullptr) {
+        if (std::strcmp(value, "count") == 0) {
+            return RealtimeTrap::Action::Count;
+        }
+        if (std::strcmp(value, "abort") == 0) {
+            return RealtimeTrap::Action::Abort;
+        }
+    }
+    return RealtimeTrap::Action::Report;
+}
+
+std::atomic<int> action { static_cast<int>(actionFromEnvironment()) };
+
+bool isTrapped() noexcept {
+    return audioThread && sectionDepth > 0 && suspendDepth == 0 && !inReport;
+}
+
+// Reports without allocating or taking locks (no stdio streams)
+void reportViolation(const char* what, size_t bytes) noexcept {
+    const auto current = static_cast<RealtimeTrap::Action>(action.load(std::memory_order_relaxed));
+    if (current == RealtimeTrap::Action::Count) {
+        return;
+    }
+
+    inReport = true;
+    char text[160];
+    const int length = bytes > 0
+        ? std::snprintf(text, sizeof(text), "phu-arp rt-trap: %s of %zu bytes in realtime section\n", what, bytes)
+        : std::snprintf(text, sizeof(text), "phu-arp rt-trap: %s in realtime section\n", what);
+    if (length > 0) {
+#if defined(_WIN32)
+        _write(2, text, static_cast<unsigned int>(length));
+#else
+        const ssize_t written = ::write(2, text, static_cast<size_t>(length));
+        (void)written;
+#endif
+    }
+    inReport = false;
+
+    if (current == RealtimeTrap::Action::Abort) {
+        std::abort();
+    }
+}
+
+} // namespace
+
+void RealtimeTrap::markCurrentThreadAsAudioThread() noexcept { audioThread = true; }
+void RealtimeTrap::clearCurrentThreadAsAudioThread() noexcept { audioThread = false; }
+bool RealtimeTrap::isCurrentThreadAudioThread() noexcept { return audioThread; }
+
+void RealtimeTrap::enterSection() noexcept { ++sectionDepth; }
+void RealtimeTrap::leaveSection() noexcept { --sectionDepth; }
+void RealtimeTrap::suspend() noexcept { ++suspendDepth; }
+void RealtimeTrap::resume() noexcept { --suspendDepth; }
+
+void RealtimeTrap::setAction(Action newAction) noexcept {
+    action.store(static_cast<int>(newAction), std::memory_order_relaxed);
+}
+
+RealtimeTrap::Action RealtimeTrap::getAction() noexcept {
+    return static_cast<Action>(action.load(std::memory_order_relaxed));
+}
+
+uint64_t RealtimeTrap::getAllocationCount() noexcept { return allocationCount.load(std::memory_order_relaxed); }
+uint64_t RealtimeTrap::getDeallocationCount() noexcept { return deallocationCount.load(std::memory_order_relaxed); }
+uint64_t RealtimeTrap::getLockCount() noexcept { return lockCount.load(std::memory_order_relaxed); }
+
+uint64_t RealtimeTrap::getViolationCount() noexcept {
+    return getAllocationCount() + getDeallocationCount() + getLockCount();
+}
+
+void RealtimeTrap::resetCounters() noexcept {
+    allocationCount.store(0, std::memory_order_relaxed);
+    deallocationCount.store(0, std::memory_order_relaxed);
+    lockCount.store(0, std::memory_order_relaxed);
+}
+
+void RealtimeTrap::noteAllocation(size_t bytes) noexcept {
+    if (isTrapped()) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        reportViolation("allocation", bytes);
+    }
+}
+
+void RealtimeTrap::noteDeallocation() noexcept {
+    if (isTrapped()) {
+        deallocationCount.fetch_add(1, std::memory_order_relaxed);
+        reportViolation("deallocation", 0);
+    }
+}
+
+void RealtimeTrap::noteLock(const char* what) noexcept {
+    if (isTrapped()) {
+        lockCount.fetch_add(1, std::memory_order_relaxed);
+        reportViolation(what, 0);
+    }
+}
+
+#if defined(PHU_ARP_RT_TRAP)
+
+// ---------------------------------------------------------------------------
+// Global operator new/delete replacements (counted, then forwarded to malloc/free)
+// ---------------------------------------------------------------------------
+
+namespace {
+
+void* allocateOrThrow(size_t size) {
+    RealtimeTrap::noteAllocation(size);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* allocateAlignedOrThrow(size_t size, std::align_val_t alignment) {
+    RealtimeTrap::noteAllocation(size);
+    const size_t align = static_cast<size_t>(alignment);
+    const size_t rounded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+#if defined(_WIN32)
+    void* p = _aligned_malloc(rounded, align);
+#else
+    void* p = std::aligned_alloc(align, rounded);
+#endif
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void release(void* p) noexcept {
+    if (p != nullptr) {
+        RealtimeTrap::noteDeallocation();
+        std::free(p);
+    }
+}
+
+void releaseAligned(void* p) noexcept {
+    if (p != nullptr) {
+        RealtimeTrap::noteDeallocation();
+#if defined(_WIN32)
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+} // namespace
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocateOrThrow(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocateOrThrow(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateAlignedOrThrow(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateAlignedOrThrow(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { releaseAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+
+// ---------------------------------------------------------------------------
+// Lock hook (Linux): interposes pthread_mutex_lock, which std::mutex and most
+// framework locks end up in, and forwards to the C library.
+// ---------------------------------------------------------------------------
+
+#if defined(__linux__)
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    using LockFunction = int (*)(pthread_mutex_t*);
+    static std::atomic<LockFunction> next { nullptr };
+
+    LockFunction lockFunction = next.load(std::memory_order_acquire);
+    if (lockFunction == nullptr) {
+        lockFunction = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        next.store(lockFunction, std::memory_order_release);
+    }
+
+    RealtimeTrap::noteLock("mutex lock");
+    return lockFunction(mutex);
+}
+#endif
+
+#endif // PHU_ARP_RT_TRAP
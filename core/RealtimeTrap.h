@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * RealtimeTrap
+ *
+ * Debug/benchmark aid that certifies the audio path as real-time safe.
+ * Built with PHU_ARP_RT_TRAP (CMake option of the same name), phu-arp-core installs counting
+ * operator new/delete hooks and (on Linux) a pthread_mutex_lock hook. Any allocation,
+ * deallocation or lock acquisition on a thread marked as the audio thread while it is inside a
+ * realtime section (PHU_ARP_RT_SECTION, e.g. processBlock) is a violation: it is counted and,
+ * depending on the action, reported to stderr or aborts the process.
+ *
+ * Without PHU_ARP_RT_TRAP the hooks are not installed and PHU_ARP_RT_SECTION compiles to nothing;
+ * the remaining calls are plain thread-local flag updates.
+ *
+ * The action defaults to Report and can be set with setAction() or the environment variable
+ * PHU_ARP_RT_TRAP=count|report|abort.
+ *
+ * Usage:
+ *   // Audio thread (EditorLogger::markCurrentThreadAsAudioThread does this for the plugin)
+ *   RealtimeTrap::markCurrentThreadAsAudioThread();
+ *
+ *   void process() {
+ *       PHU_ARP_RT_SECTION();        // Trapped until the end of the scope
+ *       ...
+ *   }
+ *
+ *   // Benchmarks/tests
+ *   if (RealtimeTrap::isEnabled() && RealtimeTrap::getViolationCount() != 0) { fail }
+ *
+ *   // Code that knowingly leaves the realtime contract (e.g. debug logging)
+ *   { RealtimeTrap::ScopedAllow allow; ... }
+ */
+class RealtimeTrap {
+public:
+    enum class Action {
+        Count,      // Only count violations
+        Report,     // Count and print one line per violation to stderr (no allocation)
+        Abort       // Report, then abort (catch the offender in a debugger / core dump)
+    };
+
+    /**
+     * True if the hooks were compiled in (PHU_ARP_RT_TRAP)
+     */
+    static constexpr bool isEnabled() noexcept {
+#if defined(PHU_ARP_RT_TRAP)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Mark/unmark the calling thread as an audio thread.
+     * Realtime sections only trap on marked threads.
+     */
+    static void markCurrentThreadAsAudioThread() noexcept;
+    static void clearCurrentThreadAsAudioThread() noexcept;
+    static bool isCurrentThreadAudioThread() noexcept;
+
+    /**
+     * Realtime section of the calling thread (nesting allowed). Use PHU_ARP_RT_SECTION().
+     */
+    class ScopedSection {
+    public:
+        ScopedSection() noexcept { enterSection(); }
+        ~ScopedSection() noexcept { leaveSection(); }
+        ScopedSection(const ScopedSection&) = delete;
+        ScopedSection& operator=(const ScopedSection&) = delete;
+    };
+
+    /**
+     * Suspends trapping on the calling thread for the scope (documented exceptions only)
+     */
+    class ScopedAllow {
+    public:
+        ScopedAllow() noexcept { suspend(); }
+        ~ScopedAllow() noexcept { resume(); }
+        ScopedAllow(const ScopedAllow&) = delete;
+        ScopedAllow& operator=(const ScopedAllow&) = delete;
+    };
+
+    static void setAction(Action newAction) noexcept;
+    static Action getAction() noexcept;
+
+    /**
+     * Violation counters (all threads, since start or the last resetCounters())
+     */
+    static uint64_t getAllocationCount() noexcept;
+    static uint64_t getDeallocationCount() noexcept;
+    static uint64_t getLockCount() noexcept;
+    static uint64_t getViolationCount() noexcept;
+    static void resetCounters() noexcept;
+
+    /**
+     * Hook entry points (called by the operator new/delete and lock hooks).
+     * noteLock() can also be called by code that takes a lock the hooks cannot see.
+     */
+    static void noteAllocation(size_t bytes) noexcept;
+    static void noteDeallocation() noexcept;
+    static void noteLock(const char* what) noexcept;
+
+private:
+    static void enterSection() noexcept;
+    static void leaveSection() noexcept;
+    static void suspend() noexcept;
+    static void resume() noexcept;
+};
+
+#if defined(PHU_ARP_RT_TRAP)
+#define PHU_ARP_RT_SECTION_CONCAT2(a, b) a##b
+#define PHU_ARP_RT_SECTION_CONCAT(a, b) PHU_ARP_RT_SECTION_CONCAT2(a, b)
+#define PHU_ARP_RT_SECTION() \
+    const RealtimeTrap::ScopedSection PHU_ARP_RT_SECTION_CONCAT(rtTrapSection, __LINE__)
+#else
+#define PHU_ARP_RT_SECTION() \
+    do { \
+    } while (0)
+#endif
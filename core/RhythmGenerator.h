@@ -0,0 +1,125 @@
+#pragma once
+
+#include "MidiEvent.h"
+#include "PatternCompiler.h"
+#include "../lib/BeatGrid.h"
+#include <array>
+#include <cstddef>
+
+/**
+ * RhythmGenerator
+ *
+ * Internal replacement for the rhythm track on the rhythm input channel (16): plays a compiled
+ * rhythm pattern (StepTable, see PatternCompiler) with up to StepTable::maxLanes lanes, each
+ * lane playing one rhythm key, stepped by the lines of the SyncGlobals BeatGrid.
+ * The generated rhythm-key note-on/off events are the same events an external rhythm track
+ * would send, so the coordinator merges them into its ordering stage (same phase priorities)
+ * and external rhythm input keeps working alongside.
+ *
+ * Playback is locked to the song position: row = line index mod table length, so loops and
+ * relocations land on the matching step. Per line and lane it is one table read (release the
+ * held key, start a new one); ties, ratchets, Euclidean fills and polymeters were all resolved
+ * by the compiler. A loop wrap or relocation releases the held keys at the first line after the
+ * jump, and so does switching to another table.
+ *
+ * The grid must run at the table's resolution (StepTable::linesPerQuarter); on a mismatch the
+ * generator stays silent. The table is owned by the caller and must outlive its use here.
+ *
+ * Usage:
+ *   coordinator.setBeatGrid(&syncGlobals.getBeatGrid());
+ *
+ *   // Audio thread, when a new table arrives (see PatternCompileWorker):
+ *   syncGlobals.setGridSubdivisionsPerQuarter(table->linesPerQuarter);
+ *   coordinator.getRhythmGenerator().setStepTable(table);
+ */
+class RhythmGenerator {
+public:
+    static constexpr int maxLanes = StepTable::maxLanes;
+
+    // Upper bound of generated events per block (one release and one trigger per lane and line)
+    static constexpr size_t maxEventsPerBlock = static_cast<size_t>(BeatGrid::maxBoundaries) * maxLanes * 2;
+
+private:
+    struct HeldKey {
+        bool held = false;
+        int note = 0;                     // Rhythm input note number
+    };
+
+    const StepTable* table = nullptr;
+    std::array<HeldKey, maxLanes> heldKeys {};
+    bool releaseAllPending = false;       // Table changed: release the held keys first
+
+public:
+    /**
+     * Play another table (nullptr = off); the held keys are released at the next block
+     */
+    void setStepTable(const StepTable* tableToPlay) noexcept {
+        table = tableToPlay;
+        releaseAllPending = true;
+    }
+
+    const StepTable* getStepTable() const noexcept { return table; }
+
+    /**
+     * True if generate() has work: a table with lanes is set, or a table switch still has to
+     * release the held keys
+     */
+    bool isActive() const noexcept {
+        return releaseAllPending || (table != nullptr && table->numLanes > 0);
+    }
+
+    /**
+     * Forget the held keys without emitting note-offs (transport stop: the coordinator flushes
+     * the output notes itself)
+     */
+    void reset() noexcept {
+        for (auto& key : heldKeys) {
+            key.held = false;
+        }
+        releaseAllPending = false;
+    }
+
+    /**
+     * Emit the rhythm-key events for the lines of this block, in time order.
+     * emit(const MidiEvent&) receives note-ons/offs on rhythmChannel with note = rootNote + key.
+     */
+    template<typename Emit>
+    void generate(const BeatGrid& grid, int rootNote, int rhythmChannel, Emit&& emit) {
+        if (!grid.isValid()) {
+            reset();
+            return;
+        }
+        if (releaseAllPending) {
+            for (HeldKey& held : heldKeys) {
+                if (held.held) {
+                    emit(MidiEvent::noteOff(rhythmChannel, held.note, 0, 0));
+                    held.held = false;
+                }
+            }
+            releaseAllPending = false;
+        }
+        if (table == nullptr || table->numLanes == 0 || grid.getSubdivisionsPerQuarter() != table->linesPerQuarter) {
+            return;
+        }
+        const int numLanes = table->numLanes;
+        for (const GridBoundary& line : grid) {
+            const StepCell* row = table->row(line.index);
+            for (int l = 0; l < numLanes; ++l) {
+                const StepCell cell = row[l];
+                HeldKey& held = heldKeys[static_cast<size_t>(l)];
+
+                if (held.held && (cell.release != 0 || cell.velocity != 0 || line.afterJump)) {
+                    emit(MidiEvent::noteOff(rhythmChannel, held.note, 0, line.sampleOffset));
+                    held.held = false;
+                }
+                const int note = rootNote + table->keys[l];
+                if (cell.velocity == 0 || note < 0 || note > 127) {
+                    continue;
+                }
+                emit(MidiEvent::noteOn(rhythmChannel, note, cell.velocity, line.sampleOffset));
+                held.held = true;
+                held.note = note;
+            }
+        }
+    }
+};
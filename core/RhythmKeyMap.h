@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * RhythmKeyMap
+ *
+ * Overrides which chord note a rhythm key plays. Rhythm keys are relative to the root note
+ * (firstKey..firstKey+numKeys-1); keys without an entry keep the default mapping
+ * (chord index = key mod 12, octave = key div 12).
+ *
+ * Fixed size and trivially copyable, so preset banks store it as is.
+ *
+ * Usage:
+ *   RhythmKeyMap map;
+ *   map.set(0, 2, 1);                 // key 0 plays the third chord note, one octave up
+ *   coordinator.setRhythmKeyMap(&map);
+ */
+struct RhythmKeyMap {
+    static constexpr int numKeys = 128;
+    static constexpr int firstKey = -64;
+    static constexpr int8_t useDefault = -128;
+
+    struct Entry {
+        int8_t chordIndex = useDefault;  // 0-based chord note, useDefault = default mapping
+        int8_t octave = 0;               // Octaves added to the chord note
+    };
+
+    Entry entries[numKeys];
+
+    /**
+     * Map relative key to chord index 0..11 and octave (-8..8); false if out of range
+     */
+    bool set(int key, int chordIndex, int octave) noexcept {
+        if (key < firstKey || key >= firstKey + numKeys || chordIndex < 0 || chordIndex > 11 || octave < -8 || octave > 8) {
+            return false;
+        }
+        entries[key - firstKey].chordIndex = static_cast<int8_t>(chordIndex);
+        entries[key - firstKey].octave = static_cast<int8_t>(octave);
+        return true;
+    }
+
+    /**
+     * Mapped chord index and octave offset (semitones) of a relative key, false for the default mapping
+     */
+    bool lookup(int key, int& chordIndex, int& octaveOffset) const noexcept {
+        if (key < firstKey || key >= firstKey + numKeys) {
+            return false;
+        }
+        const Entry& entry = entries[key - firstKey];
+        if (entry.chordIndex == useDefault) {
+            return false;
+        }
+        chordIndex = entry.chordIndex;
+        octaveOffset = entry.octave * 12;
+        return true;
+    }
+};
+
+static_assert(sizeof(RhythmKeyMap) == RhythmKeyMap::numKeys * 2, "RhythmKeyMap is stored as is in preset banks");
@@ -0,0 +1,48 @@
+#include "StandardMidiFile.h"
+#include "MidiFileReader.h"
+#include "MidiFileWriter.h"
+
+namespace {
+
+bool readAll(MidiFileReader& reader, MidiFileData& out) {
+    out = MidiFileData();
+    out.format = reader.getFormat();
+    out.ticksPerQuarter = reader.getTicksPerQuarter();
+    out.lengthInTicks = reader.getLengthInTicks();
+    out.tempoMap = reader.getTempoMap();
+
+    MidiFileEvent evt;
+    while (reader.next(evt)) {
+        out.events.push_back(evt);
+    }
+    return true;
+}
+
+} // namespace
+
+bool StandardMidiFile::read(const std::string& path, MidiFileData& out, std::string& error) {
+    MidiFileReader reader;
+    if (!reader.open(path, error)) {
+        return false;
+    }
+    return readAll(reader, out);
+}
+
+bool StandardMidiFile::parse(const uint8_t* data, size_t size, MidiFileData& out, std::string& error) {
+    MidiFileReader reader;
+    if (!reader.openMemory(data, size, error)) {
+        return false;
+    }
+    return readAll(reader, out);
+}
+
+bool StandardMidiFile::write(const std::string& path, const MidiFileData& file, std::string& error) {
+    MidiFileWriter writer;
+    if (!writer.open(path, file.ticksPerQuarter, file.tempoMap, error)) {
+        return false;
+    }
+    for (const auto& evt : file.events) {
+        writer.write(evt);
+    }
+    return writer.close(file.lengthInTicks, error);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "MidiEvent.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Event of a Standard MIDI File, positioned in ticks.
+ * MidiEvent::samplePosition is not used here (left at 0).
+ */
+struct MidiFileEvent {
+    uint32_t tick = 0;
+    MidiEvent message;
+};
+
+/**
+ * Tempo change (meta event 0x51) in ticks
+ */
+struct TempoChange {
+    uint32_t tick = 0;
+    uint32_t microsecondsPerQuarter = 500000;   // 120 BPM
+};
+
+/**
+ * Content of a Standard MIDI File as far as the engine cares:
+ * channel voice messages of all tracks merged into one time-ordered list, plus the tempo map.
+ */
+struct MidiFileData {
+    int format = 1;
+    int ticksPerQuarter = 480;
+    uint32_t lengthInTicks = 0;                  // Tick of the latest end-of-track
+    std::vector<MidiFileEvent> events;           // Sorted by tick (file/track order kept for equal ticks)
+    std::vector<TempoChange> tempoMap;           // Sorted by tick
+};
+
+/**
+ * StandardMidiFile
+ *
+ * Convenience functions to load/store a whole Standard MIDI File (SMF, format 0 and 1,
+ * PPQ time division) as MidiFileData. Sysex and meta events other than tempo/end-of-track
+ * are skipped on read.
+ *
+ * Built on the streaming MidiFileReader (memory-mapped, zero-copy) and MidiFileWriter
+ * (buffered); use those directly to process large files without holding all events in memory.
+ *
+ * Usage:
+ *   MidiFileData data;
+ *   std::string error;
+ *   if (!StandardMidiFile::read("in.mid", data, error)) { ... }
+ *   StandardMidiFile::write("out.mid", data, error);
+ */
+class StandardMidiFile {
+public:
+    /**
+     * Read and parse a file (memory-mapped)
+     * @return false on I/O or format errors (error describes the problem)
+     */
+    static bool read(const std::string& path, MidiFileData& out, std::string& error);
+
+    /**
+     * Parse an in-memory SMF image
+     * @return false on format errors (error describes the problem)
+     */
+    static bool parse(const uint8_t* data, size_t size, MidiFileData& out, std::string& error);
+
+    /**
+     * Write a format 1 file: track 0 holds the tempo map, track 1 holds all events
+     * @return false on I/O errors
+     */
+    static bool write(const std::string& path, const MidiFileData& file, std::string& error);
+};
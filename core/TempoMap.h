@@ -0,0 +1,106 @@
+#pragma once
+
+#include "StandardMidiFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/**
+ * TempoMap
+ *
+ * Converts between MIDI file ticks and samples for a given tempo map and sample rate.
+ * Each tempo change starts a segment with a constant samples-per-tick rate.
+ *
+ * Usage:
+ *   TempoMap map(file.tempoMap, file.ticksPerQuarter, 48000.0);
+ *   int64_t sample = map.ticksToSamples(evt.tick);
+ *   uint32_t tick = map.samplesToTicks(sample);
+ */
+class TempoMap {
+private:
+    struct Segment {
+        uint32_t tick = 0;
+        double startSample = 0.0;
+        double samplesPerTick = 0.0;
+        double bpm = 120.0;
+    };
+
+    std::vector<Segment> segments;   // Sorted by tick, first segment starts at tick 0
+    double ticksPerQuarter = 480.0;
+
+public:
+    TempoMap(const std::vector<TempoChange>& tempoChanges, int ticksPerQuarter, double sampleRate)
+        : ticksPerQuarter(ticksPerQuarter > 0 ? ticksPerQuarter : 480) {
+        const double samplesPerMicrosecond = sampleRate / 1000000.0;
+        auto makeSegment = [&](uint32_t tick, double startSample, uint32_t microsecondsPerQuarter) {
+            Segment seg;
+            seg.tick = tick;
+            seg.startSample = startSample;
+            seg.samplesPerTick = microsecondsPerQuarter * samplesPerMicrosecond / ticksPerQuarter;
+            seg.bpm = 60000000.0 / microsecondsPerQuarter;
+            return seg;
+        };
+
+        segments.push_back(makeSegment(0, 0.0, 500000));
+        for (const auto& change : tempoChanges) {
+            if (change.microsecondsPerQuarter == 0) {
+                continue;
+            }
+            const auto& last = segments.back();
+            const double startSample = last.startSample + (change.tick - last.tick) * last.samplesPerTick;
+            if (change.tick == last.tick) {
+                segments.back() = makeSegment(change.tick, last.startSample, change.microsecondsPerQuarter);
+            } else {
+                segments.push_back(makeSegment(change.tick, startSample, change.microsecondsPerQuarter));
+            }
+        }
+    }
+
+    /**
+     * Absolute sample position of a tick
+     */
+    int64_t ticksToSamples(uint32_t tick) const {
+        const auto& seg = segmentForTick(tick);
+        return static_cast<int64_t>(std::llround(seg.startSample + (tick - seg.tick) * seg.samplesPerTick));
+    }
+
+    /**
+     * Tick of an absolute sample position (rounded to the nearest tick)
+     */
+    uint32_t samplesToTicks(int64_t sample) const {
+        const auto& seg = segmentForSample(static_cast<double>(sample));
+        const double ticks = seg.tick + (sample - seg.startSample) / seg.samplesPerTick;
+        return ticks <= 0.0 ? 0u : static_cast<uint32_t>(std::llround(ticks));
+    }
+
+    /**
+     * Musical position (quarter notes, unrounded) of an absolute sample position
+     */
+    double quartersAtSample(int64_t sample) const {
+        const auto& seg = segmentForSample(static_cast<double>(sample));
+        const double ticks = seg.tick + (sample - seg.startSample) / seg.samplesPerTick;
+        return ticks <= 0.0 ? 0.0 : ticks / ticksPerQuarter;
+    }
+
+    /**
+     * Tempo in effect at an absolute sample position
+     */
+    double bpmAtSample(int64_t sample) const {
+        return segmentForSample(static_cast<double>(sample)).bpm;
+    }
+
+private:
+    const Segment& segmentForTick(uint32_t tick) const {
+        auto it = std::upper_bound(segments.begin(), segments.end(), tick,
+            [](uint32_t t, const Segment& seg) { return t < seg.tick; });
+        return *std::prev(it);
+    }
+
+    const Segment& segmentForSample(double sample) const {
+        auto it = std::upper_bound(segments.begin(), segments.end(), sample,
+            [](double s, const Segment& seg) { return s < seg.startSample; });
+        return it == segments.begin() ? segments.front() : *std::prev(it);
+    }
+};
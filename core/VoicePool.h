@@ -0,0 +1,219 @@
+#pragma once
+
+#include "NoteMask.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Which voice a full polyphony cap takes for a new note (see VoicePool)
+ */
+enum class VoiceSteal {
+    Oldest,             // Longest playing
+    LowestVelocity,     // Quietest (the oldest of those)
+    HighestPitch,       // Highest note (the oldest of those)
+    LowestPitch         // Lowest note (the oldest of those)
+};
+
+/**
+ * VoicePool
+ *
+ * Fixed-capacity set of playing voices (pitch, velocity) ordered by age, for a polyphony cap.
+ * Every voice is in two intrusive doubly linked lists: all voices by age, and its bucket by age.
+ * The bucket is the voice's velocity or pitch for the steal policies that compare them (a single
+ * bucket for Oldest); a NoteMask of the non-empty buckets gives the lowest or highest one with a
+ * bit scan. Adding, removing and finding the voice to steal are O(1), without allocation.
+ *
+ * Usage:
+ *   VoicePool pool;
+ *   pool.setSteal(VoiceSteal::LowestVelocity);
+ *   const int voice = pool.add(60, 100);    // Slot, -1 if the pool is full
+ *   const int victim = pool.victim();       // Voice to steal, -1 if none
+ *   pool.remove(victim);
+ */
+class VoicePool {
+public:
+    static constexpr int capacity = 256;
+
+private:
+    static constexpr int16_t none = -1;
+
+    struct Voice {
+        int16_t older = none;              // Age list of all voices
+        int16_t newer = none;
+        int16_t bucketOlder = none;        // Age list of the voice's bucket
+        int16_t bucketNewer = none;
+        uint8_t pitch = 0;
+        uint8_t velocity = 0;
+        bool used = false;
+    };
+
+    std::array<Voice, capacity> voices {};
+    int16_t oldest = none;
+    int16_t newest = none;
+    std::array<int16_t, 128> bucketOldest {};
+    std::array<int16_t, 128> bucketNewest {};
+    NoteMask usedBuckets;                  // Buckets holding at least one voice
+    std::array<int16_t, capacity> freeSlots {};
+    int numFree = 0;
+    VoiceSteal steal = VoiceSteal::Oldest;
+
+    int bucketOf(const Voice& voice) const noexcept {
+        switch (steal) {
+            case VoiceSteal::LowestVelocity: return voice.velocity;
+            case VoiceSteal::HighestPitch:
+            case VoiceSteal::LowestPitch: return voice.pitch;
+            default: return 0;
+        }
+    }
+
+    void linkBucket(int16_t slot) noexcept {
+        Voice& voice = voices[static_cast<size_t>(slot)];
+        const size_t bucket = static_cast<size_t>(bucketOf(voice));
+        voice.bucketOlder = bucketNewest[bucket];
+        voice.bucketNewer = none;
+        if (bucketNewest[bucket] != none) {
+            voices[static_cast<size_t>(bucketNewest[bucket])].bucketNewer = slot;
+        } else {
+            bucketOldest[bucket] = slot;
+            usedBuckets.set(static_cast<int>(bucket));
+        }
+        bucketNewest[bucket] = slot;
+    }
+
+    void unlinkBucket(int16_t slot) noexcept {
+        const Voice& voice = voices[static_cast<size_t>(slot)];
+        const size_t bucket = static_cast<size_t>(bucketOf(voice));
+        (voice.bucketOlder != none ? voices[static_cast<size_t>(voice.bucketOlder)].bucketNewer : bucketOldest[bucket]) = voice.bucketNewer;
+        (voice.bucketNewer != none ? voices[static_cast<size_t>(voice.bucketNewer)].bucketOlder : bucketNewest[bucket]) = voice.bucketOlder;
+        if (bucketOldest[bucket] == none) {
+            usedBuckets.reset(static_cast<int>(bucket));
+        }
+    }
+
+public:
+    VoicePool() noexcept { clear(); }
+
+    /**
+     * Add a voice as the newest
+     * @return Its slot (0..capacity-1), -1 if the pool is full
+     */
+    int add(int pitch, int velocity) noexcept {
+        if (numFree == 0) {
+            return none;
+        }
+        const int16_t slot = freeSlots[static_cast<size_t>(--numFree)];
+        Voice& voice = voices[static_cast<size_t>(slot)];
+        voice.pitch = static_cast<uint8_t>(pitch & 0x7f);
+        voice.velocity = static_cast<uint8_t>(velocity & 0x7f);
+        voice.used = true;
+        voice.older = newest;
+        voice.newer = none;
+        (newest != none ? voices[static_cast<size_t>(newest)].newer : oldest) = slot;
+        newest = slot;
+        linkBucket(slot);
+        return slot;
+    }
+
+    /**
+     * Remove a voice (no-op for -1 or a free slot)
+     */
+    void remove(int slot) noexcept {
+        if (slot < 0 || slot >= capacity || !voices[static_cast<size_t>(slot)].used) {
+            return;
+        }
+        const auto index = static_cast<int16_t>(slot);
+        unlinkBucket(index);
+        Voice& voice = voices[static_cast<size_t>(slot)];
+        (voice.older != none ? voices[static_cast<size_t>(voice.older)].newer : oldest) = voice.newer;
+        (voice.newer != none ? voices[static_cast<size_t>(voice.newer)].older : newest) = voice.older;
+        voice.used = false;
+        freeSlots[static_cast<size_t>(numFree++)] = index;
+    }
+
+    /**
+     * A voice changed pitch (chord follow). It keeps its age; with a pitch policy it becomes the
+     * newest of its new pitch.
+     */
+    void setPitch(int slot, int pitch) noexcept {
+        if (slot < 0 || slot >= capacity || !voices[static_cast<size_t>(slot)].used) {
+            return;
+        }
+        const auto index = static_cast<int16_t>(slot);
+        unlinkBucket(index);
+        voices[static_cast<size_t>(slot)].pitch = static_cast<uint8_t>(pitch & 0x7f);
+        linkBucket(index);
+    }
+
+    /**
+     * The voice to steal under the current policy, -1 if there is none
+     */
+    int victim() const noexcept {
+        switch (steal) {
+            case VoiceSteal::LowestVelocity:
+            case VoiceSteal::LowestPitch: {
+                const int bucket = usedBuckets.lowest();
+                return bucket < 0 ? none : bucketOldest[static_cast<size_t>(bucket)];
+            }
+            case VoiceSteal::HighestPitch: {
+                const int bucket = usedBuckets.highest();
+                return bucket < 0 ? none : bucketOldest[static_cast<size_t>(bucket)];
+            }
+            default:
+                return oldest;
+        }
+    }
+
+    /**
+     * Change the steal policy; the voices are sorted into the new buckets in age order (O(voices))
+     */
+    void setSteal(VoiceSteal stealToUse) noexcept {
+        if (stealToUse == steal) {
+            return;
+        }
+        steal = stealToUse;
+        bucketOldest.fill(none);
+        bucketNewest.fill(none);
+        usedBuckets.clear();
+        for (int16_t slot = oldest; slot != none; slot = voices[static_cast<size_t>(slot)].newer) {
+            linkBucket(slot);
+        }
+    }
+    VoiceSteal getSteal() const noexcept { return steal; }
+
+    void clear() noexcept {
+        for (auto& voice : voices) {
+            voice.used = false;
+        }
+        oldest = none;
+        newest = none;
+        bucketOldest.fill(none);
+        bucketNewest.fill(none);
+        usedBuckets.clear();
+        for (int i = 0; i < capacity; ++i) {
+            freeSlots[static_cast<size_t>(i)] = static_cast<int16_t>(capacity - 1 - i);
+        }
+        numFree = capacity;
+    }
+
+    size_t size() const noexcept { return static_cast<size_t>(capacity - numFree); }
+
+    /**
+     * Parse "oldest", "velocity" (lowest velocity), "highest" or "lowest" (pitch)
+     */
+    static bool parseSteal(const std::string& text, VoiceSteal& stealOut) {
+        if (text == "oldest") {
+            stealOut = VoiceSteal::Oldest;
+        } else if (text == "velocity") {
+            stealOut = VoiceSteal::LowestVelocity;
+        } else if (text == "highest") {
+            stealOut = VoiceSteal::HighestPitch;
+        } else if (text == "lowest") {
+            stealOut = VoiceSteal::LowestPitch;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
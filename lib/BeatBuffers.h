@@ -0,0 +1,207 @@
+#pragma once
+
+#include "BufferEventSource.h"
+#include "SpscQueue.h"
+#include "SyncGlobalsListener.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Beat-length sample buffers for one tempo/sample-rate combination.
+ * Immutable in size once built; the audio thread owns the sample content of the active set.
+ */
+struct BeatBufferSet {
+    int numBeats = 1;
+    int numChannels = 1;
+    double samplesPerBeat = 0.0;
+    int globalSize = 0;                  // Samples per channel (numBeats beats, rounded up)
+    std::vector<float> samples;          // numChannels * globalSize, channel-major
+
+    float* getChannel(int channel) noexcept {
+        return samples.data() + static_cast<size_t>(channel) * static_cast<size_t>(globalSize);
+    }
+    const float* getChannel(int channel) const noexcept {
+        return samples.data() + static_cast<size_t>(channel) * static_cast<size_t>(globalSize);
+    }
+};
+
+/**
+ * BeatBuffers (BUFFERS)
+ *
+ * Listens to SyncGlobals and keeps beat-length buffers sized for the current tempo and sample
+ * rate, without ever allocating on the audio thread:
+ *
+ * 1. onBPMChanged/onSampleRateChanged (audio thread, from updateDAWGlobals) only compute the new
+ *    samples-per-beat and post it as a request (atomics, no lock, no allocation, no wakeup: the
+ *    background thread polls every 10 ms).
+ * 2. A background thread builds the new BeatBufferSet (allocates, zeroes) and publishes it
+ *    through an atomic pointer. Requests are coalesced: only the latest size is built.
+ * 3. update() (audio thread, once per block) swaps the ready set in, fires BuffersChangedEvent
+ *    to the BUFFERS listeners and hands the old set back to the background thread for deletion
+ *    via a lock-free queue.
+ *
+ * Until the first set is ready, getActive() returns nullptr. Listeners get the event on the
+ * audio thread (inside update()).
+ *
+ * Usage:
+ *   BeatBuffers buffers(4, 2);                 // 4 beats, 2 channels
+ *   syncGlobals.addEventListener(&buffers);    // BUFFERS listens to GLOBALS
+ *   buffers.addEventListener(&rms);            // RMS listens to BUFFERS
+ *
+ *   // processBlock:
+ *   auto ctx = syncGlobals.updateDAWGlobals(numSamples, transport);
+ *   if (BeatBufferSet* set = buffers.update(ctx)) { ... use set->getChannel(0) ... }
+ */
+class BeatBuffers : public GlobalsEventListener, public BufferEventSource {
+private:
+    const int numBeats;
+    const int numChannels;
+
+    // Request (audio/message thread -> worker): latest samples per beat, generation bumped per request
+    std::atomic<double> requestedSamplesPerBeat { 0.0 };
+    std::atomic<unsigned> requestGeneration { 0 };
+    double msecPerBeat = 0.0;            // From the last BPM event (thread that fires GLOBALS)
+    double sampleRate = 0.0;             // From the last sample rate event
+
+    // Worker -> audio: newest built set (nullptr once taken)
+    std::atomic<BeatBufferSet*> ready { nullptr };
+
+    // Audio -> worker: replaced sets to delete
+    SpscQueue<BeatBufferSet*, 16> retired;
+
+    // Audio thread only
+    BeatBufferSet* active = nullptr;
+
+    std::atomic<size_t> buildCount { 0 };
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::atomic<bool> stopping { false };
+    std::thread worker;
+
+    static constexpr auto pollInterval = std::chrono::milliseconds(10);
+
+    void postRequest(double samplesPerBeat) noexcept {
+        if (samplesPerBeat <= 0.0) {
+            return;
+        }
+        requestedSamplesPerBeat.store(samplesPerBeat, std::memory_order_relaxed);
+        requestGeneration.fetch_add(1, std::memory_order_release);
+        // Audio thread: no lock and no notify (it can be a syscall); the worker picks the request
+        // up within its poll interval
+    }
+
+    void freeRetired() {
+        BeatBufferSet* old = nullptr;
+        while (retired.pop(old)) {
+            delete old;
+        }
+    }
+
+    void run() {
+        unsigned builtGeneration = 0;
+        while (!stopping.load(std::memory_order_acquire)) {
+            {
+                std::unique_lock<std::mutex> lock(wakeLock);
+                wake.wait_for(lock, pollInterval, [&]() {
+                    return stopping.load(std::memory_order_acquire)
+                        || requestGeneration.load(std::memory_order_acquire) != builtGeneration
+                        || retired.front() != nullptr;
+                });
+            }
+            freeRetired();
+
+            const unsigned generation = requestGeneration.load(std::memory_order_acquire);
+            if (generation == builtGeneration || stopping.load(std::memory_order_acquire)) {
+                continue;
+            }
+            builtGeneration = generation;
+
+            auto* set = new BeatBufferSet();
+            set->numBeats = numBeats;
+            set->numChannels = numChannels;
+            set->samplesPerBeat = requestedSamplesPerBeat.load(std::memory_order_relaxed);
+            set->globalSize = static_cast<int>(std::ceil(set->samplesPerBeat * numBeats));
+            set->samples.assign(static_cast<size_t>(numChannels) * static_cast<size_t>(set->globalSize), 0.0f);
+            buildCount.fetch_add(1, std::memory_order_relaxed);
+
+            // A set the audio thread has not picked up yet is superseded: take it back and delete it
+            delete ready.exchange(set, std::memory_order_acq_rel);
+        }
+    }
+
+public:
+    explicit BeatBuffers(int beats = 1, int channels = 1)
+        : numBeats(beats > 0 ? beats : 1)
+        , numChannels(channels > 0 ? channels : 1)
+        , worker([this]() { run(); }) {}
+
+    ~BeatBuffers() override {
+        stopping.store(true, std::memory_order_release);
+        wake.notify_one();
+        worker.join();
+        freeRetired();
+        delete ready.exchange(nullptr);
+        delete active;
+    }
+
+    BeatBuffers(const BeatBuffers&) = delete;
+    BeatBuffers& operator=(const BeatBuffers&) = delete;
+
+    int getNumBeats() const noexcept { return numBeats; }
+    int getNumChannels() const noexcept { return numChannels; }
+
+    /**
+     * Number of sets built by the background thread so far
+     */
+    size_t getBuildCount() const noexcept { return buildCount.load(std::memory_order_relaxed); }
+
+    void onBPMChanged(const BPMEvent& event) override {
+        msecPerBeat = event.newValues.msecPerBeat;
+        postRequest(event.newValues.samplesPerBeat);
+    }
+
+    void onSampleRateChanged(const SampleRateEvent& event) override {
+        sampleRate = event.newRate;
+        if (msecPerBeat > 0.0) {
+            postRequest(msecPerBeat * sampleRate / 1000.0);
+        }
+    }
+
+    /**
+     * Audio thread, once per block: install newly built buffers (firing BuffersChangedEvent)
+     * and return the active set (nullptr until the first one is ready). Wait-free.
+     */
+    BeatBufferSet* update(const Event::Context& context) noexcept {
+        if (ready.load(std::memory_order_relaxed) == nullptr) {
+            return active;
+        }
+        // The old set goes back to the worker; if its queue is full, keep the old set one more block
+        if (active != nullptr && !retired.push(active)) {
+            return active;
+        }
+        // No notify here either: the worker frees the old set within its poll interval
+        active = ready.exchange(nullptr, std::memory_order_acq_rel);
+
+        BuffersChangedEvent event;
+        event.source = this;
+        event.context = context;
+        event.numBeats = active->numBeats;
+        event.globalSize = active->globalSize;
+        event.samplesPerBeat = active->samplesPerBeat;
+        event.buffers = active;
+        fireBuffersChanged(event);
+        return active;
+    }
+
+    /**
+     * Currently active set (audio thread)
+     */
+    BeatBufferSet* getActive() const noexcept { return active; }
+};
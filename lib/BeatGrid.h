@@ -0,0 +1,237 @@
+#pragma once
+
+#include "TransportInfo.h"
+#include <array>
+#include <cmath>
+
+/**
+ * One grid line inside the current block
+ */
+struct GridBoundary {
+    int sampleOffset = 0;          // First sample at or after the grid line (0 .. numSamples-1)
+    double ppq = 0.0;              // Musical position in quarter notes
+    long long index = 0;           // Subdivision index: ppq * subdivisionsPerQuarter
+    bool isBeat = false;           // On a beat of the time signature
+    bool isBar = false;            // On a bar start
+    bool afterJump = false;        // First line after a loop wrap or relocation
+};
+
+/**
+ * BeatGrid
+ *
+ * Per-block beat grid: the sample offsets of all subdivision lines that fall inside the block,
+ * computed once per block from the host PPQ position so tempo-synced code reads a small fixed
+ * array instead of doing its own floating-point time math per event.
+ *
+ * - Position comes from TransportInfo::ppqPosition; without one (offline tools) the grid runs
+ *   free from 0 at play start, advancing with each block's tempo.
+ * - Tempo changes are picked up per block (the host reports one tempo per block).
+ * - A loop wrap inside the block splits it in two segments; the first line after the wrap (and
+ *   after any relocation) is flagged afterJump.
+ * - Between contiguous blocks, a line exactly on the block edge is reported once, at offset 0 of
+ *   the later block, even if the host PPQ jitters by a fraction of a sample.
+ * - Bars and beats follow the time signature and bar start reported by the host (4/4 from 0 if
+ *   none).
+ *
+ * At most maxBoundaries lines per block are kept; further ones are counted as dropped.
+ *
+ * Usage:
+ *   BeatGrid grid;
+ *   grid.setSubdivisionsPerQuarter(4);             // 16th notes
+ *   grid.update(numSamples, sampleRate, bpm, transport);
+ *   for (const GridBoundary& line : grid) { ... line.sampleOffset ... }
+ */
+class BeatGrid {
+public:
+    static constexpr int maxBoundaries = 64;
+    static constexpr int maxSubdivisionsPerQuarter = 48;
+
+private:
+    static constexpr double ppqEpsilon = 1e-9;
+
+    std::array<GridBoundary, maxBoundaries> boundaries {};
+    int numBoundaries = 0;
+    int subdivisionsPerQuarter = 4;
+
+    // Current block
+    bool valid = false;
+    int blockSamples = 0;
+    double blockStartPpq = 0.0;
+    double ppqPerSample = 0.0;
+    int loopWrapSample = -1;
+    double wrapSamplePpq = 0.0;        // Position of sample loopWrapSample
+
+    // Continuity between blocks
+    bool continuous = false;
+    double expectedPpq = 0.0;          // Host PPQ the next block should start at
+    long long nextIndex = 0;           // First line not yet reported
+    bool jumpPending = false;          // Flag the next reported line afterJump
+    double freeRunningPpq = 0.0;
+
+    long long droppedCount = 0;
+
+    // Bar/beat layout of the current block
+    double barStartPpq = 0.0;
+    double beatLength = 1.0;
+    double barLength = 4.0;
+
+    static bool isMultipleOf(double value, double length) noexcept {
+        const double ratio = value / length;
+        return std::abs(ratio - std::round(ratio)) < 1e-6;
+    }
+
+    long long firstIndexAtOrAfter(double ppq) const noexcept {
+        return static_cast<long long>(std::ceil(ppq * subdivisionsPerQuarter - 1e-6));
+    }
+
+    /**
+     * Report the lines from index `first` in [segmentStart, segmentEnd), the segment beginning at
+     * block sample sampleBase. Returns the first index not reported.
+     */
+    long long addSegment(long long first, double segmentStart, double segmentEnd, int sampleBase) noexcept {
+        long long index = first;
+        for (;; ++index) {
+            const double ppq = static_cast<double>(index) / subdivisionsPerQuarter;
+            if (ppq >= segmentEnd - ppqEpsilon) {
+                break;
+            }
+            const double samplesIn = (ppq - segmentStart) / ppqPerSample;
+            const int offset = sampleBase + (samplesIn > 0.0 ? static_cast<int>(std::ceil(samplesIn - 1e-6)) : 0);
+            if (offset >= blockSamples) {
+                break;
+            }
+            if (numBoundaries == maxBoundaries) {
+                ++droppedCount;
+                continue;
+            }
+            GridBoundary& line = boundaries[static_cast<size_t>(numBoundaries++)];
+            line.sampleOffset = offset;
+            line.ppq = ppq;
+            line.index = index;
+            line.isBeat = isMultipleOf(ppq - barStartPpq, beatLength);
+            line.isBar = isMultipleOf(ppq - barStartPpq, barLength);
+            line.afterJump = jumpPending;
+            jumpPending = false;
+        }
+        return index;
+    }
+
+public:
+    /**
+     * Grid resolution: lines per quarter note (1 = quarters, 4 = 16ths, 3 = 8th triplets, ...)
+     */
+    void setSubdivisionsPerQuarter(int subdivisions) noexcept {
+        const int clamped = subdivisions < 1 ? 1 : (subdivisions > maxSubdivisionsPerQuarter ? maxSubdivisionsPerQuarter : subdivisions);
+        if (clamped != subdivisionsPerQuarter) {
+            subdivisionsPerQuarter = clamped;
+            continuous = false;
+        }
+    }
+
+    int getSubdivisionsPerQuarter() const noexcept { return subdivisionsPerQuarter; }
+
+    /**
+     * Forget the position (next block starts a new grid run)
+     */
+    void reset() noexcept {
+        numBoundaries = 0;
+        valid = false;
+        continuous = false;
+        jumpPending = false;
+        freeRunningPpq = 0.0;
+        loopWrapSample = -1;
+    }
+
+    /**
+     * Compute the grid for one block (audio thread, no allocation).
+     * The grid is empty while stopped or without tempo/sample rate.
+     */
+    void update(int numSamples, double sampleRate, double bpm, const TransportInfo& transport) noexcept {
+        numBoundaries = 0;
+        loopWrapSample = -1;
+        blockSamples = numSamples;
+
+        if (!transport.isValid || !transport.isPlaying || bpm <= 0.0 || sampleRate <= 0.0 || numSamples <= 0) {
+            valid = false;
+            continuous = false;
+            freeRunningPpq = 0.0;
+            return;
+        }
+        valid = true;
+        ppqPerSample = bpm / (60.0 * sampleRate);
+        blockStartPpq = transport.hasPpqPosition ? transport.ppqPosition : freeRunningPpq;
+
+        const bool hasTimeSignature = transport.hasTimeSignature && transport.timeSigNumerator > 0 && transport.timeSigDenominator > 0;
+        beatLength = hasTimeSignature ? 4.0 / transport.timeSigDenominator : 1.0;
+        barLength = beatLength * (hasTimeSignature ? transport.timeSigNumerator : 4);
+        barStartPpq = transport.hasBarStart ? transport.ppqPositionOfLastBarStart : 0.0;
+
+        // Up to one sample of host jitter still counts as contiguous. After a jump, a line up to one
+        // sample before the reported start (e.g. the loop start) is still reported, at offset 0.
+        const bool jumped = !continuous || std::abs(blockStartPpq - expectedPpq) > ppqPerSample;
+        const long long first = jumped ? firstIndexAtOrAfter(blockStartPpq - ppqPerSample) : nextIndex;
+        jumpPending = jumpPending || jumped;
+
+        // A start up to one sample past the loop end (host jitter) wraps at sample 0
+        double blockEndPpq = blockStartPpq + numSamples * ppqPerSample;
+        const bool wraps = transport.isLooping && transport.hasLoopPoints
+            && transport.loopEndPpq > transport.loopStartPpq
+            && blockStartPpq < transport.loopEndPpq + ppqPerSample && blockEndPpq > transport.loopEndPpq + ppqEpsilon;
+
+        if (wraps) {
+            const double samplesToEnd = (transport.loopEndPpq - blockStartPpq) / ppqPerSample;
+            loopWrapSample = samplesToEnd > 0.0 ? static_cast<int>(std::ceil(samplesToEnd - 1e-6)) : 0;
+            if (loopWrapSample >= numSamples) {
+                loopWrapSample = -1;
+            }
+        }
+
+        if (loopWrapSample < 0) {
+            nextIndex = addSegment(first, blockStartPpq, blockEndPpq, 0);
+        } else {
+            addSegment(first, blockStartPpq, transport.loopEndPpq, 0);
+            jumpPending = true;
+            // Position of sample loopWrapSample (just past the loop start) and of the block end
+            const double wrapPpq = transport.loopStartPpq;
+            wrapSamplePpq = wrapPpq + (blockStartPpq + loopWrapSample * ppqPerSample - transport.loopEndPpq);
+            blockEndPpq = wrapPpq + (blockEndPpq - transport.loopEndPpq);
+            nextIndex = addSegment(firstIndexAtOrAfter(wrapPpq), wrapSamplePpq, blockEndPpq, loopWrapSample);
+        }
+
+        expectedPpq = blockEndPpq;
+        freeRunningPpq = blockEndPpq;
+        continuous = true;
+    }
+
+    // Current block
+
+    bool isValid() const noexcept { return valid; }
+    int size() const noexcept { return numBoundaries; }
+    const GridBoundary& operator[](int index) const noexcept { return boundaries[static_cast<size_t>(index)]; }
+    const GridBoundary* begin() const noexcept { return boundaries.data(); }
+    const GridBoundary* end() const noexcept { return boundaries.data() + numBoundaries; }
+
+    double getBlockStartPpq() const noexcept { return blockStartPpq; }
+    double getPpqPerSample() const noexcept { return ppqPerSample; }
+
+    /**
+     * Musical position (quarter notes) of a sample of the current block, after a loop wrap
+     * counted from the loop start
+     */
+    double ppqAtSample(int sampleOffset) const noexcept {
+        if (loopWrapSample >= 0 && sampleOffset >= loopWrapSample) {
+            return wrapSamplePpq + (sampleOffset - loopWrapSample) * ppqPerSample;
+        }
+        return blockStartPpq + sampleOffset * ppqPerSample;
+    }
+
+    /**
+     * Sample at which the block wrapped to the loop start, -1 if it did not
+     */
+    int getLoopWrapSample() const noexcept { return loopWrapSample; }
+
+    /**
+     * Lines that did not fit into maxBoundaries (since construction)
+     */
+    long long getDroppedCount() const noexcept { return droppedCount; }
+};
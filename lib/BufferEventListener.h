@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Event.h"
+
+struct BeatBufferSet;
+
+/**
+ * Buffers Changed Event
+ * Fired when the beat-length buffers were resized (tempo or sample rate change)
+ */
+struct BuffersChangedEvent : public Event {
+    int numBeats = 1;
+    int globalSize = 0;                   // Samples per buffer (numBeats beats)
+    double samplesPerBeat = 0.0;
+    BeatBufferSet* buffers = nullptr;     // The newly installed buffers (nullptr if the source has none)
+};
+
+/**
+ * Listener interface for BUFFERS events
+ *
+ * Mirrors the Lua pattern:
+ *   BUFFERS:addEventListener(function(inEvent) ... end)
+ */
+class BufferEventListener {
+public:
+    virtual ~BufferEventListener() = default;
+
+    /**
+     * Called when the beat buffers changed size
+     * @param event Contains the new sizes (and the new buffers, if any)
+     */
+    virtual void onBuffersChanged(const BuffersChangedEvent& event) {
+        // Default empty implementation - override if needed
+        (void)event;
+    }
+};
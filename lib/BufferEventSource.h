@@ -0,0 +1,23 @@
+#pragma once
+
+#include "EventSource.h"
+#include "BufferEventListener.h"
+
+/**
+ * EventSource for BUFFERS events
+ *
+ * Usage:
+ *   BufferEventSource buffers;
+ *   buffers.addEventListener(&myListener);
+ *   buffers.fireBuffersChanged(event);
+ */
+class BufferEventSource : public EventSource<BufferEventListener> {
+public:
+    /**
+     * Fire a BuffersChanged event to all listeners
+     * @param event The event to fire
+     */
+    void fireBuffersChanged(const BuffersChangedEvent& event) {
+        forEachListener([&event](BufferEventListener* listener) { listener->onBuffersChanged(event); });
+    }
+};
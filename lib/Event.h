@@ -1,6 +1,6 @@
 #pragma once
 
-#include <juce_audio_processors/juce_audio_processors.h>
+#include "TransportInfo.h"
 
 /**
  * Base Event class - mirrors the Lua event table structure
@@ -8,20 +8,18 @@
  */
 struct Event {
     virtual ~Event() = default;
-    
+
     // Source that fired this event
     const void* source = nullptr;
-    
+
     // Context from DAW (position, samples, etc.)
     // This mirrors the CONTEXT field in Lua events
     struct Context {
-        const juce::AudioBuffer<float>* buffer = nullptr;
         int numberOfSamplesInFrame = 0;
-        const juce::MidiBuffer* midiBuffer = nullptr;
-        const juce::Optional<juce::AudioPlayHead::PositionInfo>* positionInfo = nullptr;
+        const TransportInfo* transport = nullptr;
         int epoch = 0;
     } context;
-    
+
 protected:
     Event() = default;
-};
\ No newline at end of file
+};
@@ -2,6 +2,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include "Event.h"
 
 /**
@@ -9,47 +12,179 @@
  * 
  * Provides common listener management functionality for all event sources.
  * Eliminates code duplication between different EventSource types.
+ *
+ * Threading (RCU-style copy-on-write):
+ * - The listener list is an immutable snapshot published through an atomic pointer.
+ * - addEventListener/removeEventListener (message thread, or any non-audio thread; serialized
+ *   by a lock) copy the current snapshot, modify the copy and swap it in.
+ * - Dispatch (forEachListener, typically on the audio thread) is wait-free: it announces itself
+ *   in a reader counter, loads the snapshot and iterates it. No lock, no allocation.
+ * - Replaced snapshots are reclaimed once no dispatch is in flight. removeEventListener waits for
+ *   in-flight dispatches to finish (a grace period), so the removed listener can be destroyed
+ *   right after it returns. Called from inside a dispatch (a listener removing itself) it does
+ *   not wait; the old snapshot is then reclaimed on a later registration or by the destructor.
  * 
  * @tparam ListenerType The listener interface type (e.g., GlobalsEventListener)
  */
 template<typename ListenerType>
 class EventSource {
+private:
+    struct ListenerList {
+        std::vector<ListenerType*> listeners;
+    };
+
+    std::atomic<const ListenerList*> current { nullptr };   // nullptr = no listeners
+    mutable std::atomic<int> activeReaders { 0 };
+
+    // Writer side (never touched by dispatch)
+    std::mutex writeLock;
+    std::vector<const ListenerList*> retired;
+
+    // Dispatch nesting of the calling thread (sources of this listener type): no grace-period
+    // wait from inside a callback, the thread would wait for itself
+    static int& dispatchDepth() noexcept {
+        static thread_local int depth = 0;
+        return depth;
+    }
+
+    class ReadGuard {
+    private:
+        const EventSource& source;
+
+    public:
+        explicit ReadGuard(const EventSource& sourceToRead) noexcept : source(sourceToRead) {
+            source.activeReaders.fetch_add(1, std::memory_order_seq_cst);
+            ++dispatchDepth();
+        }
+        ~ReadGuard() {
+            --dispatchDepth();
+            source.activeReaders.fetch_sub(1, std::memory_order_seq_cst);
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    // Call with writeLock held
+    void publish(const ListenerList* next, bool waitForReaders) {
+        const ListenerList* previous = current.exchange(next, std::memory_order_seq_cst);
+        if (previous != nullptr) {
+            retired.push_back(previous);
+        }
+
+        if (waitForReaders && dispatchDepth() == 0) {
+            // Grace period: every dispatch that could still see an older snapshot has finished
+            while (activeReaders.load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+        }
+        reclaimRetired();
+    }
+
+    // Call with writeLock held
+    void reclaimRetired() {
+        if (!retired.empty() && activeReaders.load(std::memory_order_seq_cst) == 0) {
+            for (const ListenerList* list : retired) {
+                delete list;
+            }
+            retired.clear();
+        }
+    }
+
 protected:
-    std::vector<ListenerType*> listeners;
+    /**
+     * Call fn(listener) for each listener of the current snapshot (wait-free, no allocation).
+     * Listeners added or removed during the dispatch take effect from the next dispatch.
+     */
+    template<typename Fn>
+    void forEachListener(Fn&& fn) const {
+        const ReadGuard guard(*this);
+        const ListenerList* list = current.load(std::memory_order_seq_cst);
+        if (list == nullptr) {
+            return;
+        }
+        for (ListenerType* listener : list->listeners) {
+            fn(listener);
+        }
+    }
     
 public:
-    virtual ~EventSource() = default;
+    EventSource() = default;
+    EventSource(const EventSource&) = delete;
+    EventSource& operator=(const EventSource&) = delete;
+
+    /**
+     * Destroy the snapshots. No dispatch may be running (the owner is going away).
+     */
+    virtual ~EventSource() {
+        delete current.load(std::memory_order_relaxed);
+        for (const ListenerList* list : retired) {
+            delete list;
+        }
+    }
     
     /**
-     * Add a listener
+     * Add a listener (not from the audio thread: allocates and locks)
      * @param listener Pointer to listener (must outlive this EventSource or be removed)
      * @return The listener pointer (for chaining or storing the handle)
      */
     ListenerType* addEventListener(ListenerType* listener) {
-        if (listener && std::find(listeners.begin(), listeners.end(), listener) == listeners.end()) {
-            listeners.push_back(listener);
+        if (listener == nullptr) {
+            return listener;
+        }
+        const std::lock_guard<std::mutex> lock(writeLock);
+        const ListenerList* list = current.load(std::memory_order_relaxed);
+        if (list != nullptr && std::find(list->listeners.begin(), list->listeners.end(), listener) != list->listeners.end()) {
+            return listener;
+        }
+
+        auto* next = new ListenerList();
+        if (list != nullptr) {
+            next->listeners.reserve(list->listeners.size() + 1);
+            next->listeners.insert(next->listeners.end(), list->listeners.begin(), list->listeners.end());
         }
+        next->listeners.push_back(listener);
+        publish(next, false);
         return listener;
     }
     
     /**
-     * Remove a listener
+     * Remove a listener (not from the audio thread: allocates and locks).
+     * Returns after in-flight dispatches finished, so the listener can be destroyed afterwards.
      * @param listener Pointer to listener to remove
      * @return true if listener was found and removed
      */
     bool removeEventListener(ListenerType* listener) {
-        auto it = std::find(listeners.begin(), listeners.end(), listener);
-        if (it != listeners.end()) {
-            listeners.erase(it);
-            return true;
+        const std::lock_guard<std::mutex> lock(writeLock);
+        const ListenerList* list = current.load(std::memory_order_relaxed);
+        if (list == nullptr) {
+            return false;
+        }
+        auto it = std::find(list->listeners.begin(), list->listeners.end(), listener);
+        if (it == list->listeners.end()) {
+            return false;
+        }
+
+        const ListenerList* next = nullptr;
+        if (list->listeners.size() > 1) {
+            auto* copy = new ListenerList();
+            copy->listeners.reserve(list->listeners.size() - 1);
+            for (ListenerType* other : list->listeners) {
+                if (other != listener) {
+                    copy->listeners.push_back(other);
+                }
+            }
+            next = copy;
         }
-        return false;
+        publish(next, true);
+        return true;
     }
     
     /**
      * Get number of registered listeners
      */
     size_t getListenerCount() const {
-        return listeners.size();
+        const ReadGuard guard(*this);
+        const ListenerList* list = current.load(std::memory_order_seq_cst);
+        return list != nullptr ? list->listeners.size() : 0;
     }
-};
\ No newline at end of file
+};
@@ -6,8 +6,11 @@
  */
 
 #include "SyncGlobals.h"
-#include "EventSource.h"
+#include "BeatBuffers.h"
+#include "BufferEventSource.h"
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 /**
  * Example 1: Simple listener for GLOBALS events
@@ -103,8 +106,8 @@ int main() {
     std::cout << "=== C++ EventSource Example ===" << std::endl;
     std::cout << std::endl;
     
-    // Get the singleton GLOBALS instance
-    auto& globals = SyncGlobals::getInstance();
+    // The GLOBALS instance (one per plugin instance)
+    SyncGlobals globals;
     
     // Create a simple listener
     SimpleGlobalsListener simpleListener;
@@ -158,6 +161,35 @@ int main() {
     std::cout << "Listeners removed." << std::endl;
     std::cout << "GLOBALS has " << globals.getListenerCount() << " listeners" << std::endl;
     std::cout << "BUFFERS has " << buffers.getListenerCount() << " listeners" << std::endl;
-    
+    std::cout << std::endl;
+
+    // Example 5: BeatBuffers allocates on its own thread, processBlock only swaps
+    std::cout << "--- BeatBuffers (background allocation) ---" << std::endl;
+    BeatBuffers beatBuffers(4, 2);
+    globals.addEventListener(&beatBuffers);
+    beatBuffers.addEventListener(&clientPaths);
+
+    TransportInfo transport;
+    transport.isValid = true;
+    transport.hasBpm = true;
+    transport.bpm = 120.0;
+    for (int block = 0; block < 200; ++block) {
+        if (block == 100) {
+            transport.bpm = 90.0;
+        }
+        // What processBlock would do
+        Event::Context ctx = globals.updateDAWGlobals(512, transport);
+        BeatBufferSet* set = beatBuffers.update(ctx);
+        globals.finishRun(512);
+        (void)set;
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    if (BeatBufferSet* set = beatBuffers.getActive()) {
+        std::cout << "Active beat buffers: " << set->numChannels << " x " << set->globalSize
+                  << " samples (" << beatBuffers.getBuildCount() << " built)" << std::endl;
+    }
+    beatBuffers.removeEventListener(&clientPaths);
+    globals.removeEventListener(&beatBuffers);
+
     return 0;
 }
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "SyncGlobals.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * SeqlockSlot
+ *
+ * Latest value of a small trivially copyable T, written by one thread and read by another.
+ * store() never blocks (sequence bump + word stores); load() retries while a store is in
+ * progress. A newer store simply replaces the older value.
+ */
+template<typename T>
+class SeqlockSlot {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqlockSlot needs a trivially copyable type");
+
+private:
+    static constexpr size_t numWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<unsigned> sequence { 0 };                 // Odd while a store is in progress
+    std::array<std::atomic<uint64_t>, numWords> words {};
+
+public:
+    /**
+     * Writer thread only
+     */
+    void store(const T& value) noexcept {
+        uint64_t buffer[numWords] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        const unsigned s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < numWords; ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * Any thread; returns a consistent copy of the last stored value
+     */
+    T load() const noexcept {
+        uint64_t buffer[numWords];
+        unsigned before = 0;
+        unsigned after = 0;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < numWords; ++i) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1u) != 0 || before != after);
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+};
+
+/**
+ * GlobalsEventBridge
+ *
+ * Moves GLOBALS events (BPM, IsPlaying, SampleRate) off the audio thread.
+ * The bridge listens to SyncGlobals on the audio thread, where each event only stores its new
+ * value in a fixed mailbox slot and sets a pending bit (no lock, no allocation). deliver(),
+ * called periodically from one consumer thread (editor timer, worker loop), fires the pending
+ * events to the bridge's own listeners on that thread.
+ *
+ * Events are coalesced: between two deliver() calls only the latest value of each type is kept.
+ * The delivered event carries the value seen at the previous delivery as old value, and a value
+ * that ends where it started (e.g. stop + start within one interval) is not delivered. Delivered
+ * events keep numberOfSamplesInFrame and epoch of the last audio block but have no transport
+ * (context.transport is nullptr; the host snapshot is only valid inside processBlock).
+ *
+ * Use one bridge per consumer thread; listeners register on the bridge of the thread they want
+ * to be called on.
+ *
+ * Usage:
+ *   GlobalsEventBridge uiBridge;
+ *   syncGlobals.addEventListener(&uiBridge);   // audio thread side
+ *   uiBridge.addEventListener(&editor);        // message thread side
+ *
+ *   // Editor timer:
+ *   uiBridge.deliver();
+ */
+class GlobalsEventBridge : public GlobalsEventListener, public GlobalsEventSource {
+private:
+    struct FrameStamp {
+        int numberOfSamplesInFrame = 0;
+        int epoch = 0;
+    };
+
+    struct BPMMessage {
+        BPMEvent::Values values;
+        FrameStamp frame;
+    };
+
+    struct IsPlayingMessage {
+        bool value = false;
+        FrameStamp frame;
+    };
+
+    struct SampleRateMessage {
+        double rate = 0.0;
+        FrameStamp frame;
+    };
+
+    enum PendingBits : unsigned {
+        bpmPending = 1u << 0,
+        isPlayingPending = 1u << 1,
+        sampleRatePending = 1u << 2
+    };
+
+    // Mailbox (audio thread -> consumer)
+    SeqlockSlot<BPMMessage> bpmSlot;
+    SeqlockSlot<IsPlayingMessage> isPlayingSlot;
+    SeqlockSlot<SampleRateMessage> sampleRateSlot;
+    std::atomic<unsigned> pending { 0 };
+
+    std::atomic<uint64_t> postedCount { 0 };
+    std::atomic<uint64_t> deliveredCount { 0 };
+
+    // Consumer thread only: values at the last delivery
+    BPMEvent::Values deliveredBPM;
+    bool deliveredIsPlaying = false;
+    double deliveredSampleRate = 0.0;
+
+    static FrameStamp stampOf(const Event::Context& context) noexcept {
+        return { context.numberOfSamplesInFrame, context.epoch };
+    }
+
+    static Event::Context contextOf(const FrameStamp& frame) noexcept {
+        Event::Context context;
+        context.numberOfSamplesInFrame = frame.numberOfSamplesInFrame;
+        context.epoch = frame.epoch;
+        return context;
+    }
+
+    void post(unsigned bit) noexcept {
+        pending.fetch_or(bit, std::memory_order_release);
+        // Sample rate events come from the message thread (prepareToPlay), the others from the audio thread
+        postedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    // Audio thread side (GlobalsEventListener): one slot store per event. Each slot has a single
+    // writer; onSampleRateChanged runs where the sample rate is set (the message thread)
+
+    void onBPMChanged(const BPMEvent& event) override {
+        bpmSlot.store({ event.newValues, stampOf(event.context) });
+        post(bpmPending);
+    }
+
+    void onIsPlayingChanged(const IsPlayingEvent& event) override {
+        isPlayingSlot.store({ event.newValue, stampOf(event.context) });
+        post(isPlayingPending);
+    }
+
+    void onSampleRateChanged(const SampleRateEvent& event) override {
+        sampleRateSlot.store({ event.newRate, stampOf(event.context) });
+        post(sampleRatePending);
+    }
+
+    /**
+     * Consumer thread: fire the pending (coalesced) events to this bridge's listeners,
+     * in SyncGlobals order (sample rate, BPM, playing state).
+     * @return Number of events fired
+     */
+    int deliver() {
+        const unsigned bits = pending.exchange(0, std::memory_order_acquire);
+        if (bits == 0) {
+            return 0;
+        }
+        int fired = 0;
+
+        if ((bits & sampleRatePending) != 0) {
+            const SampleRateMessage message = sampleRateSlot.load();
+            if (message.rate != deliveredSampleRate) {
+                SampleRateEvent event;
+                event.source = this;
+                event.context = contextOf(message.frame);
+                event.oldRate = deliveredSampleRate;
+                event.newRate = message.rate;
+                deliveredSampleRate = message.rate;
+                fireSampleRateChanged(event);
+                ++fired;
+            }
+        }
+
+        if ((bits & bpmPending) != 0) {
+            const BPMMessage message = bpmSlot.load();
+            if (message.values.bpm != deliveredBPM.bpm || message.values.samplesPerBeat != deliveredBPM.samplesPerBeat) {
+                BPMEvent event;
+                event.source = this;
+                event.context = contextOf(message.frame);
+                event.oldValues = deliveredBPM;
+                event.newValues = message.values;
+                deliveredBPM = message.values;
+                fireBPMChanged(event);
+                ++fired;
+            }
+        }
+
+        if ((bits & isPlayingPending) != 0) {
+            const IsPlayingMessage message = isPlayingSlot.load();
+            if (message.value != deliveredIsPlaying) {
+                IsPlayingEvent event;
+                event.source = this;
+                event.context = contextOf(message.frame);
+                event.oldValue = deliveredIsPlaying;
+                event.newValue = message.value;
+                deliveredIsPlaying = message.value;
+                fireIsPlayingChanged(event);
+                ++fired;
+            }
+        }
+
+        deliveredCount.fetch_add(static_cast<uint64_t>(fired), std::memory_order_relaxed);
+        return fired;
+    }
+
+    /**
+     * Values as of the last deliver() (consumer thread), e.g. to initialise a newly opened view
+     */
+    const BPMEvent::Values& getBPMValues() const noexcept { return deliveredBPM; }
+    bool getIsPlaying() const noexcept { return deliveredIsPlaying; }
+    double getSampleRate() const noexcept { return deliveredSampleRate; }
+
+    /**
+     * Events received on the audio thread / fired by deliver() (the difference was coalesced)
+     */
+    uint64_t getPostedCount() const noexcept { return postedCount.load(std::memory_order_relaxed); }
+    uint64_t getDeliveredCount() const noexcept { return deliveredCount.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * SpscQueue
+ *
+ * Fixed-capacity, lock-free single-producer/single-consumer ring buffer.
+ * push() is only called from the producer thread, pop() only from the consumer thread.
+ *
+ * Usage:
+ *   SpscQueue<Item, 4096> queue;
+ *   queue.push(item);            // producer, false if full
+ *   Item out;
+ *   while (queue.pop(out)) { }   // consumer
+ */
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    std::array<T, Capacity> items {};
+    alignas(64) std::atomic<size_t> head { 0 };   // Next slot to read (consumer)
+    alignas(64) std::atomic<size_t> tail { 0 };   // Next slot to write (producer)
+
+public:
+    bool push(const T& item) noexcept {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) noexcept {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Peek at the oldest item without removing it (consumer only)
+     */
+    const T* front() const noexcept {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &items[h & (Capacity - 1)];
+    }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+/**
+ * StaticListenerSet
+ *
+ * Compile-time composed set of listeners with known concrete types.
+ * Counterpart of the dynamic EventSource listener vector for listeners that are fixed by the
+ * design (e.g. ChordPatternCoordinator on SyncGlobals): dispatch is a direct, qualified
+ * (non-virtual) call per listener that the compiler can inline. Each slot is bound at runtime
+ * (the listener objects are usually created after the event source) and skipped while unbound.
+ *
+ * Dispatch goes through forEach(fn), which calls fn(listener) for each bound listener in
+ * template argument order. Event sources wrap it into their own fire* functions, see
+ * GlobalsStaticDispatch.
+ *
+ * Usage:
+ *   StaticListenerSet<ChordPatternCoordinator, Meter> set;
+ *   set.bind(coordinator);
+ *   set.bind(meter);
+ *   set.forEach([&](auto& listener) { listener.onSomething(event); });
+ */
+template<typename... Listeners>
+class StaticListenerSet {
+private:
+    std::tuple<Listeners*...> listeners {};
+
+public:
+    static constexpr size_t size = sizeof...(Listeners);
+
+    /**
+     * Bind the slot of listener's type (one slot per type)
+     */
+    template<typename Listener>
+    void bind(Listener& listener) noexcept {
+        std::get<Listener*>(listeners) = &listener;
+    }
+
+    template<typename Listener>
+    void unbind() noexcept {
+        std::get<Listener*>(listeners) = nullptr;
+    }
+
+    template<typename Listener>
+    Listener* get() const noexcept {
+        return std::get<Listener*>(listeners);
+    }
+
+    /**
+     * Call fn(listener&) for every bound listener, in declaration order
+     */
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        std::apply([&fn](Listeners*... bound) {
+            (void)fn;
+            ((bound != nullptr ? fn(*bound) : void()), ...);
+        }, listeners);
+    }
+};
+
+/**
+ * GlobalsStaticDispatch
+ *
+ * Dispatch of GLOBALS events (BPM, IsPlaying, SampleRate) to a StaticListenerSet.
+ * Calls are qualified with the listener's concrete type, so even overrides of the virtual
+ * GlobalsEventListener callbacks are called (and inlined) directly.
+ */
+template<typename... Listeners>
+class GlobalsStaticDispatch : public StaticListenerSet<Listeners...> {
+public:
+    template<typename EventType>
+    void fireBPMChanged(const EventType& event) const {
+        this->forEach([&event](auto& listener) {
+            using Listener = std::remove_reference_t<decltype(listener)>;
+            listener.Listener::onBPMChanged(event);
+        });
+    }
+
+    template<typename EventType>
+    void fireIsPlayingChanged(const EventType& event) const {
+        this->forEach([&event](auto& listener) {
+            using Listener = std::remove_reference_t<decltype(listener)>;
+            listener.Listener::onIsPlayingChanged(event);
+        });
+    }
+
+    template<typename EventType>
+    void fireSampleRateChanged(const EventType& event) const {
+        this->forEach([&event](auto& listener) {
+            using Listener = std::remove_reference_t<decltype(listener)>;
+            listener.Listener::onSampleRateChanged(event);
+        });
+    }
+};
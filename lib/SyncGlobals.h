@@ -1,8 +1,10 @@
 #pragma once
 
 #include "EventSource.h"
+#include "StaticListenerSet.h"
 #include "SyncGlobalsListener.h"
-#include <juce_audio_processors/juce_audio_processors.h>
+#include "TransportInfo.h"
+#include "BeatGrid.h"
 #include <cstddef>
 /**
  * EventSource for GLOBALS events
@@ -22,10 +24,8 @@ public:
      * @param event The BPM event to fire
      */
     void fireBPMChanged(const BPMEvent& event) {
-        // Iterate by index to handle potential modifications during iteration
-        for (size_t i = 0; i < listeners.size(); ++i) {
-            listeners[i]->onBPMChanged(event);
-        }
+        // Snapshot iteration: safe against concurrent add/remove (see EventSource)
+        forEachListener([&event](GlobalsEventListener* listener) { listener->onBPMChanged(event); });
     }
     
     /**
@@ -33,9 +33,7 @@ public:
      * @param event The IsPlaying event to fire
      */
     void fireIsPlayingChanged(const IsPlayingEvent& event) {
-        for (size_t i = 0; i < listeners.size(); ++i) {
-            listeners[i]->onIsPlayingChanged(event);
-        }
+        forEachListener([&event](GlobalsEventListener* listener) { listener->onIsPlayingChanged(event); });
     }
     
     /**
@@ -43,23 +41,35 @@ public:
      * @param event The SampleRate event to fire
      */
     void fireSampleRateChanged(const SampleRateEvent& event) {
-        for (size_t i = 0; i < listeners.size(); ++i) {
-            listeners[i]->onSampleRateChanged(event);
-        }
+        forEachListener([&event](GlobalsEventListener* listener) { listener->onSampleRateChanged(event); });
     }
 };
 /**
- * SyncGlobals - Singleton that tracks DAW global state
+ * SyncGlobals - tracks DAW global state (one instance per plugin instance)
  * 
  * This is a C++ translation of the Lua SyncGlobals module.
  * Tracks BPM, sample rate, and playing state, firing events when they change.
+ *
+ * Listeners come in two flavours:
+ * - Static listeners: concrete types fixed at compile time (StaticListeners, a
+ *   GlobalsStaticDispatch<...>), called directly and inlinable. Use these for the listeners
+ *   the design always has, e.g. ChordPatternCoordinator.
+ * - Dynamic listeners: any GlobalsEventListener added at runtime (virtual call per listener).
+ * Static listeners are notified first.
  * 
  * Usage:
- *   auto& globals = SyncGlobals::getInstance();
+ *   // Dynamic listeners only
+ *   SyncGlobals globals;
  *   globals.addEventListener(&myListener);
- *   globals.updateDAWGlobals(samples, numSamples, midiBuffer, position);
+ *
+ *   // Coordinator called directly
+ *   BasicSyncGlobals<GlobalsStaticDispatch<ChordPatternCoordinator>> globals;
+ *   globals.getStaticListeners().bind(coordinator);
+ *
+ *   globals.updateDAWGlobals(numSamples, transport);
  */
-class SyncGlobals : public GlobalsEventSource {
+template<typename StaticListeners = GlobalsStaticDispatch<>>
+class BasicSyncGlobals : public GlobalsEventSource {
 private:
     // PPQ (Pulses Per Quarter) base values
     struct PPQBaseValue {
@@ -78,14 +88,40 @@ private:
     double bpm = 0.0;
     double msecPerBeat = 0.0;          // Based on whole note
     double samplesPerBeat = 0.0;       // Based on whole note
+
+    BeatGrid beatGrid;                 // Grid lines of the current block
+
+    StaticListeners staticListeners;
+
+    void dispatchBPMChanged(const BPMEvent& event) {
+        staticListeners.fireBPMChanged(event);
+        fireBPMChanged(event);
+    }
+
+    void dispatchIsPlayingChanged(const IsPlayingEvent& event) {
+        staticListeners.fireIsPlayingChanged(event);
+        fireIsPlayingChanged(event);
+    }
+
+    void dispatchSampleRateChanged(const SampleRateEvent& event) {
+        staticListeners.fireSampleRateChanged(event);
+        fireSampleRateChanged(event);
+    }
     
 public:
     // Default constructor
-    SyncGlobals() = default;
+    BasicSyncGlobals() = default;
     
     // Delete copy constructor and assignment
-    SyncGlobals(const SyncGlobals&) = delete;
-    SyncGlobals& operator=(const SyncGlobals&) = delete;
+    BasicSyncGlobals(const BasicSyncGlobals&) = delete;
+    BasicSyncGlobals& operator=(const BasicSyncGlobals&) = delete;
+
+    /**
+     * Compile-time listener set (bind/unbind the concrete listeners here)
+     */
+    StaticListeners& getStaticListeners() noexcept {
+        return staticListeners;
+    }
     
     /**
      * Mark end of processing run
@@ -124,6 +160,20 @@ public:
         return sampleRate;
     }
     
+    /**
+     * Grid lines (sample offsets) of the current block, computed by updateDAWGlobals
+     */
+    const BeatGrid& getBeatGrid() const noexcept {
+        return beatGrid;
+    }
+
+    /**
+     * Grid resolution in lines per quarter note (default 4 = 16ths)
+     */
+    void setGridSubdivisionsPerQuarter(int subdivisions) noexcept {
+        beatGrid.setSubdivisionsPerQuarter(subdivisions);
+    }
+
     /**
      * Check if DAW is playing
      */
@@ -152,7 +202,7 @@ public:
             event.oldRate = oldSampleRate;
             event.newRate = newSampleRate;
             
-            fireSampleRateChanged(event);
+            dispatchSampleRateChanged(event);
         }
     }
     
@@ -160,46 +210,40 @@ public:
      * Update DAW globals at the beginning of a new frame
      * This mirrors the Lua updateDAWGlobals function
      * 
-     * @param buffer Audio buffer for this frame
-     * @param midiBuffer MIDI buffer for this frame
-     * @param positionInfo DAW position info
+     * @param numSamples Number of samples in this frame
+     * @param transport Host transport snapshot for this frame
      * @return Context object for this frame
      */
-    Event::Context updateDAWGlobals(const juce::AudioBuffer<float>& buffer,
-                                     const juce::MidiBuffer& midiBuffer,
-                                     const juce::Optional<juce::AudioPlayHead::PositionInfo>& positionInfo) {
+    Event::Context updateDAWGlobals(int numSamples, const TransportInfo& transport) {
         // Create context for this frame
         Event::Context ctx;
-        ctx.buffer = &buffer;
-        ctx.numberOfSamplesInFrame = buffer.getNumSamples();
-        ctx.midiBuffer = &midiBuffer;
-        ctx.positionInfo = &positionInfo;
-        ctx.epoch = runs;
+        ctx.numberOfSamplesInFrame = numSamples;
+        ctx.transport = &transport;
+        ctx.epoch = static_cast<int>(runs);
         
-        // Extract playing state from position info
-        
-        if (positionInfo.hasValue()) {
+        // Extract playing state from transport info
+        if (transport.isValid) {
             // Extract BPM if available
-            if (auto bpmValue = positionInfo->getBpm()) {
-                double newBPM = *bpmValue;
+            if (transport.hasBpm) {
+                double newBPM = transport.bpm;
                 if (newBPM != bpm && newBPM > 0.0) {
                     BPMEvent event;
                     event.source = this;
                     event.context = ctx;
                     event.oldValues = {bpm, msecPerBeat, samplesPerBeat};
-                    
+                
                     // Update values
                     bpm = newBPM;
                     msecPerBeat = ppqBase.msec / newBPM;
                     samplesPerBeat = msecPerBeat * sampleRateByMsec;
-                    
+                
                     event.newValues = {bpm, msecPerBeat, samplesPerBeat};
-                    fireBPMChanged(event);
+                    dispatchBPMChanged(event);
                 }
             }
-        
-            bool newIsPlaying = positionInfo->getIsPlaying();
+    
             // Check playing state change
+            bool newIsPlaying = transport.isPlaying;
             if (newIsPlaying != isPlaying) {
                 IsPlayingEvent event;
                 event.source = this;
@@ -207,9 +251,17 @@ public:
                 event.oldValue = isPlaying;
                 event.newValue = newIsPlaying;
                 isPlaying = newIsPlaying;
-                fireIsPlayingChanged(event);
+                dispatchIsPlayingChanged(event);
             }
         }
+
+        // After the BPM update, so a tempo change applies to this block's grid
+        beatGrid.update(numSamples, sampleRate, bpm, transport);
         return ctx;
     }
 };
+
+/**
+ * SyncGlobals with dynamic listeners only
+ */
+using SyncGlobals = BasicSyncGlobals<>;
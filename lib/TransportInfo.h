@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+ * TransportInfo
+ *
+ * Plain snapshot of the host transport for one processing block.
+ * This is the framework-independent subset of what a plugin host reports
+ * (e.g. juce::AudioPlayHead::PositionInfo), so the event system and the
+ * engine can be driven by a plugin, a command-line renderer or a test harness alike.
+ *
+ * Fields flagged by a matching has* member are only meaningful when that flag is set.
+ */
+struct TransportInfo {
+    // False when the host did not report a position for this block at all
+    bool isValid = false;
+
+    bool hasBpm = false;
+    double bpm = 0.0;
+
+    bool isPlaying = false;
+
+    // Musical position of the block's first sample, in quarter notes
+    bool hasPpqPosition = false;
+    double ppqPosition = 0.0;
+
+    // Position of the start of the current bar, in quarter notes
+    bool hasBarStart = false;
+    double ppqPositionOfLastBarStart = 0.0;
+
+    bool hasTimeSignature = false;
+    int timeSigNumerator = 4;
+    int timeSigDenominator = 4;
+
+    // Loop (cycle) range in quarter notes; only used while isLooping
+    bool hasLoopPoints = false;
+    bool isLooping = false;
+    double loopStartPpq = 0.0;
+    double loopEndPpq = 0.0;
+};
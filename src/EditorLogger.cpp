@@ -1,24 +1,37 @@
 #include "EditorLogger.h"
 #include "PluginEditor.h"
+#include "RealtimeTrap.h"
 #include <cstring>
 
 void EditorLogger::setEditor(PhuArpAudioProcessorEditor* newEditor)
 {
     editor = newEditor;
 
+    // Realtime messages are picked up by polling (the audio thread never posts)
+    if (editor != nullptr)
+        startTimer(rtPollIntervalMs);
+
     // If we accumulated messages before the editor existed, flush them now.
     requestAsyncUpdate();
 }
 
 void EditorLogger::clearEditor()
 {
+    stopTimer();
     editor = nullptr;
 }
 
+void EditorLogger::timerCallback()
+{
+    if (rtFifo.getNumReady() > 0 || rtDroppedMessages.load(std::memory_order_relaxed) > 0)
+        handleAsyncUpdate();
+}
+
 void EditorLogger::markCurrentThreadAsAudioThread() noexcept
 {
     const auto id = reinterpret_cast<uintptr_t>(juce::Thread::getCurrentThreadId());
     audioThreadId.store(id, std::memory_order_relaxed);
+    RealtimeTrap::markCurrentThreadAsAudioThread();
 }
 
 void EditorLogger::requestAsyncUpdate() noexcept
@@ -28,7 +41,14 @@ void EditorLogger::requestAsyncUpdate() noexcept
         triggerAsyncUpdate();
 }
 
-void EditorLogger::pushRealtime(const juce::String& message) noexcept
+bool EditorLogger::isAudioThread() const noexcept
+{
+    const auto currentThread = reinterpret_cast<uintptr_t>(juce::Thread::getCurrentThreadId());
+    const auto audioThread = audioThreadId.load(std::memory_order_relaxed);
+    return audioThread != 0 && currentThread == audioThread;
+}
+
+void EditorLogger::pushRealtime(const char* utf8) noexcept
 {
     int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
     rtFifo.prepareToWrite(1, start1, size1, start2, size2);
@@ -40,7 +60,6 @@ void EditorLogger::pushRealtime(const juce::String& message) noexcept
     }
 
     auto& slot = rtSlots[static_cast<size_t>(start1)];
-    const char* utf8 = message.toRawUTF8();
 
     // Copy into fixed buffer (truncate if needed).
     const size_t maxCopy = rtMaxMessageBytes - 1;
@@ -57,22 +76,58 @@ void EditorLogger::logMessage(const juce::String& message)
     // This can be called from any thread.
     // Audio thread: lock-free SPSC queue (single producer).
     // Other threads: locked queue (not real-time critical).
-    const auto currentThread = reinterpret_cast<uintptr_t>(juce::Thread::getCurrentThreadId());
-    const auto audioThread = audioThreadId.load(std::memory_order_relaxed);
+    if (isAudioThread())
+    {
+        // Picked up by timerCallback()
+        pushRealtime(message.toRawUTF8());
+        return;
+    }
+
+    {
+        const juce::ScopedLock lock(nonRealtimeLock);
+        addPending(message);
+    }
 
-    if (audioThread != 0 && currentThread == audioThread)
+    requestAsyncUpdate();
+}
+
+void EditorLogger::logEngineMessage(const char* message) noexcept
+{
+    if (isAudioThread())
     {
+        // Picked up by timerCallback()
         pushRealtime(message);
+        return;
     }
-    else
+
     {
         const juce::ScopedLock lock(nonRealtimeLock);
-        pendingMessages.add(message);
+        addPending(juce::String::fromUTF8(message));
     }
 
     requestAsyncUpdate();
 }
 
+void EditorLogger::addPending(const juce::String& message)
+{
+    pendingMessages.add(message);
+    pendingPayloadBytes += message.getNumBytesAsUTF8() + 1;
+    updatePendingMemory();
+}
+
+void EditorLogger::updatePendingMemory() noexcept
+{
+    // Array storage plus string payloads (approximate: ignores allocator overhead)
+    const size_t used = static_cast<size_t>(pendingMessages.size()) * sizeof(juce::String) + pendingPayloadBytes;
+    const size_t reserved = used + static_cast<size_t>(pendingMessages.strings.getNumAllocated() - pendingMessages.size()) * sizeof(juce::String);
+    pendingMemory.update(reserved, used);
+}
+
+MemoryUsage EditorLogger::getMemoryUsage() const
+{
+    return pendingMemory.read("EditorLogger", sizeof(EditorLogger), false);
+}
+
 void EditorLogger::handleAsyncUpdate()
 {
     // This is called on the message thread
@@ -117,12 +172,15 @@ void EditorLogger::handleAsyncUpdate()
     {
         const juce::ScopedLock lock(nonRealtimeLock);
         messages.swapWith(pendingMessages);
+        pendingPayloadBytes = 0;
+        updatePendingMemory();
     }
 
     for (const auto& msg : messages)
         editor->addLogMessage(msg);
 
     // If more messages arrived while we were draining, schedule another update.
+    // (Realtime messages are also picked up by the next timer tick.)
     if (rtFifo.getNumReady() > 0)
         requestAsyncUpdate();
     else
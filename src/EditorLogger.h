@@ -2,6 +2,8 @@
 
 #include <juce_core/juce_core.h>
 #include <juce_gui_basics/juce_gui_basics.h>
+#include "EngineLogger.h"
+#include "MemoryUsage.h"
 #include <atomic>
 #include <array>
 
@@ -13,6 +15,9 @@ class PhuArpAudioProcessorEditor;
  * 
  * Custom JUCE Logger that forwards log messages to the plugin editor's log view.
  * Thread-safe and uses AsyncUpdater to ensure GUI updates happen on the message thread.
+ * The audio thread only pushes into a lock-free queue and never posts messages itself
+ * (triggerAsyncUpdate allocates/locks); a message-thread timer polls that queue instead.
+ * Also serves as the EngineLogger of the headless engine (ChordPatternCoordinator).
  * 
  * Usage:
  *   // Call the instance logger directly (do NOT install it as the global JUCE logger)
@@ -21,17 +26,20 @@ class PhuArpAudioProcessorEditor;
  *   LOG_MESSAGE(editorLogger, "Your message");
  */
 class EditorLogger : public juce::Logger,
-                     public juce::AsyncUpdater
+                     public juce::AsyncUpdater,
+                     private juce::Timer,
+                     public EngineLogger
 {
 public:
     EditorLogger() = default;
-    ~EditorLogger() override = default;
+    ~EditorLogger() override { stopTimer(); }
 
     /**
      * Mark the calling thread as the audio thread for this plugin instance.
      *
      * This enables lock-free, allocation-free queueing of log messages from the audio thread
      * (SPSC: audio thread producer -> message thread consumer).
+     * Also marks the thread for RealtimeTrap (PHU_ARP_RT_TRAP builds).
      */
     void markCurrentThreadAsAudioThread() noexcept;
     
@@ -51,6 +59,18 @@ public:
      * Adds message to queue and triggers async update
      */
     void logMessage(const juce::String& message) override;
+
+    /**
+     * EngineLogger override - called from any thread (typically the audio thread)
+     * Plain-text variant that does not need to build a juce::String on the realtime path
+     */
+    void logEngineMessage(const char* message) noexcept override;
+
+    /**
+     * Object size (including the fixed realtime queue) and heap held by queued messages,
+     * with high-water mark since construction
+     */
+    MemoryUsage getMemoryUsage() const;
     
 protected:
     /**
@@ -59,11 +79,18 @@ protected:
      */
     void handleAsyncUpdate() override;
     
+private:
+    /**
+     * Timer override - message thread, polls the realtime queue while an editor is attached
+     */
+    void timerCallback() override;
+    
 private:
     // ---------------------------------------------------------------------
     // Real-time queue (SPSC): only the audio thread is allowed to push here.
     // ---------------------------------------------------------------------
     static constexpr int rtQueueCapacity = 1024;
+    static constexpr int rtPollIntervalMs = 50;
     static constexpr size_t rtMaxMessageBytes = 256;
 
     struct RtSlot {
@@ -82,15 +109,22 @@ private:
     // ---------------------------------------------------------------------
     juce::CriticalSection nonRealtimeLock;
     juce::StringArray pendingMessages;
+    size_t pendingPayloadBytes = 0;       // UTF-8 bytes of pendingMessages (kept as they are added)
+    MemoryGauge pendingMemory;
+
+    // Call with nonRealtimeLock held
+    void addPending(const juce::String& message);
+    void updatePendingMemory() noexcept;
 
-    // Coalesce async updates so we don't spam the message queue.
+    // Coalesce async updates so we don't spam the message queue (non-audio threads only).
     std::atomic<bool> asyncUpdateRequested { false };
     
     // Safe pointer to editor (automatically nulled when editor is destroyed)
     juce::Component::SafePointer<PhuArpAudioProcessorEditor> editor;
 
     void requestAsyncUpdate() noexcept;
-    void pushRealtime(const juce::String& message) noexcept;
+    void pushRealtime(const char* utf8) noexcept;
+    bool isAudioThread() const noexcept;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorLogger)
 };
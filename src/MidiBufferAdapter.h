@@ -0,0 +1,190 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "ChordPatternCoordinator.h"
+#include "MemoryUsage.h"
+#include "MidiEvent.h"
+#include "../lib/TransportInfo.h"
+#include <atomic>
+#include <vector>
+
+/**
+ * MidiBufferAdapter
+ *
+ * Thin JUCE adapter over the headless engine (phu-arp-core).
+ * Converts a juce::MidiBuffer to raw MidiEvents, runs ChordPatternCoordinator and writes the
+ * generated events back. Also converts the host play head into the engine's TransportInfo.
+ *
+ * Usage:
+ *   MidiBufferAdapter adapter(coordinator);
+ *
+ *   // In processBlock:
+ *   syncGlobals.updateDAWGlobals(numSamples, MidiBufferAdapter::toTransportInfo(position));
+ *   if (syncGlobals.isDawPlaying())
+ *       adapter.processBlock(midiBuffer, numSamples);
+ *   else
+ *       adapter.writeStopFlush(midiBuffer);
+ */
+class MidiBufferAdapter {
+private:
+    ChordPatternCoordinator& coordinator;
+
+    // If true, MIDI on channels other than chord/rhythm/output will be preserved.
+    // MIDI on chord/rhythm/output channels is consumed/replaced by the coordinator.
+    std::atomic<bool> passThroughOtherMidi { false };
+
+    // Scratch buffers reused per audio block (raw copy of the incoming MIDI, kept pass-through MIDI).
+    // Preallocated by prepare() so processBlock does not allocate.
+    std::vector<MidiEvent> inputEvents;
+    juce::MidiBuffer passThroughEvents;
+    MemoryGauge scratchMemory;
+
+public:
+    explicit MidiBufferAdapter(ChordPatternCoordinator& coordinatorToUse)
+        : coordinator(coordinatorToUse) {
+        prepare(ChordPatternCoordinator::defaultMaxEventsPerBlock);
+    }
+
+    /**
+     * Preallocate the scratch buffers for up to maxEventsPerBlock events (not on the audio thread)
+     */
+    void prepare(size_t maxEventsPerBlock) {
+        inputEvents.reserve(maxEventsPerBlock);
+        // MidiBuffer storage: 4-byte position + 2-byte size + up to 3 data bytes per event
+        passThroughEvents.ensureSize(maxEventsPerBlock * 12);
+        publishMemoryUsage();
+    }
+
+    /**
+     * Heap usage of the scratch buffers (any thread; as of the last processed block)
+     */
+    MemoryUsage getMemoryUsage() const noexcept {
+        return scratchMemory.read("MidiBufferAdapter", sizeof(MidiBufferAdapter), true);
+    }
+
+    void setPassThroughOtherMidi(bool shouldPassThrough) noexcept { passThroughOtherMidi.store(shouldPassThrough, std::memory_order_relaxed); }
+    bool getPassThroughOtherMidi() const noexcept { return passThroughOtherMidi.load(std::memory_order_relaxed); }
+
+    /**
+     * Convert the host play head position into a TransportInfo snapshot
+     */
+    static TransportInfo toTransportInfo(const juce::Optional<juce::AudioPlayHead::PositionInfo>& positionInfo) {
+        TransportInfo transport;
+        if (positionInfo.hasValue()) {
+            transport.isValid = true;
+            if (auto bpmValue = positionInfo->getBpm()) {
+                transport.hasBpm = true;
+                transport.bpm = *bpmValue;
+            }
+            transport.isPlaying = positionInfo->getIsPlaying();
+            if (auto ppq = positionInfo->getPpqPosition()) {
+                transport.hasPpqPosition = true;
+                transport.ppqPosition = *ppq;
+            }
+            if (auto barStart = positionInfo->getPpqPositionOfLastBarStart()) {
+                transport.hasBarStart = true;
+                transport.ppqPositionOfLastBarStart = *barStart;
+            }
+            if (auto timeSig = positionInfo->getTimeSignature()) {
+                transport.hasTimeSignature = true;
+                transport.timeSigNumerator = timeSig->numerator;
+                transport.timeSigDenominator = timeSig->denominator;
+            }
+            if (auto loop = positionInfo->getLoopPoints()) {
+                transport.hasLoopPoints = true;
+                transport.loopStartPpq = loop->ppqStart;
+                transport.loopEndPpq = loop->ppqEnd;
+            }
+            transport.isLooping = positionInfo->getIsLooping();
+        }
+        return transport;
+    }
+
+    /**
+     * Run the coordinator on a MIDI buffer.
+     *
+     * @param midiBuffer The MIDI buffer to process.
+     *                  If passThroughOtherMidi is false, it will be cleared and filled with output events.
+     *                  If passThroughOtherMidi is true, only events on the chord/rhythm/output channels are removed
+     *                  and other channels are preserved (channel messages delayed by the coordinator's
+     *                  latency, like the generated events; other messages are not delayed).
+     * @param numSamples Block length (advances the coordinator's scheduled events)
+     */
+    void processBlock(juce::MidiBuffer& midiBuffer, int numSamples) {
+        inputEvents.clear();
+        if (inputEvents.capacity() < static_cast<size_t>(midiBuffer.getNumEvents())) {
+            inputEvents.reserve(static_cast<size_t>(midiBuffer.getNumEvents()));
+        }
+
+        for (const auto metadata : midiBuffer) {
+            MidiEvent evt;
+            if (MidiEvent::fromRawData(metadata.data, metadata.numBytes, metadata.samplePosition, evt)) {
+                inputEvents.push_back(evt);
+            }
+        }
+
+        // Keep everything except chord/rhythm/output channels; with latency, channel messages go
+        // through the coordinator's delay line (before processBlock, which drains it).
+        // Copied through the preallocated scratch buffer (clear() keeps its storage); swapping
+        // would hand our storage to the host and leave us with the host's.
+        const bool passThrough = getPassThroughOtherMidi();
+        if (passThrough) {
+            passThroughEvents.clear();
+            const bool delayed = coordinator.getLatencySamples() > 0;
+
+            for (const auto metadata : midiBuffer) {
+                const bool isChannelMessage = metadata.numBytes > 0 && metadata.data[0] >= 0x80 && metadata.data[0] < 0xf0;
+                const bool isConsumed = isChannelMessage && coordinator.consumesChannel((metadata.data[0] & 0x0f) + 1);
+                if (isConsumed) {
+                    continue;
+                }
+                MidiEvent evt;
+                if (delayed && isChannelMessage
+                    && MidiEvent::fromRawData(metadata.data, metadata.numBytes, metadata.samplePosition, evt)
+                    && coordinator.delayEvent(evt)) {
+                    continue;
+                }
+                passThroughEvents.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition);
+            }
+        }
+
+        coordinator.processBlock(inputEvents.data(), inputEvents.size(), numSamples);
+
+        if (passThrough) {
+            // Add the generated output to the kept events
+            midiBuffer.clear();
+            for (const auto metadata : passThroughEvents) {
+                midiBuffer.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition);
+            }
+            writeOutputEvents(midiBuffer);
+        } else {
+            midiBuffer.clear();
+            writeOutputEvents(midiBuffer);
+        }
+        publishMemoryUsage();
+    }
+
+    /**
+     * Deliver the note-offs queued by a transport stop (if any).
+     * Replaces the buffer content, mirroring what a stopped host expects: only the cleanup note-offs.
+     */
+    void writeStopFlush(juce::MidiBuffer& midiBuffer) {
+        if (!coordinator.takeStopFlush()) {
+            return;
+        }
+        midiBuffer.clear();
+        writeOutputEvents(midiBuffer);
+    }
+
+private:
+    void publishMemoryUsage() noexcept {
+        scratchMemory.update(heapBytesOf(inputEvents) + static_cast<size_t>(passThroughEvents.data.getNumAllocated()),
+                             usedBytesOf(inputEvents) + static_cast<size_t>(passThroughEvents.data.size()));
+    }
+
+    void writeOutputEvents(juce::MidiBuffer& midiBuffer) const {
+        for (const auto& evt : coordinator.getOutputEvents()) {
+            midiBuffer.addEvent(evt.getRawData(), evt.getRawDataSize(), evt.samplePosition);
+        }
+    }
+};
@@ -1,6 +1,7 @@
 #include "PluginEditor.h"
 #include "PluginProcessor.h"
 #include "EditorLogger.h"
+#include "MemoryUsage.h"
 
 PhuArpAudioProcessorEditor::PhuArpAudioProcessorEditor(PhuArpAudioProcessor& p) 
     : AudioProcessorEditor(&p), audioProcessor(p)
@@ -17,6 +18,314 @@ PhuArpAudioProcessorEditor::PhuArpAudioProcessorEditor(PhuArpAudioProcessor& p)
     };
     addAndMakeVisible(passThroughOtherMidiToggle);
 
+    transportLabel.setJustificationType(juce::Justification::centredLeft);
+    addAndMakeVisible(transportLabel);
+
+    // Preset bank
+    presetLabel.setText("Preset", juce::dontSendNotification);
+    presetLabel.setJustificationType(juce::Justification::centredLeft);
+    presetLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(presetLabel);
+
+    presetComboBox.setTextWhenNothingSelected("No bank loaded");
+    presetComboBox.onChange = [this]
+    {
+        const int program = presetComboBox.getSelectedId() - 1;
+        if (program >= 0 && program != audioProcessor.getCurrentProgram())
+            audioProcessor.setCurrentProgram(program);
+    };
+    addAndMakeVisible(presetComboBox);
+
+    loadBankButton.setButtonText("Load Bank...");
+    loadBankButton.onClick = [this] { loadPresetBank(); };
+    addAndMakeVisible(loadBankButton);
+
+    // Note gate
+    gateLabel.setText("Gate", juce::dontSendNotification);
+    gateLabel.setJustificationType(juce::Justification::centredLeft);
+    gateLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(gateLabel);
+
+    const NoteGate gate = audioProcessor.getNoteGate();
+    gateModeComboBox.addItem("Follow trigger", 1);
+    gateModeComboBox.addItem("Fixed length", 2);
+    gateModeComboBox.addItem("Ratchet", 3);
+    gateModeComboBox.setSelectedId(static_cast<int>(gate.mode) + 1, juce::dontSendNotification);
+    gateModeComboBox.onChange = [this] { applyNoteGate(); };
+    addAndMakeVisible(gateModeComboBox);
+
+    // Item id = length in 1/192 quarters (covers straight, dotted and triplet values)
+    const std::pair<const char*, int> lengths[] = {
+        { "1/32", 24 }, { "1/16t", 32 }, { "1/16", 48 }, { "1/8t", 64 }, { "1/16.", 72 }, { "1/8", 96 },
+        { "1/4t", 128 }, { "1/8.", 144 }, { "1/4", 192 }, { "1/2", 384 }, { "1/1", 768 }
+    };
+    for (const auto& length : lengths)
+        gateLengthComboBox.addItem(length.first, length.second);
+    gateLengthComboBox.setSelectedId(juce::roundToInt(gate.lengthQuarters * 192.0), juce::dontSendNotification);
+    if (gateLengthComboBox.getSelectedId() == 0)
+        gateLengthComboBox.setText(juce::String(gate.lengthQuarters, 3) + " q", juce::dontSendNotification);
+    gateLengthComboBox.onChange = [this] { applyNoteGate(); };
+    addAndMakeVisible(gateLengthComboBox);
+
+    for (int ratchets = 1; ratchets <= NoteGate::maxRatchets; ++ratchets)
+        gateRatchetsComboBox.addItem(juce::String(ratchets) + (ratchets == 1 ? " note" : " notes"), ratchets);
+    gateRatchetsComboBox.setSelectedId(gate.ratchets, juce::dontSendNotification);
+    gateRatchetsComboBox.onChange = [this] { applyNoteGate(); };
+    addAndMakeVisible(gateRatchetsComboBox);
+    gateLengthComboBox.setEnabled(gate.mode != GateMode::Follow);
+    gateRatchetsComboBox.setEnabled(gate.mode == GateMode::Ratchet);
+
+    // Strum
+    strumLabel.setText("Strum", juce::dontSendNotification);
+    strumLabel.setJustificationType(juce::Justification::centredLeft);
+    strumLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(strumLabel);
+
+    // Item id = rhythm key relative to the root + 2 (1 = off)
+    const NoteStrum strum = audioProcessor.getStrum();
+    strumKeyComboBox.addItem("Off", 1);
+    for (int key = 0; key < 24; ++key)
+        strumKeyComboBox.addItem("Key +" + juce::String(key), key + 2);
+    strumKeyComboBox.setSelectedId(strum.isEnabled() ? strum.key + 2 : 1, juce::dontSendNotification);
+    strumKeyComboBox.onChange = [this] { applyStrum(); };
+    addAndMakeVisible(strumKeyComboBox);
+
+    strumDirectionComboBox.addItem("Up", 1);
+    strumDirectionComboBox.addItem("Down", 2);
+    strumDirectionComboBox.addItem("Alternate", 3);
+    strumDirectionComboBox.setSelectedId(static_cast<int>(strum.direction) + 1, juce::dontSendNotification);
+    strumDirectionComboBox.onChange = [this] { applyStrum(); };
+    addAndMakeVisible(strumDirectionComboBox);
+
+    // Item id = spread in 1/192 quarters
+    const std::pair<const char*, int> spreads[] = {
+        { "1/64", 12 }, { "1/32", 24 }, { "1/16t", 32 }, { "1/16", 48 }, { "1/8", 96 }, { "1/4", 192 }
+    };
+    for (const auto& spread : spreads)
+        strumSpreadComboBox.addItem(spread.first, spread.second);
+    strumSpreadComboBox.setSelectedId(juce::roundToInt(strum.spreadQuarters * 192.0), juce::dontSendNotification);
+    strumSpreadComboBox.onChange = [this] { applyStrum(); };
+    addAndMakeVisible(strumSpreadComboBox);
+
+    // Item id = lookahead in ms + 1
+    lookaheadComboBox.addItem("No lookahead", 1);
+    for (int milliseconds : { 5, 10, 20, 50, 100 })
+        lookaheadComboBox.addItem(juce::String(milliseconds) + " ms lookahead", milliseconds + 1);
+    lookaheadComboBox.setSelectedId(juce::roundToInt(audioProcessor.getLookaheadMs()) + 1, juce::dontSendNotification);
+    lookaheadComboBox.onChange = [this] { applyStrum(); };
+    addAndMakeVisible(lookaheadComboBox);
+
+    // Groove quantize
+    quantizeLabel.setText("Quantize", juce::dontSendNotification);
+    quantizeLabel.setJustificationType(juce::Justification::centredLeft);
+    quantizeLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(quantizeLabel);
+
+    // Item id = grid in 1/192 quarters, 1 = off
+    const GrooveQuantize quantize = audioProcessor.getGrooveQuantize();
+    quantizeGridComboBox.addItem("Off", 1);
+    const std::pair<const char*, int> grids[] = {
+        { "1/4", 192 }, { "1/8", 96 }, { "1/8t", 64 }, { "1/16", 48 }, { "1/16t", 32 }, { "1/32", 24 }
+    };
+    for (const auto& grid : grids)
+        quantizeGridComboBox.addItem(grid.first, grid.second);
+    quantizeGridComboBox.setSelectedId(quantize.enabled ? juce::roundToInt(quantize.gridQuarters * 192.0) : 1,
+                                       juce::dontSendNotification);
+    quantizeGridComboBox.onChange = [this] { applyGrooveQuantize(); };
+    addAndMakeVisible(quantizeGridComboBox);
+
+    // Item id = percent
+    for (int percent : { 25, 50, 75, 100 })
+        quantizeStrengthComboBox.addItem(juce::String(percent) + " %", percent);
+    quantizeStrengthComboBox.setSelectedId(juce::roundToInt(quantize.strength * 100.0), juce::dontSendNotification);
+    quantizeStrengthComboBox.onChange = [this] { applyGrooveQuantize(); };
+    addAndMakeVisible(quantizeStrengthComboBox);
+
+    quantizeSwingComboBox.addItem("Straight", 50);
+    for (int percent : { 54, 58, 62, 66, 71, 75 })
+        quantizeSwingComboBox.addItem("Swing " + juce::String(percent) + " %", percent);
+    quantizeSwingComboBox.setSelectedId(juce::roundToInt(quantize.swing * 100.0), juce::dontSendNotification);
+    quantizeSwingComboBox.onChange = [this] { applyGrooveQuantize(); };
+    addAndMakeVisible(quantizeSwingComboBox);
+
+    grooveTextEditor.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+    grooveTextEditor.setTextToShowWhenEmpty("Groove: 0 +12 0 -8/80", juce::Colours::grey);
+    grooveTextEditor.setText(audioProcessor.getGrooveText(), juce::dontSendNotification);
+    grooveTextEditor.onReturnKey = [this] { applyGrooveText(); };
+    grooveTextEditor.onFocusLost = [this] { applyGrooveText(); };
+    addAndMakeVisible(grooveTextEditor);
+
+    // Chord timing
+    chordTimingLabel.setText("Chord Timing", juce::dontSendNotification);
+    chordTimingLabel.setJustificationType(juce::Justification::centredLeft);
+    chordTimingLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(chordTimingLabel);
+
+    // Item id = settle window in ms + 1
+    chordSettleComboBox.addItem("Chord changes at once", 1);
+    for (int milliseconds : { 10, 20, 30, 50, 80 })
+        chordSettleComboBox.addItem("Settle " + juce::String(milliseconds) + " ms", milliseconds + 1);
+    chordSettleComboBox.setSelectedId(juce::roundToInt(audioProcessor.getChordSettleMs()) + 1, juce::dontSendNotification);
+    chordSettleComboBox.onChange = [this]
+    {
+        if (chordSettleComboBox.getSelectedId() > 0)
+            audioProcessor.setChordSettleMs(chordSettleComboBox.getSelectedId() - 1);
+    };
+    addAndMakeVisible(chordSettleComboBox);
+
+    // Item id = grace window in ms + 1 (adds to the plugin latency)
+    chordGraceComboBox.addItem("No late-chord grace", 1);
+    for (int milliseconds : { 5, 10, 20, 30 })
+        chordGraceComboBox.addItem(juce::String(milliseconds) + " ms grace", milliseconds + 1);
+    chordGraceComboBox.setSelectedId(juce::roundToInt(audioProcessor.getChordGraceMs()) + 1, juce::dontSendNotification);
+    chordGraceComboBox.onChange = [this]
+    {
+        if (chordGraceComboBox.getSelectedId() > 0)
+            audioProcessor.setChordGraceMs(chordGraceComboBox.getSelectedId() - 1);
+    };
+    addAndMakeVisible(chordGraceComboBox);
+
+    // Chord input
+    chordInputLabel.setText("Chord Input", juce::dontSendNotification);
+    chordInputLabel.setJustificationType(juce::Justification::centredLeft);
+    chordInputLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(chordInputLabel);
+
+    chordLatchToggle.setButtonText("Latch chord until the next one");
+    chordLatchToggle.setToggleState(audioProcessor.getChordLatch(), juce::dontSendNotification);
+    chordLatchToggle.onClick = [this]
+    {
+        audioProcessor.setChordLatch(chordLatchToggle.getToggleState());
+    };
+    addAndMakeVisible(chordLatchToggle);
+
+    chordFollowToggle.setButtonText("Held notes follow chord");
+    chordFollowToggle.setToggleState(audioProcessor.getChordFollow(), juce::dontSendNotification);
+    chordFollowToggle.onClick = [this]
+    {
+        audioProcessor.setChordFollow(chordFollowToggle.getToggleState());
+    };
+    addAndMakeVisible(chordFollowToggle);
+
+    // Output cleanup
+    outputLabel.setText("Output", juce::dontSendNotification);
+    outputLabel.setJustificationType(juce::Justification::centredLeft);
+    outputLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(outputLabel);
+
+    outputCleanupComboBox.addItem("Output as generated", 1);
+    outputCleanupComboBox.addItem("Remove redundant notes", 2);
+    outputCleanupComboBox.addItem("Remove redundant notes, legato", 3);
+    outputCleanupComboBox.setSelectedId(static_cast<int>(audioProcessor.getOutputCleanup()) + 1, juce::dontSendNotification);
+    outputCleanupComboBox.onChange = [this]
+    {
+        if (outputCleanupComboBox.getSelectedId() > 0)
+            audioProcessor.setOutputCleanup(static_cast<OutputCleanup>(outputCleanupComboBox.getSelectedId() - 1));
+    };
+    addAndMakeVisible(outputCleanupComboBox);
+
+    outputRemovedLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(outputRemovedLabel);
+
+    // Control routing (item id = ControlRouting kinds + 1)
+    controlsLabel.setText("Controls", juce::dontSendNotification);
+    controlsLabel.setJustificationType(juce::Justification::centredLeft);
+    controlsLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(controlsLabel);
+
+    const auto routing = audioProcessor.getControlRouting();
+    chordControlsComboBox.addItem("Chord: no controls", 1);
+    chordControlsComboBox.addItem("Chord: CC", ControlRouting::controllers + 1);
+    chordControlsComboBox.addItem("Chord: CC, bend", (ControlRouting::controllers | ControlRouting::pitchBend) + 1);
+    chordControlsComboBox.addItem("Chord: CC, bend, pressure",
+                                  (ControlRouting::controllers | ControlRouting::pitchBend | ControlRouting::channelPressure) + 1);
+    chordControlsComboBox.setSelectedId(routing.chordInput + 1, juce::dontSendNotification);
+    chordControlsComboBox.onChange = [this] { applyControlRouting(); };
+    addAndMakeVisible(chordControlsComboBox);
+
+    rhythmControlsComboBox.addItem("Rhythm: no controls", 1);
+    rhythmControlsComboBox.addItem("Rhythm: CC", ControlRouting::controllers + 1);
+    rhythmControlsComboBox.addItem("Rhythm: CC, bend", (ControlRouting::controllers | ControlRouting::pitchBend) + 1);
+    rhythmControlsComboBox.addItem("Rhythm: CC, bend, pressure",
+                                   (ControlRouting::controllers | ControlRouting::pitchBend | ControlRouting::channelPressure) + 1);
+    rhythmControlsComboBox.addItem("Rhythm: all + aftertouch", ControlRouting::all + 1);
+    rhythmControlsComboBox.setSelectedId(routing.rhythmInput + 1, juce::dontSendNotification);
+    rhythmControlsComboBox.onChange = [this] { applyControlRouting(); };
+    addAndMakeVisible(rhythmControlsComboBox);
+
+    controlThinningToggle.setButtonText("Thin");
+    controlThinningToggle.setToggleState(routing.thin, juce::dontSendNotification);
+    controlThinningToggle.onClick = [this] { applyControlRouting(); };
+    addAndMakeVisible(controlThinningToggle);
+
+    // Polyphony cap (item id = voices + 1) and steal policy (item id = VoiceSteal + 1)
+    voicesLabel.setText("Voices", juce::dontSendNotification);
+    voicesLabel.setJustificationType(juce::Justification::centredLeft);
+    voicesLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(voicesLabel);
+
+    maxVoicesComboBox.addItem("Unlimited", 1);
+    for (int voices : { 1, 2, 4, 6, 8, 12, 16, 24, 32 })
+        maxVoicesComboBox.addItem(juce::String(voices) + (voices == 1 ? " voice" : " voices"), voices + 1);
+    maxVoicesComboBox.setSelectedId(audioProcessor.getMaxVoices() + 1, juce::dontSendNotification);
+    maxVoicesComboBox.onChange = [this]
+    {
+        if (maxVoicesComboBox.getSelectedId() > 0)
+            audioProcessor.setMaxVoices(maxVoicesComboBox.getSelectedId() - 1);
+    };
+    addAndMakeVisible(maxVoicesComboBox);
+
+    voiceStealComboBox.addItem("Steal oldest", static_cast<int>(VoiceSteal::Oldest) + 1);
+    voiceStealComboBox.addItem("Steal quietest", static_cast<int>(VoiceSteal::LowestVelocity) + 1);
+    voiceStealComboBox.addItem("Steal highest", static_cast<int>(VoiceSteal::HighestPitch) + 1);
+    voiceStealComboBox.addItem("Steal lowest", static_cast<int>(VoiceSteal::LowestPitch) + 1);
+    voiceStealComboBox.setSelectedId(static_cast<int>(audioProcessor.getVoiceSteal()) + 1, juce::dontSendNotification);
+    voiceStealComboBox.onChange = [this]
+    {
+        if (voiceStealComboBox.getSelectedId() > 0)
+            audioProcessor.setVoiceSteal(static_cast<VoiceSteal>(voiceStealComboBox.getSelectedId() - 1));
+    };
+    addAndMakeVisible(voiceStealComboBox);
+
+    stolenVoicesLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(stolenVoicesLabel);
+
+    // Rhythm pattern
+    patternLabel.setText("Rhythm Pattern", juce::dontSendNotification);
+    patternLabel.setJustificationType(juce::Justification::centredLeft);
+    patternLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(patternLabel);
+
+    patternStatusLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(patternStatusLabel);
+
+    patternTextEditor.setMultiLine(true);
+    patternTextEditor.setReturnKeyStartsNewLine(true);
+    patternTextEditor.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+    patternTextEditor.setTextToShowWhenEmpty("0: x . x x*2 | E(3,8) /16", juce::Colours::grey);
+    patternTextEditor.setText(audioProcessor.getRhythmPattern(), juce::dontSendNotification);
+    patternTextEditor.onTextChange = [this]
+    {
+        audioProcessor.setRhythmPattern(patternTextEditor.getText());
+    };
+    addAndMakeVisible(patternTextEditor);
+
+    // Memory panel
+    memoryLabel.setText("Memory", juce::dontSendNotification);
+    memoryLabel.setJustificationType(juce::Justification::centredLeft);
+    memoryLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    addAndMakeVisible(memoryLabel);
+
+    memoryTextEditor.setMultiLine(true);
+    memoryTextEditor.setReadOnly(true);
+    memoryTextEditor.setCaretVisible(false);
+    memoryTextEditor.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+    addAndMakeVisible(memoryTextEditor);
+
+    exportMemoryButton.setButtonText("Export CSV...");
+    exportMemoryButton.onClick = [this] { exportMemoryReport(); };
+    addAndMakeVisible(exportMemoryButton);
+
     // Set up debug log label
     logLabel.setText("Debug Log", juce::dontSendNotification);
     logLabel.setJustificationType(juce::Justification::centredLeft);
@@ -36,14 +345,30 @@ PhuArpAudioProcessorEditor::PhuArpAudioProcessorEditor(PhuArpAudioProcessor& p)
     addAndMakeVisible(logTextEditor);
     
     // Set editor size
-    setSize(600, 400);
+    setSize(600, 950);
     
     // Add initial welcome message
     addLogMessage("PhuArp Debug Log initialized");
+
+    // Transport status: pick up what is pending, then follow the bridge from the timer
+    auto& uiBridge = audioProcessor.getUiBridge();
+    uiBridge.addEventListener(this);
+    uiBridge.deliver();
+    refreshTransportLabel();
+
+    refreshPresetList();
+    refreshPatternStatus();
+    refreshMemoryReport();
+    refreshOutputRemoved();
+    refreshStolenVoices();
+    startTimerHz(2);
 }
 
 PhuArpAudioProcessorEditor::~PhuArpAudioProcessorEditor() 
 {
+    stopTimer();
+    audioProcessor.getUiBridge().removeEventListener(this);
+
     // Unregister from logger
     if (auto* logger = audioProcessor.getEditorLogger())
     {
@@ -66,7 +391,93 @@ void PhuArpAudioProcessorEditor::resized()
 
     // Place controls inside the group bounds
     auto inner = paramsGroup.getBounds().reduced(10, 25);
-    passThroughOtherMidiToggle.setBounds(inner.removeFromTop(24));
+    auto toggleRow = inner.removeFromTop(24);
+    transportLabel.setBounds(toggleRow.removeFromRight(170));
+    passThroughOtherMidiToggle.setBounds(toggleRow);
+
+    // Preset row below the params
+    auto presetRow = area.removeFromTop(25);
+    presetLabel.setBounds(presetRow.removeFromLeft(130));
+    loadBankButton.setBounds(presetRow.removeFromRight(110).reduced(0, 1));
+    presetComboBox.setBounds(presetRow.reduced(0, 1).withTrimmedRight(5));
+    area.removeFromTop(5); // Spacing
+
+    // Gate row below the presets
+    auto gateRow = area.removeFromTop(25);
+    gateLabel.setBounds(gateRow.removeFromLeft(130));
+    gateModeComboBox.setBounds(gateRow.removeFromLeft(150).reduced(0, 1).withTrimmedRight(5));
+    gateLengthComboBox.setBounds(gateRow.removeFromLeft(100).reduced(0, 1).withTrimmedRight(5));
+    gateRatchetsComboBox.setBounds(gateRow.removeFromLeft(100).reduced(0, 1));
+    area.removeFromTop(5); // Spacing
+
+    // Strum row below the gate
+    auto strumRow = area.removeFromTop(25);
+    strumLabel.setBounds(strumRow.removeFromLeft(130));
+    strumKeyComboBox.setBounds(strumRow.removeFromLeft(100).reduced(0, 1).withTrimmedRight(5));
+    strumDirectionComboBox.setBounds(strumRow.removeFromLeft(100).reduced(0, 1).withTrimmedRight(5));
+    strumSpreadComboBox.setBounds(strumRow.removeFromLeft(70).reduced(0, 1).withTrimmedRight(5));
+    lookaheadComboBox.setBounds(strumRow.reduced(0, 1));
+    area.removeFromTop(5); // Spacing
+
+    // Quantize row below the strum
+    auto quantizeRow = area.removeFromTop(25);
+    quantizeLabel.setBounds(quantizeRow.removeFromLeft(130));
+    quantizeGridComboBox.setBounds(quantizeRow.removeFromLeft(80).reduced(0, 1).withTrimmedRight(5));
+    quantizeStrengthComboBox.setBounds(quantizeRow.removeFromLeft(80).reduced(0, 1).withTrimmedRight(5));
+    quantizeSwingComboBox.setBounds(quantizeRow.removeFromLeft(120).reduced(0, 1).withTrimmedRight(5));
+    grooveTextEditor.setBounds(quantizeRow.reduced(0, 1));
+    area.removeFromTop(5); // Spacing
+
+    // Chord timing row below the quantize row
+    auto chordTimingRow = area.removeFromTop(25);
+    chordTimingLabel.setBounds(chordTimingRow.removeFromLeft(130));
+    chordSettleComboBox.setBounds(chordTimingRow.removeFromLeft(170).reduced(0, 1).withTrimmedRight(5));
+    chordGraceComboBox.setBounds(chordTimingRow.removeFromLeft(150).reduced(0, 1).withTrimmedRight(5));
+    area.removeFromTop(5); // Spacing
+
+    // Chord input row below the chord timing
+    auto chordInputRow = area.removeFromTop(25);
+    chordInputLabel.setBounds(chordInputRow.removeFromLeft(130));
+    chordFollowToggle.setBounds(chordInputRow.removeFromRight(180));
+    chordLatchToggle.setBounds(chordInputRow);
+    area.removeFromTop(5); // Spacing
+
+    // Output row
+    auto outputRow = area.removeFromTop(25);
+    outputLabel.setBounds(outputRow.removeFromLeft(130));
+    outputCleanupComboBox.setBounds(outputRow.removeFromLeft(250).reduced(0, 1).withTrimmedRight(5));
+    outputRemovedLabel.setBounds(outputRow);
+    area.removeFromTop(5); // Spacing
+
+    // Controls row
+    auto controlsRow = area.removeFromTop(25);
+    controlsLabel.setBounds(controlsRow.removeFromLeft(130));
+    chordControlsComboBox.setBounds(controlsRow.removeFromLeft(180).reduced(0, 1).withTrimmedRight(5));
+    rhythmControlsComboBox.setBounds(controlsRow.removeFromLeft(190).reduced(0, 1).withTrimmedRight(5));
+    controlThinningToggle.setBounds(controlsRow);
+    area.removeFromTop(5); // Spacing
+
+    // Voices row
+    auto voicesRow = area.removeFromTop(25);
+    voicesLabel.setBounds(voicesRow.removeFromLeft(130));
+    maxVoicesComboBox.setBounds(voicesRow.removeFromLeft(130).reduced(0, 1).withTrimmedRight(5));
+    voiceStealComboBox.setBounds(voicesRow.removeFromLeft(150).reduced(0, 1).withTrimmedRight(5));
+    stolenVoicesLabel.setBounds(voicesRow);
+    area.removeFromTop(5); // Spacing
+
+    // Rhythm pattern below the presets
+    auto patternHeader = area.removeFromTop(25);
+    patternLabel.setBounds(patternHeader.removeFromLeft(130));
+    patternStatusLabel.setBounds(patternHeader);
+    patternTextEditor.setBounds(area.removeFromTop(90));
+    area.removeFromTop(5); // Spacing
+
+    // Memory panel below the params
+    auto memoryHeader = area.removeFromTop(25);
+    exportMemoryButton.setBounds(memoryHeader.removeFromRight(110).reduced(0, 1));
+    memoryLabel.setBounds(memoryHeader);
+    memoryTextEditor.setBounds(area.removeFromTop(140));
+    area.removeFromTop(5); // Spacing
     
     // Label at top
     logLabel.setBounds(area.removeFromTop(25));
@@ -89,4 +500,205 @@ void PhuArpAudioProcessorEditor::addLogMessage(const juce::String& message)
     
     // Auto-scroll to bottom
     logTextEditor.moveCaretToEnd();
-}
\ No newline at end of file
+}
+void PhuArpAudioProcessorEditor::timerCallback()
+{
+    audioProcessor.getUiBridge().deliver();
+    refreshPatternStatus();
+    refreshMemoryReport();
+    refreshOutputRemoved();
+    refreshStolenVoices();
+
+    // Follow program changes from the host or MIDI
+    const int program = audioProcessor.getCurrentProgram();
+    if (presetComboBox.getNumItems() > 0 && presetComboBox.getSelectedId() != program + 1)
+        presetComboBox.setSelectedId(program + 1, juce::dontSendNotification);
+}
+
+void PhuArpAudioProcessorEditor::onBPMChanged(const BPMEvent& event)
+{
+    juce::ignoreUnused(event);
+    refreshTransportLabel();
+}
+
+void PhuArpAudioProcessorEditor::onIsPlayingChanged(const IsPlayingEvent& event)
+{
+    juce::ignoreUnused(event);
+    refreshTransportLabel();
+}
+
+void PhuArpAudioProcessorEditor::onSampleRateChanged(const SampleRateEvent& event)
+{
+    juce::ignoreUnused(event);
+    refreshTransportLabel();
+}
+
+void PhuArpAudioProcessorEditor::refreshTransportLabel()
+{
+    const auto& uiBridge = audioProcessor.getUiBridge();
+    transportLabel.setText(juce::String(uiBridge.getBPMValues().bpm, 1) + " BPM  "
+                               + juce::String(uiBridge.getSampleRate() / 1000.0, 1) + " kHz  "
+                               + (uiBridge.getIsPlaying() ? "playing" : "stopped"),
+                           juce::dontSendNotification);
+}
+
+void PhuArpAudioProcessorEditor::refreshPatternStatus()
+{
+    const auto status = audioProcessor.getRhythmPatternStatus();
+    if (!status.ok)
+    {
+        patternStatusLabel.setColour(juce::Label::textColourId, juce::Colours::orangered);
+        patternStatusLabel.setText(juce::String(status.error), juce::dontSendNotification);
+        return;
+    }
+    patternStatusLabel.setColour(juce::Label::textColourId, juce::Colours::lightgrey);
+    patternStatusLabel.setText(status.numLanes == 0 ? juce::String("no built-in rhythm")
+                                                    : juce::String(status.numLanes) + " lanes, "
+                                                          + juce::String(status.numLines) + " lines at 1/"
+                                                          + juce::String(status.linesPerQuarter * 4),
+                               juce::dontSendNotification);
+}
+
+void PhuArpAudioProcessorEditor::refreshMemoryReport()
+{
+    MemoryReport report;
+    audioProcessor.getMemoryReport(report);
+    memoryTextEditor.setText(juce::String(report.toText()), juce::dontSendNotification);
+}
+
+void PhuArpAudioProcessorEditor::applyControlRouting()
+{
+    ControlRouting routing;
+    if (chordControlsComboBox.getSelectedId() > 0)
+        routing.chordInput = static_cast<uint8_t>(chordControlsComboBox.getSelectedId() - 1);
+    if (rhythmControlsComboBox.getSelectedId() > 0)
+        routing.rhythmInput = static_cast<uint8_t>(rhythmControlsComboBox.getSelectedId() - 1);
+    routing.thin = controlThinningToggle.getToggleState();
+    audioProcessor.setControlRouting(routing);
+}
+
+void PhuArpAudioProcessorEditor::refreshOutputRemoved()
+{
+    const auto removed = audioProcessor.getOutputRemovedCount();
+    outputRemovedLabel.setText(removed == 0 ? juce::String() : juce::String(static_cast<juce::int64>(removed)) + " events removed",
+                               juce::dontSendNotification);
+}
+
+void PhuArpAudioProcessorEditor::refreshStolenVoices()
+{
+    const auto stolen = audioProcessor.getStolenVoiceCount();
+    stolenVoicesLabel.setText(stolen == 0 ? juce::String() : juce::String(static_cast<juce::int64>(stolen)) + " stolen",
+                              juce::dontSendNotification);
+}
+
+void PhuArpAudioProcessorEditor::exportMemoryReport()
+{
+    exportChooser = std::make_unique<juce::FileChooser>(
+        "Export memory report",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("phu-arp-memory.csv"),
+        "*.csv");
+
+    exportChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+        [this](const juce::FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+            if (file == juce::File())
+                return;
+
+            MemoryReport report;
+            audioProcessor.getMemoryReport(report);
+            if (file.replaceWithText(juce::String(report.toCsv())))
+                addLogMessage("Memory report exported to " + file.getFullPathName());
+            else
+                addLogMessage("Could not write " + file.getFullPathName());
+        });
+}
+
+void PhuArpAudioProcessorEditor::applyNoteGate()
+{
+    NoteGate gate = audioProcessor.getNoteGate();
+    const int mode = gateModeComboBox.getSelectedId() - 1;
+    gate.mode = mode == static_cast<int>(GateMode::Fixed) ? GateMode::Fixed
+              : mode == static_cast<int>(GateMode::Ratchet) ? GateMode::Ratchet : GateMode::Follow;
+    if (gateLengthComboBox.getSelectedId() > 0)
+        gate.lengthQuarters = gateLengthComboBox.getSelectedId() / 192.0;
+    if (gateRatchetsComboBox.getSelectedId() > 0)
+        gate.ratchets = gateRatchetsComboBox.getSelectedId();
+    audioProcessor.setNoteGate(gate);
+
+    gateLengthComboBox.setEnabled(gate.mode != GateMode::Follow);
+    gateRatchetsComboBox.setEnabled(gate.mode == GateMode::Ratchet);
+}
+
+void PhuArpAudioProcessorEditor::applyStrum()
+{
+    NoteStrum strum = audioProcessor.getStrum();
+    strum.key = strumKeyComboBox.getSelectedId() > 1 ? strumKeyComboBox.getSelectedId() - 2 : NoteStrum::noKey;
+    const int direction = strumDirectionComboBox.getSelectedId() - 1;
+    strum.direction = direction == static_cast<int>(StrumDirection::Down) ? StrumDirection::Down
+                    : direction == static_cast<int>(StrumDirection::Alternate) ? StrumDirection::Alternate
+                    : StrumDirection::Up;
+    if (strumSpreadComboBox.getSelectedId() > 0)
+        strum.spreadQuarters = strumSpreadComboBox.getSelectedId() / 192.0;
+    audioProcessor.setStrum(strum);
+
+    if (lookaheadComboBox.getSelectedId() > 0)
+        audioProcessor.setLookaheadMs(lookaheadComboBox.getSelectedId() - 1);
+}
+
+void PhuArpAudioProcessorEditor::applyGrooveQuantize()
+{
+    GrooveQuantize quantize = audioProcessor.getGrooveQuantize();
+    quantize.enabled = quantizeGridComboBox.getSelectedId() > 1;
+    if (quantize.enabled)
+        quantize.gridQuarters = quantizeGridComboBox.getSelectedId() / 192.0;
+    if (quantizeStrengthComboBox.getSelectedId() > 0)
+        quantize.strength = quantizeStrengthComboBox.getSelectedId() / 100.0;
+    if (quantizeSwingComboBox.getSelectedId() > 0)
+        quantize.swing = quantizeSwingComboBox.getSelectedId() / 100.0;
+    audioProcessor.setGrooveQuantize(quantize);
+}
+
+void PhuArpAudioProcessorEditor::applyGrooveText()
+{
+    if (grooveTextEditor.getText() == audioProcessor.getGrooveText())
+        return;
+    juce::String error;
+    if (audioProcessor.setGrooveText(grooveTextEditor.getText(), error))
+        addLogMessage("Groove: " + juce::String(audioProcessor.getGrooveQuantize().groove.numSteps) + " steps");
+    else
+        addLogMessage("Groove not applied: " + error);
+}
+
+void PhuArpAudioProcessorEditor::refreshPresetList()
+{
+    presetComboBox.clear(juce::dontSendNotification);
+    if (audioProcessor.getPresetBankPath().isEmpty())
+        return;
+    for (int i = 0; i < audioProcessor.getNumPrograms(); ++i)
+        presetComboBox.addItem(juce::String(i) + "  " + audioProcessor.getProgramName(i), i + 1);
+    presetComboBox.setSelectedId(audioProcessor.getCurrentProgram() + 1, juce::dontSendNotification);
+}
+
+void PhuArpAudioProcessorEditor::loadPresetBank()
+{
+    bankChooser = std::make_unique<juce::FileChooser>(
+        "Load preset bank",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory),
+        "*.phubank");
+
+    bankChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this](const juce::FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+            if (file == juce::File())
+                return;
+
+            juce::String error;
+            if (audioProcessor.loadPresetBank(file, error))
+                addLogMessage("Preset bank loaded: " + file.getFullPathName());
+            else
+                addLogMessage("Could not load preset bank: " + error);
+            refreshPresetList();
+        });
+}
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
+#include "../lib/SyncGlobalsListener.h"
 
 class PhuArpAudioProcessor;
 
-class PhuArpAudioProcessorEditor : public juce::AudioProcessorEditor
+class PhuArpAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                   private juce::Timer,
+                                   private GlobalsEventListener
 {
 public:
     PhuArpAudioProcessorEditor(PhuArpAudioProcessor&);
@@ -22,7 +25,92 @@ private:
     // Parameters panel (sits above the log)
     juce::GroupComponent paramsGroup;
     juce::ToggleButton passThroughOtherMidiToggle;
+
+    // Preset bank: program list of the loaded bank (switches like a host program change)
+    juce::Label presetLabel;
+    juce::ComboBox presetComboBox;
+    juce::TextButton loadBankButton;
+    std::unique_ptr<juce::FileChooser> bankChooser;
+    void refreshPresetList();
+    void loadPresetBank();
+
+    // Note gate: follow the trigger, fixed tempo-synced length or ratchets
+    juce::Label gateLabel;
+    juce::ComboBox gateModeComboBox;
+    juce::ComboBox gateLengthComboBox;
+    juce::ComboBox gateRatchetsComboBox;
+    void applyNoteGate();
+
+    // Strum key, direction, spread and lookahead (plugin latency)
+    juce::Label strumLabel;
+    juce::ComboBox strumKeyComboBox;
+    juce::ComboBox strumDirectionComboBox;
+    juce::ComboBox strumSpreadComboBox;
+    juce::ComboBox lookaheadComboBox;
+    void applyStrum();
+
+    // Groove quantize: grid, strength, swing and groove template of the rhythm triggers
+    juce::Label quantizeLabel;
+    juce::ComboBox quantizeGridComboBox;
+    juce::ComboBox quantizeStrengthComboBox;
+    juce::ComboBox quantizeSwingComboBox;
+    juce::TextEditor grooveTextEditor;
+    void applyGrooveQuantize();
+    void applyGrooveText();
+
+    // Chord input timing: settle window for hand-played chord changes, grace window for late chords
+    juce::Label chordTimingLabel;
+    juce::ComboBox chordSettleComboBox;
+    juce::ComboBox chordGraceComboBox;
+
+    // Chord input behaviour: latch, legato chord follow of held notes
+    juce::Label chordInputLabel;
+    juce::ToggleButton chordLatchToggle;
+    juce::ToggleButton chordFollowToggle;
+
+    // Output cleanup policy and how many events it removed (refreshed by the timer)
+    juce::Label outputLabel;
+    juce::ComboBox outputCleanupComboBox;
+    juce::Label outputRemovedLabel;
+    void refreshOutputRemoved();
+
+    // Control routing of the chord and rhythm inputs, thinning to one value per block
+    juce::Label controlsLabel;
+    juce::ComboBox chordControlsComboBox;
+    juce::ComboBox rhythmControlsComboBox;
+    juce::ToggleButton controlThinningToggle;
+    void applyControlRouting();
+
+    // Polyphony cap, steal policy and how many notes it stole (refreshed by the timer)
+    juce::Label voicesLabel;
+    juce::ComboBox maxVoicesComboBox;
+    juce::ComboBox voiceStealComboBox;
+    juce::Label stolenVoicesLabel;
+    void refreshStolenVoices();
+
+    // Built-in rhythm pattern: compiled as you type, errors shown next to the label
+    juce::Label patternLabel;
+    juce::Label patternStatusLabel;
+    juce::TextEditor patternTextEditor;
+    void refreshPatternStatus();
+
+    // Host transport (GLOBALS events via the processor's UI bridge, message thread)
+    juce::Label transportLabel;
+    void onBPMChanged(const BPMEvent& event) override;
+    void onIsPlayingChanged(const IsPlayingEvent& event) override;
+    void onSampleRateChanged(const SampleRateEvent& event) override;
+    void refreshTransportLabel();
     
+    // Memory panel (per-instance heap usage and high-water marks)
+    juce::Label memoryLabel;
+    juce::TextEditor memoryTextEditor;
+    juce::TextButton exportMemoryButton;
+    std::unique_ptr<juce::FileChooser> exportChooser;
+
+    void timerCallback() override;
+    void refreshMemoryReport();
+    void exportMemoryReport();
+
     // Debug log text area
     juce::TextEditor logTextEditor;
     juce::Label logLabel;
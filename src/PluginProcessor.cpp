@@ -2,15 +2,24 @@
 #include "PluginEditor.h"
 #include "EditorLogger.h"
 #include "../lib/EventSource.h"
+#include "RealtimeTrap.h"
+#include <cstdio>
 
 PhuArpAudioProcessor::PhuArpAudioProcessor()
     : AudioProcessor(BusesProperties()) // MIDI effect - no audio buses
     , patternTracker(chordTracker)
     , coordinator(chordTracker, patternTracker)
+    , midiAdapter(coordinator)
     , editorLogger(std::make_unique<EditorLogger>())
 {
-    // Register coordinator as listener for DAW global events
-    syncGlobals.addEventListener(&coordinator);
+    // Coordinator is a static listener of the DAW global events (direct, non-virtual dispatch)
+    syncGlobals.getStaticListeners().bind(coordinator);
+
+    // Built-in rhythm generator steps on this instance's beat grid
+    coordinator.setBeatGrid(&syncGlobals.getBeatGrid());
+
+    // UI listeners get GLOBALS events through the bridge, not on the audio thread
+    syncGlobals.addEventListener(&uiBridge);
 
     // Route coordinator logs to this instance's logger
     coordinator.setLogger(editorLogger.get());
@@ -22,44 +31,150 @@ PhuArpAudioProcessor::PhuArpAudioProcessor()
 PhuArpAudioProcessor::~PhuArpAudioProcessor() 
 {
     // Unregister from events
-    syncGlobals.removeEventListener(&coordinator);
+    syncGlobals.removeEventListener(&uiBridge);
+    syncGlobals.getStaticListeners().unbind<ChordPatternCoordinator>();
 }
 
 void PhuArpAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    juce::ignoreUnused(samplesPerBlock);
     syncGlobals.updateSampleRate(sampleRate);
+    updateLatency(sampleRate);
+}
 
-    // Mark the current thread as the audio thread for realtime-safe logging.
-    if (editorLogger)
-        editorLogger->markCurrentThreadAsAudioThread();
+void PhuArpAudioProcessor::updateLatency(double sampleRate)
+{
+    const int lookahead = sampleRate > 0.0 ? juce::roundToInt(getLookaheadMs() * sampleRate / 1000.0) : 0;
+    const int grace = sampleRate > 0.0 ? juce::roundToInt(getChordGraceMs() * sampleRate / 1000.0) : 0;
+    lookaheadSamples.store(lookahead, std::memory_order_relaxed);
+    chordGraceSamples.store(grace, std::memory_order_relaxed);
+    // The grace window delays the rhythm input on top of the strum / quantize lookahead
+    if (lookahead + grace != getLatencySamples())
+        setLatencySamples(lookahead + grace);
+}
+
+void PhuArpAudioProcessor::setLookaheadMs(double milliseconds)
+{
+    lookaheadMs.store(juce::jlimit(0.0, 500.0, milliseconds), std::memory_order_relaxed);
+    updateLatency(getSampleRate());
+}
+
+void PhuArpAudioProcessor::setChordGraceMs(double milliseconds)
+{
+    chordGraceMs.store(juce::jlimit(0.0, 50.0, milliseconds), std::memory_order_relaxed);
+    updateLatency(getSampleRate());
 }
 
 void PhuArpAudioProcessor::releaseResources() {}
 
+void PhuArpAudioProcessor::setRhythmPattern(const juce::String& text)
+{
+    rhythmPatternText = text;
+    patternWorker.submit(text.toStdString());
+}
+
+void PhuArpAudioProcessor::getMemoryReport(MemoryReport& report) const
+{
+    // Engine components and the adapter are members: their object sizes are part of ours
+    MemoryUsage processorUsage;
+    processorUsage.component = "PhuArpAudioProcessor";
+    processorUsage.objectBytes = sizeof(PhuArpAudioProcessor);
+    report.add(processorUsage);
+
+    coordinator.appendMemoryUsage(report, true);
+    report.add(midiAdapter.getMemoryUsage());
+
+    if (editorLogger)
+        report.add(editorLogger->getMemoryUsage());
+}
+
 void PhuArpAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    // Mark the calling thread as the audio thread for realtime-safe logging (and the RT trap).
+    // Done here rather than in prepareToPlay, which hosts may call from the message thread.
+    if (editorLogger)
+        editorLogger->markCurrentThreadAsAudioThread();
+
+    // Everything below must be allocation- and lock-free (checked in PHU_ARP_RT_TRAP builds)
+    PHU_ARP_RT_SECTION();
+
     // Get playhead position info
     auto playHeadPtr = getPlayHead();
     auto positionInfo = playHeadPtr ? playHeadPtr->getPosition() : juce::Optional<juce::AudioPlayHead::PositionInfo>();
+    const auto transport = MidiBufferAdapter::toTransportInfo(positionInfo);
+
+    // Newly compiled rhythm pattern: the grid follows the table's resolution from this block on.
+    // An empty pattern text falls back to the rhythm of the active bank preset.
+    if (patternWorker.update())
+    {
+        const StepTable* table = patternWorker.getActive();
+        if (table->numLanes == 0 && presetSwitcher.getActivePreset() != nullptr)
+            table = &presetSwitcher.getActivePreset()->pattern;
+        syncGlobals.setGridSubdivisionsPerQuarter(table->linesPerQuarter);
+        coordinator.getRhythmGenerator().setStepTable(table);
+    }
+
+    // Program changes: last one in the block wins, applied at the block start (position-locked)
+    const int controlChannel = programChangeChannel.load(std::memory_order_relaxed);
+    for (const auto metadata : midiMessages)
+    {
+        const auto message = metadata.getMessage();
+        if (message.isProgramChange() && (controlChannel == 0 || message.getChannel() == controlChannel))
+            presetSwitcher.programChange(message.getProgramChangeNumber());
+    }
+    if (const BankPreset* preset = presetSwitcher.update())
+    {
+        PresetSwitcher::apply(*preset, coordinator, syncGlobals);
+
+        // Presets without a rhythm keep playing the pattern typed in the editor
+        const StepTable* editorTable = patternWorker.getActive();
+        if (preset->pattern.numLanes == 0 && editorTable != nullptr && editorTable->numLanes > 0)
+        {
+            syncGlobals.setGridSubdivisionsPerQuarter(editorTable->linesPerQuarter);
+            coordinator.getRhythmGenerator().setStepTable(editorTable);
+        }
+    }
     
+    coordinator.setNoteGate(getNoteGate());
+    coordinator.setStrum(getStrum());
+    const int graceSamples = chordGraceSamples.load(std::memory_order_relaxed);
+    coordinator.setLatencySamples(lookaheadSamples.load(std::memory_order_relaxed) + graceSamples);
+    coordinator.setChordGraceSamples(graceSamples);
+    coordinator.setChordLatch(getChordLatch());
+    coordinator.setChordFollow(getChordFollow());
+    coordinator.setOutputCleanup(getOutputCleanup());
+    coordinator.setControlRouting(getControlRouting());
+    coordinator.setMaxVoices(getMaxVoices());
+    coordinator.setVoiceSteal(getVoiceSteal());
+    coordinator.setGrooveQuantize(getGrooveQuantize());
+    coordinator.setChordSettleSamples(juce::roundToInt(getChordSettleMs() * getSampleRate() / 1000.0));
+
     // Update DAW globals
     syncGlobals.updateDAWGlobals(
-        buffer,
-        midiMessages,
-        positionInfo
+        buffer.getNumSamples(),
+        transport
     );
     
     // Test logging (can be removed later)
     const auto currentRun = syncGlobals.getCurrentRun();
     if (currentRun % 1000 == 0)
     {
-        LOG_MESSAGE(editorLogger.get(), "Processed " + juce::String(currentRun) + " audio blocks");
+        // Fixed buffer + realtime queue: no juce::String on the audio thread
+        char text[64];
+        std::snprintf(text, sizeof(text), "Processed %ld audio blocks", currentRun);
+        if (editorLogger)
+            editorLogger->logEngineMessage(text);
     }
 
     if(syncGlobals.isDawPlaying()) {
         // Process chord pattern coordination
-        coordinator.processBlock(midiMessages);
+        midiAdapter.processBlock(midiMessages, buffer.getNumSamples());
+    } else {
+        // Deliver the note-offs queued by a transport stop (no-op otherwise)
+        midiAdapter.writeStopFlush(midiMessages);
     }
+    outputRemovedCount.store(coordinator.getOutputPeephole().getRemovedCount(), std::memory_order_relaxed);
+    stolenVoiceCount.store(coordinator.getStolenVoiceCount(), std::memory_order_relaxed);
     // Mark end of processing
     syncGlobals.finishRun(buffer.getNumSamples());
 }
@@ -86,14 +201,266 @@ bool PhuArpAudioProcessor::producesMidi() const { return true; }
 bool PhuArpAudioProcessor::isMidiEffect() const { return true; }
 double PhuArpAudioProcessor::getTailLengthSeconds() const { return 0.0; }
 
-int PhuArpAudioProcessor::getNumPrograms() { return 1; }
-int PhuArpAudioProcessor::getCurrentProgram() { return 0; }
-void PhuArpAudioProcessor::setCurrentProgram(int) {}
-const juce::String PhuArpAudioProcessor::getProgramName(int) { return "Default"; }
+bool PhuArpAudioProcessor::loadPresetBank(const juce::File& file, juce::String& error)
+{
+    std::string loadError;
+    if (!presetSwitcher.loadBank(file.getFullPathName().toStdString(), loadError))
+    {
+        error = loadError;
+        return false;
+    }
+    updateHostDisplay(ChangeDetails().withProgramChanged(true));
+    return true;
+}
+
+juce::String PhuArpAudioProcessor::getPresetBankPath() const
+{
+    const PresetBank* bank = presetSwitcher.getBank();
+    return bank ? juce::String(bank->getPath()) : juce::String();
+}
+
+int PhuArpAudioProcessor::getNumPrograms()
+{
+    const PresetBank* bank = presetSwitcher.getBank();
+    return bank ? bank->size() : 1;
+}
+
+void PhuArpAudioProcessor::setNoteGate(const NoteGate& gate) noexcept
+{
+    gateMode.store(static_cast<int>(gate.mode), std::memory_order_relaxed);
+    gateLengthQuarters.store(gate.lengthQuarters, std::memory_order_relaxed);
+    gateRatchets.store(gate.ratchets, std::memory_order_relaxed);
+}
+
+NoteGate PhuArpAudioProcessor::getNoteGate() const noexcept
+{
+    NoteGate gate;
+    const int mode = gateMode.load(std::memory_order_relaxed);
+    gate.mode = mode == static_cast<int>(GateMode::Fixed) ? GateMode::Fixed
+              : mode == static_cast<int>(GateMode::Ratchet) ? GateMode::Ratchet : GateMode::Follow;
+    gate.lengthQuarters = gateLengthQuarters.load(std::memory_order_relaxed);
+    gate.ratchets = gateRatchets.load(std::memory_order_relaxed);
+    return gate;
+}
+
+void PhuArpAudioProcessor::setStrum(const NoteStrum& strum) noexcept
+{
+    strumKey.store(strum.key, std::memory_order_relaxed);
+    strumDirection.store(static_cast<int>(strum.direction), std::memory_order_relaxed);
+    strumSpreadQuarters.store(strum.spreadQuarters, std::memory_order_relaxed);
+    strumAnticipation.store(strum.anticipation, std::memory_order_relaxed);
+}
+
+NoteStrum PhuArpAudioProcessor::getStrum() const noexcept
+{
+    NoteStrum strum;
+    strum.key = strumKey.load(std::memory_order_relaxed);
+    const int direction = strumDirection.load(std::memory_order_relaxed);
+    strum.direction = direction == static_cast<int>(StrumDirection::Down) ? StrumDirection::Down
+                    : direction == static_cast<int>(StrumDirection::Alternate) ? StrumDirection::Alternate
+                    : StrumDirection::Up;
+    strum.spreadQuarters = strumSpreadQuarters.load(std::memory_order_relaxed);
+    strum.anticipation = strumAnticipation.load(std::memory_order_relaxed);
+    return strum;
+}
+
+void PhuArpAudioProcessor::setGrooveQuantize(const GrooveQuantize& quantize) noexcept
+{
+    quantizeEnabled.store(quantize.enabled, std::memory_order_relaxed);
+    quantizeGridQuarters.store(quantize.gridQuarters, std::memory_order_relaxed);
+    quantizeStrength.store(quantize.strength, std::memory_order_relaxed);
+    quantizeSwing.store(quantize.swing, std::memory_order_relaxed);
+    for (size_t step = 0; step < static_cast<size_t>(GrooveTemplate::maxSteps); ++step)
+    {
+        grooveTiming[step].store(quantize.groove.timing[step], std::memory_order_relaxed);
+        grooveVelocity[step].store(quantize.groove.velocity[step], std::memory_order_relaxed);
+    }
+    grooveSteps.store(quantize.groove.numSteps, std::memory_order_relaxed);
+}
+
+GrooveQuantize PhuArpAudioProcessor::getGrooveQuantize() const noexcept
+{
+    GrooveQuantize quantize;
+    quantize.enabled = quantizeEnabled.load(std::memory_order_relaxed);
+    quantize.gridQuarters = quantizeGridQuarters.load(std::memory_order_relaxed);
+    quantize.strength = quantizeStrength.load(std::memory_order_relaxed);
+    quantize.swing = quantizeSwing.load(std::memory_order_relaxed);
+    quantize.groove.numSteps = grooveSteps.load(std::memory_order_relaxed);
+    for (size_t step = 0; step < static_cast<size_t>(quantize.groove.numSteps); ++step)
+    {
+        quantize.groove.timing[step] = grooveTiming[step].load(std::memory_order_relaxed);
+        quantize.groove.velocity[step] = grooveVelocity[step].load(std::memory_order_relaxed);
+    }
+    return quantize;
+}
+
+bool PhuArpAudioProcessor::setGrooveText(const juce::String& text, juce::String& error)
+{
+    GrooveQuantize quantize = getGrooveQuantize();
+    std::string parseError;
+    if (!GrooveTemplate::parse(text.toStdString(), quantize.groove, parseError))
+    {
+        error = parseError;
+        return false;
+    }
+    grooveText = text;
+    setGrooveQuantize(quantize);
+    return true;
+}
+
+int PhuArpAudioProcessor::getCurrentProgram() { return presetSwitcher.getCurrentProgram(); }
+void PhuArpAudioProcessor::setCurrentProgram(int index) { presetSwitcher.requestProgram(index); }
+
+const juce::String PhuArpAudioProcessor::getProgramName(int index)
+{
+    const PresetBank* bank = presetSwitcher.getBank();
+    const BankPreset* preset = bank ? bank->get(index) : nullptr;
+    return preset ? juce::String(preset->name) : juce::String("Default");
+}
+
 void PhuArpAudioProcessor::changeProgramName(int, const juce::String&) {}
 
-void PhuArpAudioProcessor::getStateInformation(juce::MemoryBlock&) {}
-void PhuArpAudioProcessor::setStateInformation(const void*, int) {}
+void PhuArpAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeString(rhythmPatternText);
+    stream.writeString(getPresetBankPath());
+    stream.writeInt(getCurrentProgram());
+    stream.writeInt(getProgramChangeChannel());
+
+    const NoteGate gate = getNoteGate();
+    stream.writeInt(static_cast<int>(gate.mode));
+    stream.writeDouble(gate.lengthQuarters);
+    stream.writeInt(gate.ratchets);
+
+    const NoteStrum strum = getStrum();
+    stream.writeInt(strum.key);
+    stream.writeInt(static_cast<int>(strum.direction));
+    stream.writeDouble(strum.spreadQuarters);
+    stream.writeDouble(strum.anticipation);
+    stream.writeDouble(getLookaheadMs());
+
+    const GrooveQuantize quantize = getGrooveQuantize();
+    stream.writeBool(quantize.enabled);
+    stream.writeDouble(quantize.gridQuarters);
+    stream.writeDouble(quantize.strength);
+    stream.writeDouble(quantize.swing);
+    stream.writeString(grooveText);
+
+    stream.writeDouble(getChordSettleMs());
+    stream.writeDouble(getChordGraceMs());
+    stream.writeBool(getChordFollow());
+    stream.writeBool(getChordLatch());
+    stream.writeInt(static_cast<int>(getOutputCleanup()));
+
+    const ControlRouting routing = getControlRouting();
+    stream.writeInt(routing.chordInput);
+    stream.writeInt(routing.rhythmInput);
+    stream.writeBool(routing.thin);
+
+    stream.writeInt(getMaxVoices());
+    stream.writeInt(static_cast<int>(getVoiceSteal()));
+}
+
+void PhuArpAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+    setRhythmPattern(stream.readString());
+
+    // Older states end after the pattern
+    if (stream.isExhausted())
+        return;
+    const juce::String bankPath = stream.readString();
+    const int program = stream.readInt();
+    setProgramChangeChannel(stream.readInt());
+
+    // States before gate settings end here
+    if (!stream.isExhausted())
+    {
+        NoteGate gate;
+        const int mode = stream.readInt();
+        gate.mode = mode == static_cast<int>(GateMode::Fixed) ? GateMode::Fixed
+                  : mode == static_cast<int>(GateMode::Ratchet) ? GateMode::Ratchet : GateMode::Follow;
+        gate.lengthQuarters = juce::jlimit(NoteGate::minLengthQuarters, NoteGate::maxLengthQuarters, stream.readDouble());
+        gate.ratchets = juce::jlimit(1, NoteGate::maxRatchets, stream.readInt());
+        setNoteGate(gate);
+    }
+
+    // States before strum settings end here
+    if (!stream.isExhausted())
+    {
+        NoteStrum strum;
+        strum.key = stream.readInt();
+        const int direction = stream.readInt();
+        strum.direction = direction == static_cast<int>(StrumDirection::Down) ? StrumDirection::Down
+                        : direction == static_cast<int>(StrumDirection::Alternate) ? StrumDirection::Alternate
+                        : StrumDirection::Up;
+        strum.spreadQuarters = juce::jlimit(0.0, NoteStrum::maxSpreadQuarters, stream.readDouble());
+        strum.anticipation = juce::jlimit(0.0, 1.0, stream.readDouble());
+        setStrum(strum);
+        setLookaheadMs(stream.readDouble());
+    }
+
+    // States before groove quantize settings end here
+    if (!stream.isExhausted())
+    {
+        GrooveQuantize quantize;
+        quantize.enabled = stream.readBool();
+        quantize.gridQuarters = juce::jlimit(GrooveQuantize::minGridQuarters, GrooveQuantize::maxGridQuarters, stream.readDouble());
+        quantize.strength = juce::jlimit(0.0, 1.0, stream.readDouble());
+        quantize.swing = juce::jlimit(0.5, 0.75, stream.readDouble());
+        setGrooveQuantize(quantize);
+        juce::String error;
+        if (!setGrooveText(stream.readString(), error))
+            LOG_MESSAGE(editorLogger.get(), "Groove not restored: " + error);
+    }
+
+    // States before the chord settle window end here
+    if (!stream.isExhausted())
+        setChordSettleMs(stream.readDouble());
+
+    // States before the late-chord grace window end here
+    if (!stream.isExhausted())
+        setChordGraceMs(stream.readDouble());
+
+    // States before legato chord follow end here
+    if (!stream.isExhausted())
+        setChordFollow(stream.readBool());
+
+    // States before chord latch end here
+    if (!stream.isExhausted())
+        setChordLatch(stream.readBool());
+
+    // States before output cleanup end here
+    if (!stream.isExhausted())
+        setOutputCleanup(static_cast<OutputCleanup>(juce::jlimit(0, 2, stream.readInt())));
+
+    // States before control routing end here
+    if (!stream.isExhausted())
+    {
+        ControlRouting routing;
+        routing.chordInput = static_cast<uint8_t>(stream.readInt() & ControlRouting::all);
+        routing.rhythmInput = static_cast<uint8_t>(stream.readInt() & ControlRouting::all);
+        routing.thin = stream.readBool();
+        setControlRouting(routing);
+    }
+
+    // States before the polyphony cap end here
+    if (!stream.isExhausted())
+    {
+        setMaxVoices(juce::jlimit(0, static_cast<int>(ChordPatternCoordinator::maxPlayingNotes), stream.readInt()));
+        setVoiceSteal(static_cast<VoiceSteal>(juce::jlimit(0, 3, stream.readInt())));
+    }
+
+    juce::String error;
+    if (bankPath.isNotEmpty() && !loadPresetBank(juce::File(bankPath), error))
+    {
+        LOG_MESSAGE(editorLogger.get(), "Preset bank not restored: " + error);
+        return;
+    }
+    if (bankPath.isNotEmpty())
+        setCurrentProgram(program);
+}
 
 // This creates new instances of the plugin
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
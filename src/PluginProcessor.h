@@ -1,10 +1,15 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
-#include "..\lib\SyncGlobals.h"
+#include "../lib/SyncGlobals.h"
+#include "../lib/GlobalsEventBridge.h"
 #include "ChordNotesTracker.h"
 #include "PatternTracker.h"
 #include "ChordPatternCoordinator.h"
+#include "PatternCompileWorker.h"
+#include "PresetSwitcher.h"
+#include "MidiBufferAdapter.h"
+#include "MemoryUsage.h"
 
 class EditorLogger;
 
@@ -37,21 +42,181 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
     
+    // GLOBALS events redelivered on the message thread (the editor pumps it from its timer)
+    GlobalsEventBridge& getUiBridge() noexcept { return uiBridge; }
+
     // Get the editor logger (for editor registration)
     EditorLogger* getEditorLogger() const { return editorLogger.get(); }
 
+    /**
+     * Per-instance memory report: static object sizes, heap bytes and high-water marks
+     * of the engine components, the MIDI adapter and the logger (message thread)
+     */
+    void getMemoryReport(MemoryReport& report) const;
+
     // UI-facing parameter: pass-through MIDI on other channels
-    void setPassThroughOtherMidi(bool shouldPassThrough) noexcept { coordinator.setPassThroughOtherMidi(shouldPassThrough); }
-    bool getPassThroughOtherMidi() const noexcept { return coordinator.getPassThroughOtherMidi(); }
+    void setPassThroughOtherMidi(bool shouldPassThrough) noexcept { midiAdapter.setPassThroughOtherMidi(shouldPassThrough); }
+    bool getPassThroughOtherMidi() const noexcept { return midiAdapter.getPassThroughOtherMidi(); }
+
+    /**
+     * Built-in rhythm pattern text (see PatternCompiler), message thread.
+     * Compiled on a background thread; the audio thread switches tables at the next block.
+     */
+    void setRhythmPattern(const juce::String& text);
+    const juce::String& getRhythmPattern() const noexcept { return rhythmPatternText; }
+
+    // Result of the latest pattern compilation (error message for the editor)
+    PatternCompileWorker::Status getRhythmPatternStatus() const { return patternWorker.getStatus(); }
+
+    /**
+     * Load a preset bank (built with phu-arp-bank), message thread. The host program list
+     * then shows the bank's presets; the current program number is kept.
+     * @return false if the bank cannot be loaded (error describes the problem)
+     */
+    bool loadPresetBank(const juce::File& file, juce::String& error);
+    juce::String getPresetBankPath() const;
+
+    // MIDI channel whose program changes switch presets (1-16, 0 = any channel)
+    void setProgramChangeChannel(int channel) noexcept { programChangeChannel.store(channel, std::memory_order_relaxed); }
+    int getProgramChangeChannel() const noexcept { return programChangeChannel.load(std::memory_order_relaxed); }
+
+    // Gate of the generated notes (see NoteGate), picked up by the audio thread at the next block
+    void setNoteGate(const NoteGate& gate) noexcept;
+    NoteGate getNoteGate() const noexcept;
+
+    // Strum key (see NoteStrum), picked up by the audio thread at the next block
+    void setStrum(const NoteStrum& strum) noexcept;
+    NoteStrum getStrum() const noexcept;
+
+    /**
+     * Lookahead for strums that begin before the grid, message thread. Reported to the host as
+     * plugin latency; all output (and passed-through MIDI) is delayed by it.
+     */
+    void setLookaheadMs(double milliseconds);
+    double getLookaheadMs() const noexcept { return lookaheadMs.load(std::memory_order_relaxed); }
+
+    // Groove quantize of rhythm triggers (see GrooveQuantize), picked up by the audio thread at the next block
+    void setGrooveQuantize(const GrooveQuantize& quantize) noexcept;
+    GrooveQuantize getGrooveQuantize() const noexcept;
+
+    /**
+     * Groove template text (see GrooveTemplate::parse), message thread. Empty = no template.
+     * @return false if the text is malformed (the previous template stays active)
+     */
+    bool setGrooveText(const juce::String& text, juce::String& error);
+    const juce::String& getGrooveText() const noexcept { return grooveText; }
+
+    // Chord settle window (see ChordPatternCoordinator::setChordSettleSamples), 0 = off
+    void setChordSettleMs(double milliseconds) noexcept { chordSettleMs.store(juce::jlimit(0.0, 200.0, milliseconds), std::memory_order_relaxed); }
+    double getChordSettleMs() const noexcept { return chordSettleMs.load(std::memory_order_relaxed); }
+
+    // Late-chord grace window (see ChordPatternCoordinator::setChordGraceSamples), 0 = off;
+    // added to the plugin latency
+    void setChordGraceMs(double milliseconds);
+    double getChordGraceMs() const noexcept { return chordGraceMs.load(std::memory_order_relaxed); }
+
+    // Chord latch (see ChordPatternCoordinator::setChordLatch)
+    void setChordLatch(bool enabled) noexcept { chordLatch.store(enabled, std::memory_order_relaxed); }
+    bool getChordLatch() const noexcept { return chordLatch.load(std::memory_order_relaxed); }
+
+    // Legato chord follow (see ChordPatternCoordinator::setChordFollow)
+    void setChordFollow(bool enabled) noexcept { chordFollow.store(enabled, std::memory_order_relaxed); }
+    bool getChordFollow() const noexcept { return chordFollow.load(std::memory_order_relaxed); }
+
+    // Output cleanup (see ChordPatternCoordinator::setOutputCleanup) and the events it removed so far
+    void setOutputCleanup(OutputCleanup cleanup) noexcept { outputCleanup.store(static_cast<int>(cleanup), std::memory_order_relaxed); }
+    OutputCleanup getOutputCleanup() const noexcept { return static_cast<OutputCleanup>(outputCleanup.load(std::memory_order_relaxed)); }
+    uint64_t getOutputRemovedCount() const noexcept { return outputRemovedCount.load(std::memory_order_relaxed); }
+
+    // Control routing of the chord and rhythm inputs (see ChordPatternCoordinator::setControlRouting)
+    void setControlRouting(const ControlRouting& routing) noexcept {
+        chordControlKinds.store(routing.chordInput, std::memory_order_relaxed);
+        rhythmControlKinds.store(routing.rhythmInput, std::memory_order_relaxed);
+        controlThinning.store(routing.thin, std::memory_order_relaxed);
+    }
+    ControlRouting getControlRouting() const noexcept {
+        ControlRouting routing;
+        routing.chordInput = static_cast<uint8_t>(chordControlKinds.load(std::memory_order_relaxed) & ControlRouting::all);
+        routing.rhythmInput = static_cast<uint8_t>(rhythmControlKinds.load(std::memory_order_relaxed) & ControlRouting::all);
+        routing.thin = controlThinning.load(std::memory_order_relaxed);
+        return routing;
+    }
+
+    // Polyphony cap, 0 = off (see ChordPatternCoordinator::setMaxVoices), and the notes it stole so far
+    void setMaxVoices(int voices) noexcept { maxVoices.store(voices, std::memory_order_relaxed); }
+    int getMaxVoices() const noexcept { return maxVoices.load(std::memory_order_relaxed); }
+    void setVoiceSteal(VoiceSteal steal) noexcept { voiceSteal.store(static_cast<int>(steal), std::memory_order_relaxed); }
+    VoiceSteal getVoiceSteal() const noexcept { return static_cast<VoiceSteal>(voiceSteal.load(std::memory_order_relaxed)); }
+    uint64_t getStolenVoiceCount() const noexcept { return stolenVoiceCount.load(std::memory_order_relaxed); }
 
 private:
-    // DAW synchronization globals (each instance has its own)
-    SyncGlobals syncGlobals;
+    // DAW synchronization globals (each instance has its own; calls the coordinator directly)
+    CoordinatorSyncGlobals syncGlobals;
+
+    // Audio thread -> message thread mailbox for GLOBALS events
+    GlobalsEventBridge uiBridge;
     
     // Chord pattern processing components (each instance has its own)
     ChordNotesTracker chordTracker;
     PatternTracker patternTracker;
     ChordPatternCoordinator coordinator;
+
+    // Built-in rhythm pattern: text (message thread) and its background compiler
+    juce::String rhythmPatternText;
+    PatternCompileWorker patternWorker;
+
+    // Memory-mapped preset bank and program switching (host program list and MIDI program changes)
+    PresetSwitcher presetSwitcher;
+    std::atomic<int> programChangeChannel { 0 };
+
+    // Note gate settings (message thread -> audio thread)
+    std::atomic<int> gateMode { static_cast<int>(GateMode::Follow) };
+    std::atomic<double> gateLengthQuarters { 0.25 };
+    std::atomic<int> gateRatchets { 2 };
+
+    // Strum settings and lookahead (message thread -> audio thread)
+    std::atomic<int> strumKey { NoteStrum::noKey };
+    std::atomic<int> strumDirection { static_cast<int>(StrumDirection::Up) };
+    std::atomic<double> strumSpreadQuarters { 0.125 };
+    std::atomic<double> strumAnticipation { 0.5 };
+    std::atomic<double> lookaheadMs { 0.0 };
+    std::atomic<int> lookaheadSamples { 0 };
+    void updateLatency(double sampleRate);
+
+    // Groove quantize settings (message thread -> audio thread); the template text stays on the
+    // message thread, its parsed steps are copied per block
+    std::atomic<bool> quantizeEnabled { false };
+    std::atomic<double> quantizeGridQuarters { 0.25 };
+    std::atomic<double> quantizeStrength { 1.0 };
+    std::atomic<double> quantizeSwing { 0.5 };
+    std::atomic<int> grooveSteps { 0 };
+    std::array<std::atomic<float>, GrooveTemplate::maxSteps> grooveTiming {};
+    std::array<std::atomic<float>, GrooveTemplate::maxSteps> grooveVelocity {};
+    juce::String grooveText;
+
+    // Chord settle and grace windows (message thread -> audio thread)
+    std::atomic<double> chordSettleMs { 0.0 };
+    std::atomic<double> chordGraceMs { 0.0 };
+    std::atomic<int> chordGraceSamples { 0 };
+    std::atomic<bool> chordLatch { false };
+    std::atomic<bool> chordFollow { false };
+
+    // Output cleanup (message thread -> audio thread) and its removed events (audio -> message thread)
+    std::atomic<int> outputCleanup { static_cast<int>(OutputCleanup::Off) };
+    std::atomic<uint64_t> outputRemovedCount { 0 };
+
+    // Control routing (message thread -> audio thread)
+    std::atomic<int> chordControlKinds { 0 };
+    std::atomic<int> rhythmControlKinds { 0 };
+    std::atomic<bool> controlThinning { true };
+
+    // Polyphony cap (message thread -> audio thread) and its stolen notes (audio -> message thread)
+    std::atomic<int> maxVoices { 0 };
+    std::atomic<int> voiceSteal { static_cast<int>(VoiceSteal::Oldest) };
+    std::atomic<uint64_t> stolenVoiceCount { 0 };
+
+    // JUCE <-> engine MIDI conversion
+    MidiBufferAdapter midiAdapter;
     
     // Logger for editor log view
     std::unique_ptr<EditorLogger> editorLogger;
@@ -0,0 +1,82 @@
+/**
+ * phu-arp-bank - preset bank builder
+ *
+ * Compiles a text bank source (presets with routing, rhythm key maps and rhythm patterns, see
+ * PresetBank::parseSource) into a memory-mappable .phubank file, or lists an existing bank.
+ *
+ * Usage:
+ *   phu-arp-bank <source.txt> <output.phubank>
+ *   phu-arp-bank --list <bank.phubank>
+ */
+
+#include "PresetBank.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+    std::fprintf(stderr,
+        "Usage: phu-arp-bank <source.txt> <output.phubank>\n"
+        "       phu-arp-bank --list <bank.phubank>\n"
+        "\n"
+        "Source format (one section per preset, '#' comments):\n"
+        "  [Name]\n"
+        "  channels CHORD RHYTHM OUTPUT   (default 1 16 2)\n"
+        "  root NOTE                      (default 24)\n"
+        "  key KEY CHORD_INDEX [OCTAVE]   rhythm key override, repeatable\n"
+        "  pattern LANE                   rhythm pattern lane, repeatable (e.g. pattern 0: x . x x*2)\n");
+}
+
+int listBank(const std::string& path) {
+    PresetBank bank;
+    std::string error;
+    if (!bank.open(path, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    for (int i = 0; i < bank.size(); ++i) {
+        const BankPreset& preset = *bank.get(i);
+        std::printf("%4d  %-31s  ch %2d/%2d->%2d  root %3d  %d lanes x %4d lines at %2d/quarter%s\n", i, preset.name,
+                    preset.routing.chordInputChannel, preset.routing.rhythmInputChannel, preset.routing.outputChannel,
+                    preset.routing.rhythmRootNote, preset.pattern.numLanes, preset.pattern.numLines,
+                    preset.pattern.linesPerQuarter, preset.hasKeyMap ? "  key map" : "");
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "--list") {
+        return listBank(argv[2]);
+    }
+    if (argc != 3 || argv[1][0] == '-') {
+        printUsage();
+        return 2;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+        return 1;
+    }
+    std::ostringstream source;
+    source << file.rdbuf();
+
+    std::vector<PresetDefinition> definitions;
+    std::string error;
+    if (!PresetBank::parseSource(source.str(), definitions, error)) {
+        std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return 2;
+    }
+    if (!PresetBank::write(argv[2], definitions, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("Wrote %zu presets to %s\n", definitions.size(), argv[2]);
+    return 0;
+}
@@ -0,0 +1,663 @@
+/**
+ * phu-arp-pipe - run the coordinator on a MIDI stream over stdin/stdout
+ *
+ * Reads timestamped raw MIDI from stdin (or a FIFO), drives ChordPatternCoordinator with
+ * virtual audio blocks and writes the generated MIDI to stdout. No plugin host or audio
+ * hardware is needed, so it works with plain shell pipes.
+ *
+ * Line format (input and output), one message per line, '#' starts a comment:
+ *   <time-ms> <status> <data1> [<data2>]      bytes in hex, e.g. "250.0 9f 18 64"
+ *   -         <status> <data1> [<data2>]      "-" = use the arrival time
+ *
+ * Timestamps are milliseconds since the start of the stream.
+ *
+ * Clock modes:
+ *   realtime (default): a free-running clock processes one block every blockSize/sampleRate
+ *                       seconds, like an audio callback. Events that arrive late are placed at the
+ *                       start of the current block.
+ *   --offline:          blocks are processed as soon as their input is known (input must be sorted
+ *                       by time); output is deterministic. Useful for integration tests.
+ *
+ * On end of input the output still pending (delay line, grace window, gate notes) is played out
+ * in empty blocks, then the transport is stopped (hanging notes are flushed) and latency percentiles
+ * (input line read or event due, whichever is later -> generated block written) are reported
+ * on stderr.
+ */
+
+#include "ChordNotesTracker.h"
+#include "ChordPatternCoordinator.h"
+#include "EngineLogger.h"
+#include "PatternCompiler.h"
+#include "PatternTracker.h"
+#include "PresetSwitcher.h"
+#include "RealtimeTrap.h"
+#include "../lib/SpscQueue.h"
+#include "../lib/SyncGlobals.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Longest tail played out after the end of the input (output still pending in the coordinator)
+constexpr double maxTailSeconds = 60.0;
+
+struct InputItem {
+    MidiEvent message;
+    double timestampMs = -1.0;          // < 0: use arrival time
+    Clock::time_point arrival;
+};
+
+struct PipeSettings {
+    double sampleRate = 48000.0;
+    int blockSize = 256;
+    double bpm = 120.0;
+    int rhythmRootNote = 24;
+    int chordInputChannel = 1;
+    int rhythmInputChannel = 16;
+    int outputChannel = 2;
+    bool offline = false;
+    bool verbose = false;
+    std::string inputPath;              // empty: stdin
+    std::string memoryReportPath;       // empty: no report
+    std::string patternText;            // Built-in rhythm (PatternCompiler text), empty: none
+    std::string bankPath;               // Preset bank (phu-arp-bank), empty: none
+    int program = 0;                    // Initial preset of the bank
+    int programChannel = 0;             // Channel of program change input, 0 = any
+    NoteGate gate;                      // Length of the generated notes
+    NoteStrum strum;                    // Strum key (default: off)
+    int latencySamples = 0;             // Output delay (strum and quantize lookahead)
+    GrooveQuantize quantize;            // Groove quantize of rhythm triggers (default: off)
+    double chordSettleMs = 0.0;         // Chord settle window (0 = off)
+    double chordGraceMs = 0.0;          // Late-chord grace window (0 = off), added to the latency
+    bool chordLatch = false;            // Chord notes stay until the next chord starts
+    bool chordFollow = false;           // Held notes follow chord changes
+    OutputCleanup outputCleanup = OutputCleanup::Off; // Redundant note events removed from the output
+    ControlRouting controlRouting;      // Input controls passed on to the output (default: none)
+    int maxVoices = 0;                  // Polyphony cap (0 = off)
+    VoiceSteal voiceSteal = VoiceSteal::Oldest; // Note the cap steals
+};
+
+std::atomic<bool> interrupted { false };
+
+void handleSignal(int) {
+    interrupted.store(true);
+}
+
+class StderrLogger : public EngineLogger {
+public:
+    void logEngineMessage(const char* message) noexcept override {
+        // Debug output only (--verbose); stdio locks, so exempt it from the RT trap
+        RealtimeTrap::ScopedAllow allow;
+        std::fprintf(stderr, "[engine] %s\n", message);
+    }
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+        "Usage: phu-arp-pipe [options] [< input]\n"
+        "\n"
+        "Options:\n"
+        "  --input PATH          read from a file/FIFO instead of stdin\n"
+        "  --sample-rate HZ      virtual sample rate (default: 48000)\n"
+        "  --block-size N        virtual block size in samples (default: 256)\n"
+        "  --bpm BPM             transport tempo (default: 120)\n"
+        "  --root-note N         rhythm root note (default: 24 = C1)\n"
+        "  --chord-channel N     chord input channel (default: 1)\n"
+        "  --rhythm-channel N    rhythm input channel (default: 16)\n"
+        "  --output-channel N    generated output channel (default: 2)\n"
+        "  --pattern TEXT        built-in rhythm pattern lanes, repeatable ('KEY: STEPS [/DIV]',\n"
+        "                        ';' between lanes, e.g. \"0: x . x x*2 /16; 12: E(3,8) /8\")\n"
+        "  --pattern-file PATH   built-in rhythm pattern from a text file (one lane per line)\n"
+        "  --gate MODE           generated note length: follow (trigger note-offs, default),\n"
+        "                        fixed or ratchet (tempo-synced, trigger note-offs ignored)\n"
+        "  --gate-length NOTE    fixed/ratchet length per trigger: 1/16 (default), 1/8t, 1/4., 0.5 quarters\n"
+        "  --ratchets N          ratchet notes per trigger (1-8, default: 2)\n"
+        "  --strum-key N         rhythm key (relative to the root note) that strums the whole chord\n"
+        "  --strum-direction DIR up (default), down or alternate\n"
+        "  --strum-spread NOTE   first to last strum note: 1/32 (default), 1/16t, 0.1 quarters\n"
+        "  --strum-anticipation PCT\n"
+        "                        part of the spread before the trigger (0-100, default: 50,\n"
+        "                        limited by --latency)\n"
+        "  --latency N           delay the output by N samples (strum lookahead, default: 0)\n"
+        "  --quantize NOTE       groove-quantize rhythm triggers to a grid: 1/16, 1/8t, ... (default: off)\n"
+        "  --quantize-strength PCT\n"
+        "                        how far triggers move onto the grid (0-100, default: 100)\n"
+        "  --swing PCT           position of every second grid line (50 = straight .. 75, default: 50)\n"
+        "  --groove TEXT         per-line timing in percent of a grid step, optionally /velocity percent,\n"
+        "                        e.g. \"0 +12 0 -8/80\"; late triggers are only pulled in up to --latency\n"
+        "  --chord-settle MS     apply a chord change once the chord input has been quiet this long\n"
+        "                        (hand-played chords, default: 0 = every note at once)\n"
+        "  --chord-grace MS      rhythm triggers play the chord that lands up to MS after them\n"
+        "                        (adds MS to the latency, default: 0)\n"
+        "  --chord-latch         chord notes stay until the next chord starts (sustain CC64 and\n"
+        "                        sostenuto CC66 on the chord channel always apply)\n"
+        "  --chord-follow        held notes move to the new chord on a chord change (legato)\n"
+        "  --output-cleanup MODE drop redundant note events from the output: off (default), clean\n"
+        "                        (duplicate note-offs, cancelled notes) or legato (also retriggers)\n"
+        "  --route-chord KINDS   pass chord channel controls on to the output: cc, bend, pressure\n"
+        "                        (comma-separated, default: none; CC64/CC66 stay pedals)\n"
+        "  --route-rhythm KINDS  pass rhythm channel controls on: cc, bend, pressure, poly (aftertouch\n"
+        "                        to the notes the key plays), all (default: none)\n"
+        "  --no-control-thinning send every routed control value (default: last value per block)\n"
+        "  --max-voices N        polyphony cap: a note-on beyond N playing notes steals one (default: 0 = off)\n"
+        "  --voice-steal POLICY  note the cap steals: oldest (default), velocity (quietest), highest or\n"
+        "                        lowest (pitch)\n"
+        "  --bank PATH           preset bank (see phu-arp-bank); program changes (Cn pp) switch presets\n"
+        "  --program N           initial preset of the bank (default: 0)\n"
+        "  --program-channel N   channel of program change input (default: 0 = any)\n"
+        "  --offline             process as fast as the input allows (deterministic)\n"
+        "  --memory-report PATH  write the engine memory report (CSV) at exit\n"
+        "  -v, --verbose         log engine messages to stderr\n");
+}
+
+// Parses "<time|-> <hex> <hex> [<hex>]". Returns false for blank/comment/invalid lines.
+bool parseLine(const char* line, InputItem& item) {
+    while (*line == ' ' || *line == '\t') {
+        ++line;
+    }
+    if (*line == '\0' || *line == '\n' || *line == '#') {
+        return false;
+    }
+
+    char* end = nullptr;
+    if (*line == '-' && (line[1] == ' ' || line[1] == '\t')) {
+        item.timestampMs = -1.0;
+        end = const_cast<char*>(line + 1);
+    } else {
+        item.timestampMs = std::strtod(line, &end);
+        if (end == line || item.timestampMs < 0.0) {
+            return false;
+        }
+    }
+
+    uint8_t bytes[3] = {0, 0, 0};
+    int numBytes = 0;
+    const char* p = end;
+    while (numBytes < 3) {
+        const long value = std::strtol(p, &end, 16);
+        if (end == p) {
+            break;
+        }
+        bytes[numBytes++] = static_cast<uint8_t>(value & 0xff);
+        p = end;
+    }
+    return MidiEvent::fromRawData(bytes, numBytes, 0, item.message);
+}
+
+void readerLoop(std::FILE* input, SpscQueue<InputItem, 8192>& queue, std::atomic<bool>& endOfInput) {
+    char line[256];
+    while (!interrupted.load(std::memory_order_relaxed) && std::fgets(line, sizeof(line), input) != nullptr) {
+        InputItem item;
+        if (!parseLine(line, item)) {
+            continue;
+        }
+        item.arrival = Clock::now();
+        while (!queue.push(item)) {
+            std::this_thread::yield();
+        }
+    }
+    endOfInput.store(true, std::memory_order_release);
+}
+
+bool parseNumber(const char* text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0';
+}
+
+bool readTextFile(const std::string& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    text = content.str();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    PipeSettings settings;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto nextNumber = [&]() {
+            double value = 0.0;
+            if (i + 1 >= argc || !parseNumber(argv[i + 1], value)) {
+                std::fprintf(stderr, "Invalid value for %s\n", arg.c_str());
+                std::exit(2);
+            }
+            ++i;
+            return value;
+        };
+
+        if (arg == "--input" && i + 1 < argc) {
+            settings.inputPath = argv[++i];
+        } else if (arg == "--sample-rate") {
+            settings.sampleRate = nextNumber();
+        } else if (arg == "--block-size") {
+            settings.blockSize = static_cast<int>(nextNumber());
+        } else if (arg == "--bpm") {
+            settings.bpm = nextNumber();
+        } else if (arg == "--root-note") {
+            settings.rhythmRootNote = static_cast<int>(nextNumber());
+        } else if (arg == "--chord-channel") {
+            settings.chordInputChannel = static_cast<int>(nextNumber());
+        } else if (arg == "--rhythm-channel") {
+            settings.rhythmInputChannel = static_cast<int>(nextNumber());
+        } else if (arg == "--output-channel") {
+            settings.outputChannel = static_cast<int>(nextNumber());
+        } else if (arg == "--pattern" && i + 1 < argc) {
+            settings.patternText += std::string(argv[++i]) + "\n";
+        } else if (arg == "--pattern-file" && i + 1 < argc) {
+            std::string fileText;
+            if (!readTextFile(argv[++i], fileText)) {
+                std::fprintf(stderr, "Cannot read %s\n", argv[i]);
+                return 1;
+            }
+            settings.patternText += fileText + "\n";
+        } else if (arg == "--gate" && i + 1 < argc) {
+            if (!NoteGate::parseMode(argv[++i], settings.gate.mode)) {
+                std::fprintf(stderr, "Invalid gate mode %s (follow, fixed, ratchet)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--gate-length" && i + 1 < argc) {
+            if (!NoteGate::parseLength(argv[++i], settings.gate.lengthQuarters)) {
+                std::fprintf(stderr, "Invalid gate length %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--ratchets") {
+            settings.gate.ratchets = static_cast<int>(nextNumber());
+        } else if (arg == "--strum-key") {
+            settings.strum.key = static_cast<int>(nextNumber());
+        } else if (arg == "--strum-direction" && i + 1 < argc) {
+            if (!NoteStrum::parseDirection(argv[++i], settings.strum.direction)) {
+                std::fprintf(stderr, "Invalid strum direction %s (up, down, alternate)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--strum-spread" && i + 1 < argc) {
+            if (!NoteGate::parseLength(argv[++i], settings.strum.spreadQuarters)
+                || settings.strum.spreadQuarters > NoteStrum::maxSpreadQuarters) {
+                std::fprintf(stderr, "Invalid strum spread %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--strum-anticipation") {
+            settings.strum.anticipation = nextNumber() / 100.0;
+        } else if (arg == "--latency") {
+            settings.latencySamples = static_cast<int>(nextNumber());
+        } else if (arg == "--chord-settle") {
+            settings.chordSettleMs = nextNumber();
+        } else if (arg == "--chord-grace") {
+            settings.chordGraceMs = nextNumber();
+        } else if (arg == "--chord-latch") {
+            settings.chordLatch = true;
+        } else if (arg == "--chord-follow") {
+            settings.chordFollow = true;
+        } else if (arg == "--output-cleanup" && i + 1 < argc) {
+            if (!OutputPeephole::parseCleanup(argv[++i], settings.outputCleanup)) {
+                std::fprintf(stderr, "Invalid output cleanup %s (off, clean, legato)\n", argv[i]);
+                return 2;
+            }
+        } else if ((arg == "--route-chord" || arg == "--route-rhythm") && i + 1 < argc) {
+            uint8_t& kinds = arg == "--route-chord" ? settings.controlRouting.chordInput : settings.controlRouting.rhythmInput;
+            if (!ControlRouting::parseKinds(argv[++i], kinds)) {
+                std::fprintf(stderr, "Invalid control kinds %s (cc, bend, pressure, poly, all, none)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--no-control-thinning") {
+            settings.controlRouting.thin = false;
+        } else if (arg == "--max-voices") {
+            settings.maxVoices = static_cast<int>(nextNumber());
+        } else if (arg == "--voice-steal" && i + 1 < argc) {
+            if (!VoicePool::parseSteal(argv[++i], settings.voiceSteal)) {
+                std::fprintf(stderr, "Invalid voice steal policy %s (oldest, velocity, highest, lowest)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--quantize" && i + 1 < argc) {
+            settings.quantize.enabled = true;
+            if (!NoteGate::parseLength(argv[++i], settings.quantize.gridQuarters)
+                || settings.quantize.gridQuarters < GrooveQuantize::minGridQuarters
+                || settings.quantize.gridQuarters > GrooveQuantize::maxGridQuarters) {
+                std::fprintf(stderr, "Invalid quantize grid %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--quantize-strength") {
+            settings.quantize.strength = nextNumber() / 100.0;
+        } else if (arg == "--swing") {
+            settings.quantize.swing = nextNumber() / 100.0;
+        } else if (arg == "--groove" && i + 1 < argc) {
+            std::string error;
+            if (!GrooveTemplate::parse(argv[++i], settings.quantize.groove, error)) {
+                std::fprintf(stderr, "Invalid groove: %s\n", error.c_str());
+                return 2;
+            }
+        } else if (arg == "--bank" && i + 1 < argc) {
+            settings.bankPath = argv[++i];
+        } else if (arg == "--program") {
+            settings.program = static_cast<int>(nextNumber());
+        } else if (arg == "--program-channel") {
+            settings.programChannel = static_cast<int>(nextNumber());
+        } else if (arg == "--memory-report" && i + 1 < argc) {
+            settings.memoryReportPath = argv[++i];
+        } else if (arg == "--offline") {
+            settings.offline = true;
+        } else if (arg == "-v" || arg == "--verbose") {
+            settings.verbose = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (settings.sampleRate <= 0.0 || settings.blockSize <= 0 || settings.bpm <= 0.0
+        || settings.gate.ratchets < 1 || settings.gate.ratchets > NoteGate::maxRatchets
+        || (settings.strum.isEnabled() && (settings.strum.key < RhythmKeyMap::firstKey
+                                           || settings.strum.key >= RhythmKeyMap::firstKey + RhythmKeyMap::numKeys))
+        || settings.strum.anticipation < 0.0 || settings.strum.anticipation > 1.0 || settings.latencySamples < 0
+        || settings.quantize.strength < 0.0 || settings.quantize.strength > 1.0
+        || settings.quantize.swing < 0.5 || settings.quantize.swing > 0.75 || settings.chordSettleMs < 0.0
+        || settings.chordGraceMs < 0.0) {
+        printUsage();
+        return 2;
+    }
+
+    CompiledPattern pattern;
+    std::string patternError;
+    if (!PatternCompiler::compile(settings.patternText, pattern, patternError)) {
+        std::fprintf(stderr, "Invalid pattern: %s\n", patternError.c_str());
+        return 2;
+    }
+
+    // Preset bank: mapped once here, switched per block without allocation
+    PresetSwitcher presets;
+    if (!settings.bankPath.empty()) {
+        std::string bankError;
+        if (!presets.loadBank(settings.bankPath, bankError)) {
+            std::fprintf(stderr, "%s\n", bankError.c_str());
+            return 1;
+        }
+        presets.requestProgram(settings.program);
+    }
+
+    std::FILE* input = stdin;
+    if (!settings.inputPath.empty()) {
+        input = std::fopen(settings.inputPath.c_str(), "r");
+        if (input == nullptr) {
+            std::fprintf(stderr, "Cannot open %s\n", settings.inputPath.c_str());
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    // Engine (same wiring as the plugin)
+    StderrLogger logger;
+    CoordinatorSyncGlobals syncGlobals;
+    ChordNotesTracker chordTracker;
+    PatternTracker patternTracker(chordTracker);
+    ChordPatternCoordinator coordinator(chordTracker, patternTracker, settings.rhythmRootNote,
+                                        settings.verbose ? &logger : nullptr);
+    coordinator.setChordInputChannel(settings.chordInputChannel);
+    coordinator.setRhythmInputChannel(settings.rhythmInputChannel);
+    coordinator.setOutputChannel(settings.outputChannel);
+    coordinator.setNoteGate(settings.gate);
+    coordinator.setStrum(settings.strum);
+    const int graceSamples = static_cast<int>(std::lround(settings.chordGraceMs * settings.sampleRate / 1000.0));
+    coordinator.setLatencySamples(settings.latencySamples + graceSamples);
+    coordinator.setChordGraceSamples(graceSamples);
+    coordinator.setGrooveQuantize(settings.quantize);
+    coordinator.setChordSettleSamples(static_cast<int>(std::lround(settings.chordSettleMs * settings.sampleRate / 1000.0)));
+    coordinator.setChordLatch(settings.chordLatch);
+    coordinator.setChordFollow(settings.chordFollow);
+    coordinator.setOutputCleanup(settings.outputCleanup);
+    coordinator.setControlRouting(settings.controlRouting);
+    coordinator.setMaxVoices(settings.maxVoices);
+    coordinator.setVoiceSteal(settings.voiceSteal);
+    syncGlobals.getStaticListeners().bind(coordinator);
+    syncGlobals.updateSampleRate(settings.sampleRate);
+    syncGlobals.setGridSubdivisionsPerQuarter(pattern.table.linesPerQuarter);
+    coordinator.setBeatGrid(&syncGlobals.getBeatGrid());
+    coordinator.getRhythmGenerator().setStepTable(&pattern.table);
+
+    TransportInfo transport;
+    transport.isValid = true;
+    transport.hasBpm = true;
+    transport.bpm = settings.bpm;
+    transport.isPlaying = true;
+
+    SpscQueue<InputItem, 8192> queue;
+    std::atomic<bool> endOfInput { false };
+
+    const int64_t blockSize = settings.blockSize;
+    const double samplesPerMs = settings.sampleRate / 1000.0;
+    const auto blockPeriod = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(blockSize / settings.sampleRate));
+
+    std::vector<InputItem> pending;          // Drained but not yet due
+    std::vector<MidiEvent> blockEvents;
+    std::vector<Clock::time_point> blockArrivals;
+    std::vector<double> latenciesUs;
+    pending.reserve(8192);
+    blockEvents.reserve(1024);
+    blockArrivals.reserve(1024);
+    latenciesUs.reserve(1 << 20);
+
+    auto writeOutput = [&](int64_t blockStart) {
+        const auto& output = coordinator.getOutputEvents();
+        for (const auto& evt : output) {
+            const double ms = (blockStart + evt.samplePosition) / samplesPerMs;
+            if (evt.getRawDataSize() == 2) {
+                std::printf("%.3f %02x %02x\n", ms, evt.status, evt.data1);
+            } else {
+                std::printf("%.3f %02x %02x %02x\n", ms, evt.status, evt.data1, evt.data2);
+            }
+        }
+        if (!output.empty()) {
+            std::fflush(stdout);
+        }
+    };
+
+    // This thread plays the audio thread (PHU_ARP_RT_TRAP builds check the engine calls)
+    RealtimeTrap::markCurrentThreadAsAudioThread();
+
+    const auto streamStart = Clock::now();
+    std::thread reader(readerLoop, input, std::ref(queue), std::ref(endOfInput));
+
+    auto sampleTimeOf = [&](const InputItem& item) -> int64_t {
+        if (item.timestampMs >= 0.0) {
+            return static_cast<int64_t>(item.timestampMs * samplesPerMs + 0.5);
+        }
+        // Arrival time on the free-running clock (offline mode: as early as possible)
+        if (settings.offline) {
+            return 0;
+        }
+        const double ms = std::chrono::duration<double, std::milli>(item.arrival - streamStart).count();
+        return static_cast<int64_t>(ms * samplesPerMs);
+    };
+
+    int64_t blockStart = 0;
+    size_t blocks = 0;
+    size_t inputCount = 0;
+    size_t outputCount = 0;
+    int64_t tailEnd = -1;
+
+    for (;; blockStart += blockSize) {
+        const int64_t blockEnd = blockStart + blockSize;
+
+        if (settings.offline) {
+            // Wait until this block's input is complete: an item at/after blockEnd is queued, or input ended
+            for (;;) {
+                InputItem item;
+                while (queue.pop(item)) {
+                    pending.push_back(item);
+                }
+                const bool complete = std::any_of(pending.begin(), pending.end(),
+                    [&](const InputItem& p) { return sampleTimeOf(p) >= blockEnd; });
+                if (complete || endOfInput.load(std::memory_order_acquire) || interrupted.load()) {
+                    InputItem late;
+                    while (queue.pop(late)) {
+                        pending.push_back(late);
+                    }
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        } else {
+            // Free-running clock: process the block once its time span has elapsed
+            std::this_thread::sleep_until(streamStart + blockPeriod * ((blockStart / blockSize) + 1));
+            InputItem item;
+            while (queue.pop(item)) {
+                pending.push_back(item);
+            }
+        }
+
+        // Collect the events due in this block (late events land at the block start)
+        blockEvents.clear();
+        blockArrivals.clear();
+        auto keep = pending.begin();
+        for (auto it = pending.begin(); it != pending.end(); ++it) {
+            const int64_t sampleTime = sampleTimeOf(*it);
+            if (sampleTime < blockEnd) {
+                MidiEvent evt = it->message;
+                evt.samplePosition = static_cast<int>(std::max<int64_t>(0, sampleTime - blockStart));
+                blockEvents.push_back(evt);
+                // Latency counts from when the event was both known and due
+                const auto due = streamStart + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(sampleTime / settings.sampleRate));
+                blockArrivals.push_back(settings.offline ? it->arrival : std::max(it->arrival, due));
+            } else {
+                *keep++ = *it;
+            }
+        }
+        pending.erase(keep, pending.end());
+
+        // Program changes switch presets at the block start (last one in the block wins)
+        for (const auto& evt : blockEvents) {
+            if (evt.isProgramChange() && (settings.programChannel == 0 || evt.isForChannel(settings.programChannel))) {
+                presets.programChange(evt.getProgramChangeNumber());
+            }
+        }
+        if (const BankPreset* preset = presets.update()) {
+            PresetSwitcher::apply(*preset, coordinator, syncGlobals);
+        }
+
+        syncGlobals.updateDAWGlobals(static_cast<int>(blockSize), transport);
+        coordinator.processBlock(blockEvents.data(), blockEvents.size(), static_cast<int>(blockSize));
+        syncGlobals.finishRun(static_cast<int>(blockSize));
+        writeOutput(blockStart);
+        ++blocks;
+        inputCount += blockEvents.size();
+        outputCount += coordinator.getOutputEvents().size();
+
+        const auto written = Clock::now();
+        for (const auto& arrival : blockArrivals) {
+            latenciesUs.push_back(std::chrono::duration<double, std::micro>(written - arrival).count());
+        }
+
+        // At the end of the input, play out what is still on its way (delay line, grace window,
+        // gate notes) in empty blocks before the stop, for at most maxTailSeconds
+        const bool drained = pending.empty() && queue.front() == nullptr;
+        const bool inputDone = endOfInput.load(std::memory_order_acquire) && drained;
+        if (inputDone && tailEnd < 0) {
+            tailEnd = blockEnd + static_cast<int64_t>(maxTailSeconds * settings.sampleRate);
+        }
+        if ((inputDone && (!coordinator.hasPendingOutput() || blockEnd >= tailEnd)) || interrupted.load()) {
+            blockStart += blockSize;
+            break;
+        }
+    }
+
+    // Stop the transport: flush hanging notes
+    transport.isPlaying = false;
+    syncGlobals.updateDAWGlobals(static_cast<int>(blockSize), transport);
+    if (coordinator.takeStopFlush()) {
+        writeOutput(blockStart);
+        outputCount += coordinator.getOutputEvents().size();
+    }
+    syncGlobals.getStaticListeners().unbind<ChordPatternCoordinator>();
+
+    if (!settings.memoryReportPath.empty()) {
+        MemoryReport report;
+        coordinator.appendMemoryUsage(report);
+        std::FILE* reportFile = std::fopen(settings.memoryReportPath.c_str(), "w");
+        if (reportFile == nullptr) {
+            std::fprintf(stderr, "Cannot write %s\n", settings.memoryReportPath.c_str());
+        } else {
+            const std::string csv = report.toCsv();
+            std::fwrite(csv.data(), 1, csv.size(), reportFile);
+            std::fclose(reportFile);
+        }
+        if (settings.verbose) {
+            std::fprintf(stderr, "%s", report.toText().c_str());
+        }
+    }
+
+    if (interrupted.load()) {
+        // The reader may be blocked in fgets; do not wait for it
+        reader.detach();
+    } else {
+        reader.join();
+    }
+    if (input != stdin) {
+        std::fclose(input);
+    }
+
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    auto percentile = [&](double p) {
+        if (latenciesUs.empty()) {
+            return 0.0;
+        }
+        const size_t index = std::min(latenciesUs.size() - 1, static_cast<size_t>(p / 100.0 * latenciesUs.size()));
+        return latenciesUs[index];
+    };
+
+    std::fprintf(stderr, "phu-arp-pipe: %zu blocks of %d samples @ %.0f Hz (%s), %zu input / %zu output events\n",
+                 blocks, settings.blockSize, settings.sampleRate, settings.offline ? "offline" : "realtime",
+                 inputCount, outputCount);
+    if (settings.outputCleanup != OutputCleanup::Off) {
+        const OutputPeephole& peephole = coordinator.getOutputPeephole();
+        std::fprintf(stderr, "output cleanup: %zu events removed (%zu note-offs, %zu note-ons; %zu retriggers merged)\n",
+                     peephole.getRemovedCount(), peephole.getRemovedNoteOffCount(),
+                     peephole.getRemovedNoteOnCount(), peephole.getMergedRetriggerCount());
+    }
+    if (settings.controlRouting.isActive()) {
+        std::fprintf(stderr, "control routing: %zu messages routed, %zu thinned\n",
+                     coordinator.getRoutedControlCount(), coordinator.getThinnedControlCount());
+    }
+    if (settings.maxVoices > 0) {
+        std::fprintf(stderr, "voices: peak %zu, %zu stolen (cap %d)\n",
+                     patternTracker.getPeakPlayingNotesCount(), coordinator.getStolenVoiceCount(), settings.maxVoices);
+    }
+    if (RealtimeTrap::isEnabled()) {
+        std::fprintf(stderr, "rt-trap: %llu allocations, %llu deallocations, %llu locks in realtime sections\n",
+                     static_cast<unsigned long long>(RealtimeTrap::getAllocationCount()),
+                     static_cast<unsigned long long>(RealtimeTrap::getDeallocationCount()),
+                     static_cast<unsigned long long>(RealtimeTrap::getLockCount()));
+    }
+    std::fprintf(stderr, "latency us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f  (block period %.1f)\n",
+                 percentile(50.0), percentile(90.0), percentile(99.0), percentile(99.9),
+                 latenciesUs.empty() ? 0.0 : latenciesUs.back(),
+                 blockSize / settings.sampleRate * 1e6);
+    return 0;
+}
@@ -0,0 +1,371 @@
+/**
+ * phu-arp-render - offline batch renderer
+ *
+ * Renders chord (ch 1) + rhythm (ch 16) Standard MIDI Files into the generated
+ * output track (ch 2) with the same algorithm as the plugin, faster than real time.
+ * A directory is processed recursively on a work-stealing thread pool.
+ *
+ * Usage:
+ *   phu-arp-render [options] <input.mid | input-dir> <output-dir>
+ *
+ * Output files mirror the input paths below <output-dir>. Results only depend on the input
+ * and the options (not on the number of threads or scheduling order).
+ */
+
+#include "OfflineRenderer.h"
+#include "RhythmKeyMap.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct RenderJob {
+    fs::path input;
+    fs::path output;
+
+    // Filled in by the worker
+    bool ok = false;
+    std::string error;
+    OfflineRenderStats stats;
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+        "Usage: phu-arp-render [options] <input.mid | input-dir> <output-dir>\n"
+        "\n"
+        "Options:\n"
+        "  -j, --jobs N          worker threads (default: hardware concurrency)\n"
+        "  --sample-rate HZ      simulated sample rate (default: 48000)\n"
+        "  --block-size N        simulated block size in samples (default: 512)\n"
+        "  --root-note N         rhythm root note (default: 24 = C1)\n"
+        "  --chord-channel N     chord input channel (default: 1)\n"
+        "  --rhythm-channel N    rhythm input channel (default: 16)\n"
+        "  --output-channel N    generated output channel (default: 2)\n"
+        "  --pattern TEXT        built-in rhythm pattern lanes, repeatable ('KEY: STEPS [/DIV]',\n"
+        "                        ';' between lanes, e.g. \"0: x . x x*2 /16; 12: E(3,8) /8\")\n"
+        "  --pattern-file PATH   built-in rhythm pattern from a text file (one lane per line)\n"
+        "  --gate MODE           generated note length: follow (trigger note-offs, default),\n"
+        "                        fixed or ratchet (tempo-synced, trigger note-offs ignored)\n"
+        "  --gate-length NOTE    fixed/ratchet length per trigger: 1/16 (default), 1/8t, 1/4., 0.5 quarters\n"
+        "  --ratchets N          ratchet notes per trigger (1-8, default: 2)\n"
+        "  --strum-key N         rhythm key (relative to the root note) that strums the whole chord\n"
+        "  --strum-direction DIR up (default), down or alternate\n"
+        "  --strum-spread NOTE   first to last strum note: 1/32 (default), 1/16t, 0.1 quarters\n"
+        "  --strum-anticipation PCT\n"
+        "                        part of the spread before the trigger (0-100, default: 50,\n"
+        "                        limited by --latency)\n"
+        "  --latency N           engine lookahead in samples (default: 0); output is compensated\n"
+        "  --quantize NOTE       groove-quantize rhythm triggers to a grid: 1/16, 1/8t, ... (default: off)\n"
+        "  --quantize-strength PCT\n"
+        "                        how far triggers move onto the grid (0-100, default: 100)\n"
+        "  --swing PCT           position of every second grid line (50 = straight .. 75, default: 50)\n"
+        "  --groove TEXT         per-line timing in percent of a grid step, optionally /velocity percent,\n"
+        "                        e.g. \"0 +12 0 -8/80\"; late triggers are only pulled in up to --latency\n"
+        "  --chord-settle MS     apply a chord change once the chord input has been quiet this long\n"
+        "                        (hand-played chords, default: 0 = every note at once)\n"
+        "  --chord-grace MS      rhythm triggers play the chord that lands up to MS after them\n"
+        "                        (adds MS to the latency, default: 0)\n"
+        "  --chord-latch         chord notes stay until the next chord starts (sustain CC64 and\n"
+        "                        sostenuto CC66 on the chord channel always apply)\n"
+        "  --chord-follow        held notes move to the new chord on a chord change (legato)\n"
+        "  --output-cleanup MODE drop redundant note events from the output: off (default), clean\n"
+        "                        (duplicate note-offs, cancelled notes) or legato (also retriggers)\n"
+        "  --route-chord KINDS   pass chord channel controls on to the output: cc, bend, pressure\n"
+        "                        (comma-separated, default: none; CC64/CC66 stay pedals)\n"
+        "  --route-rhythm KINDS  pass rhythm channel controls on: cc, bend, pressure, poly (aftertouch\n"
+        "                        to the notes the key plays), all (default: none)\n"
+        "  --no-control-thinning send every routed control value (default: last value per block)\n"
+        "  --max-voices N        polyphony cap: a note-on beyond N playing notes steals one (default: 0 = off)\n"
+        "  --voice-steal POLICY  note the cap steals: oldest (default), velocity (quietest), highest or\n"
+        "                        lowest (pitch)\n"
+        "  -q, --quiet           only print the summary\n");
+}
+
+bool isMidiFile(const fs::path& path) {
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".mid" || ext == ".midi" || ext == ".smf";
+}
+
+bool parseInt(const char* text, int& value) {
+    char* end = nullptr;
+    const long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool readTextFile(const std::string& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    text = content.str();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    OfflineRenderSettings settings;
+    int numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    bool quiet = false;
+    std::vector<std::string> positional;
+    std::string patternText;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto nextInt = [&](int& value) {
+            if (i + 1 >= argc || !parseInt(argv[i + 1], value)) {
+                std::fprintf(stderr, "Invalid value for %s\n", arg.c_str());
+                std::exit(2);
+            }
+            ++i;
+        };
+
+        if (arg == "-j" || arg == "--jobs") {
+            nextInt(numThreads);
+        } else if (arg == "--sample-rate") {
+            int rate = 0;
+            nextInt(rate);
+            settings.sampleRate = rate;
+        } else if (arg == "--block-size") {
+            nextInt(settings.blockSize);
+        } else if (arg == "--root-note") {
+            nextInt(settings.rhythmRootNote);
+        } else if (arg == "--chord-channel") {
+            nextInt(settings.chordInputChannel);
+        } else if (arg == "--rhythm-channel") {
+            nextInt(settings.rhythmInputChannel);
+        } else if (arg == "--output-channel") {
+            nextInt(settings.outputChannel);
+        } else if (arg == "--pattern" && i + 1 < argc) {
+            patternText += std::string(argv[++i]) + "\n";
+        } else if (arg == "--pattern-file" && i + 1 < argc) {
+            std::string fileText;
+            if (!readTextFile(argv[++i], fileText)) {
+                std::fprintf(stderr, "Cannot read %s\n", argv[i]);
+                return 1;
+            }
+            patternText += fileText + "\n";
+        } else if (arg == "--gate" && i + 1 < argc) {
+            if (!NoteGate::parseMode(argv[++i], settings.gate.mode)) {
+                std::fprintf(stderr, "Invalid gate mode %s (follow, fixed, ratchet)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--gate-length" && i + 1 < argc) {
+            if (!NoteGate::parseLength(argv[++i], settings.gate.lengthQuarters)) {
+                std::fprintf(stderr, "Invalid gate length %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--ratchets") {
+            nextInt(settings.gate.ratchets);
+        } else if (arg == "--strum-key") {
+            nextInt(settings.strum.key);
+        } else if (arg == "--strum-direction" && i + 1 < argc) {
+            if (!NoteStrum::parseDirection(argv[++i], settings.strum.direction)) {
+                std::fprintf(stderr, "Invalid strum direction %s (up, down, alternate)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--strum-spread" && i + 1 < argc) {
+            if (!NoteGate::parseLength(argv[++i], settings.strum.spreadQuarters)
+                || settings.strum.spreadQuarters > NoteStrum::maxSpreadQuarters) {
+                std::fprintf(stderr, "Invalid strum spread %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--strum-anticipation") {
+            int percent = 0;
+            nextInt(percent);
+            settings.strum.anticipation = percent / 100.0;
+        } else if (arg == "--latency") {
+            nextInt(settings.latencySamples);
+        } else if (arg == "--chord-settle") {
+            int milliseconds = 0;
+            nextInt(milliseconds);
+            settings.chordSettleMs = milliseconds;
+        } else if (arg == "--chord-grace") {
+            int milliseconds = 0;
+            nextInt(milliseconds);
+            settings.chordGraceMs = milliseconds;
+        } else if (arg == "--chord-latch") {
+            settings.chordLatch = true;
+        } else if (arg == "--chord-follow") {
+            settings.chordFollow = true;
+        } else if (arg == "--output-cleanup" && i + 1 < argc) {
+            if (!OutputPeephole::parseCleanup(argv[++i], settings.outputCleanup)) {
+                std::fprintf(stderr, "Invalid output cleanup %s (off, clean, legato)\n", argv[i]);
+                return 2;
+            }
+        } else if ((arg == "--route-chord" || arg == "--route-rhythm") && i + 1 < argc) {
+            uint8_t& kinds = arg == "--route-chord" ? settings.controlRouting.chordInput : settings.controlRouting.rhythmInput;
+            if (!ControlRouting::parseKinds(argv[++i], kinds)) {
+                std::fprintf(stderr, "Invalid control kinds %s (cc, bend, pressure, poly, all, none)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--no-control-thinning") {
+            settings.controlRouting.thin = false;
+        } else if (arg == "--max-voices") {
+            nextInt(settings.maxVoices);
+        } else if (arg == "--voice-steal" && i + 1 < argc) {
+            if (!VoicePool::parseSteal(argv[++i], settings.voiceSteal)) {
+                std::fprintf(stderr, "Invalid voice steal policy %s (oldest, velocity, highest, lowest)\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--quantize" && i + 1 < argc) {
+            settings.quantize.enabled = true;
+            if (!NoteGate::parseLength(argv[++i], settings.quantize.gridQuarters)
+                || settings.quantize.gridQuarters < GrooveQuantize::minGridQuarters
+                || settings.quantize.gridQuarters > GrooveQuantize::maxGridQuarters) {
+                std::fprintf(stderr, "Invalid quantize grid %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--quantize-strength") {
+            int percent = 0;
+            nextInt(percent);
+            settings.quantize.strength = percent / 100.0;
+        } else if (arg == "--swing") {
+            int percent = 0;
+            nextInt(percent);
+            settings.quantize.swing = percent / 100.0;
+        } else if (arg == "--groove" && i + 1 < argc) {
+            std::string error;
+            if (!GrooveTemplate::parse(argv[++i], settings.quantize.groove, error)) {
+                std::fprintf(stderr, "Invalid groove: %s\n", error.c_str());
+                return 2;
+            }
+        } else if (arg == "-q" || arg == "--quiet") {
+            quiet = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            printUsage();
+            return 2;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 2 || settings.gate.ratchets < 1 || settings.gate.ratchets > NoteGate::maxRatchets
+        || (settings.strum.isEnabled() && (settings.strum.key < RhythmKeyMap::firstKey
+                                           || settings.strum.key >= RhythmKeyMap::firstKey + RhythmKeyMap::numKeys))
+        || settings.strum.anticipation < 0.0 || settings.strum.anticipation > 1.0 || settings.latencySamples < 0
+        || settings.quantize.strength < 0.0 || settings.quantize.strength > 1.0
+        || settings.quantize.swing < 0.5 || settings.quantize.swing > 0.75 || settings.chordSettleMs < 0.0
+        || settings.chordGraceMs < 0.0 || settings.sampleRate <= 0.0 || settings.blockSize <= 0 || numThreads <= 0) {
+        printUsage();
+        return 2;
+    }
+
+    // Compile the pattern once; all render jobs share the table
+    if (!patternText.empty()) {
+        auto pattern = std::make_shared<CompiledPattern>();
+        std::string error;
+        if (!PatternCompiler::compile(patternText, *pattern, error)) {
+            std::fprintf(stderr, "Invalid pattern: %s\n", error.c_str());
+            return 2;
+        }
+        settings.rhythmPattern = pattern;
+    }
+
+    const fs::path inputPath = positional[0];
+    const fs::path outputDir = positional[1];
+
+    // Collect jobs in a deterministic (sorted) order
+    std::vector<RenderJob> jobs;
+    std::error_code ec;
+    if (fs::is_directory(inputPath, ec)) {
+        for (auto it = fs::recursive_directory_iterator(inputPath, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_regular_file(ec) && isMidiFile(it->path())) {
+                RenderJob job;
+                job.input = it->path();
+                job.output = outputDir / fs::relative(it->path(), inputPath, ec);
+                jobs.push_back(std::move(job));
+            }
+        }
+    } else if (fs::is_regular_file(inputPath, ec)) {
+        RenderJob job;
+        job.input = inputPath;
+        job.output = outputDir / inputPath.filename();
+        jobs.push_back(std::move(job));
+    } else {
+        std::fprintf(stderr, "Input not found: %s\n", inputPath.string().c_str());
+        return 1;
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const RenderJob& a, const RenderJob& b) { return a.input < b.input; });
+
+    if (jobs.empty()) {
+        std::fprintf(stderr, "No MIDI files found in %s\n", inputPath.string().c_str());
+        return 1;
+    }
+
+    const OfflineRenderer renderer(settings);
+    WorkStealingPool pool(std::min(static_cast<size_t>(numThreads), jobs.size()));
+
+    for (auto& job : jobs) {
+        pool.submit([&renderer, &job] {
+            std::error_code dirError;
+            fs::create_directories(job.output.parent_path(), dirError);
+            job.ok = renderer.renderFile(job.input.string(), job.output.string(), job.stats, job.error);
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.runAll();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Report in input order
+    size_t filesOk = 0;
+    size_t inputEvents = 0;
+    size_t outputEvents = 0;
+    size_t removedEvents = 0;
+    size_t stolenVoices = 0;
+    for (const auto& job : jobs) {
+        if (job.ok) {
+            ++filesOk;
+            inputEvents += job.stats.inputEvents;
+            outputEvents += job.stats.outputEvents;
+            removedEvents += job.stats.removedEvents;
+            stolenVoices += job.stats.stolenVoices;
+            if (!quiet) {
+                std::printf("%s -> %s (%zu in, %zu out)\n", job.input.string().c_str(), job.output.string().c_str(),
+                            job.stats.inputEvents, job.stats.outputEvents);
+            }
+        } else {
+            std::fprintf(stderr, "FAILED %s: %s\n", job.input.string().c_str(), job.error.c_str());
+        }
+    }
+
+    const double safeSeconds = seconds > 0.0 ? seconds : 1e-9;
+    std::printf("Rendered %zu/%zu files in %.3f s on %zu threads (%zu jobs stolen)\n",
+                filesOk, jobs.size(), seconds, pool.getNumThreads(), pool.getStolenJobCount());
+    std::printf("Throughput: %.1f files/s, %.0f events/s (%zu input + %zu output events)\n",
+                filesOk / safeSeconds, (inputEvents + outputEvents) / safeSeconds, inputEvents, outputEvents);
+    if (settings.outputCleanup != OutputCleanup::Off) {
+        std::printf("Output cleanup: %zu events removed\n", removedEvents);
+    }
+    if (settings.maxVoices > 0) {
+        std::printf("Polyphony cap %d: %zu voices stolen\n", settings.maxVoices, stolenVoices);
+    }
+
+    return filesOk == jobs.size() ? 0 : 1;
+}
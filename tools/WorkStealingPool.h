@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * WorkStealingPool
+ *
+ * Fixed-size thread pool for batches of independent jobs.
+ * Each worker owns a deque: it pops its own jobs from the front and, when empty,
+ * steals from the back of the other workers' deques. Jobs are distributed round-robin
+ * on submission, so uneven job costs (e.g. file sizes) are balanced by stealing.
+ *
+ * Usage:
+ *   WorkStealingPool pool(numThreads);
+ *   for (size_t i = 0; i < jobs.size(); ++i)
+ *       pool.submit([&, i] { run(jobs[i]); });
+ *   pool.runAll();   // blocks until every job has finished
+ */
+class WorkStealingPool {
+public:
+    using Job = std::function<void()>;
+
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    size_t nextQueue = 0;
+    std::atomic<size_t> stolenJobs { 0 };
+
+public:
+    explicit WorkStealingPool(size_t numThreads) {
+        if (numThreads == 0) {
+            numThreads = 1;
+        }
+        for (size_t i = 0; i < numThreads; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+    }
+
+    size_t getNumThreads() const noexcept {
+        return queues.size();
+    }
+
+    /**
+     * Number of jobs executed by a worker other than the one they were submitted to
+     * (during the last runAll call)
+     */
+    size_t getStolenJobCount() const noexcept {
+        return stolenJobs.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Queue a job. Call before runAll (not thread-safe against a running batch).
+     */
+    void submit(Job job) {
+        auto& queue = *queues[nextQueue];
+        nextQueue = (nextQueue + 1) % queues.size();
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    /**
+     * Run all submitted jobs and wait until they are done
+     */
+    void runAll() {
+        stolenJobs.store(0, std::memory_order_relaxed);
+
+        std::vector<std::thread> threads;
+        threads.reserve(queues.size() - 1);
+        for (size_t i = 1; i < queues.size(); ++i) {
+            threads.emplace_back([this, i] { workerLoop(i); });
+        }
+        workerLoop(0);   // The calling thread is worker 0
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        nextQueue = 0;
+    }
+
+private:
+    bool popLocal(size_t index, Job& job) {
+        auto& queue = *queues[index];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.jobs.empty()) {
+            return false;
+        }
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    bool steal(size_t thief, Job& job) {
+        for (size_t offset = 1; offset < queues.size(); ++offset) {
+            auto& victim = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.back());
+                victim.jobs.pop_back();
+                stolenJobs.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        // All jobs are submitted up front, so an empty pool means the batch is done.
+        Job job;
+        while (popLocal(index, job) || steal(index, job)) {
+            job();
+        }
+    }
+};